@@ -51,57 +51,78 @@ const VECTOR2D BASIC_GAL::transform( const VECTOR2D& aPoint ) const
     return point;
 }
 
-void BASIC_GAL::DrawPolyline( const std::deque<VECTOR2D>& aPointList )
+void BASIC_GAL::doDrawPolyline( const std::vector<wxPoint>& aLocalPointList )
 {
-    if( aPointList.empty() )
-        return;
-
-    std::deque<VECTOR2D>::const_iterator it = aPointList.begin();
-    std::vector <wxPoint> polyline_corners;
-
-    for( ; it != aPointList.end(); ++it )
-    {
-        VECTOR2D corner = transform(*it);
-        polyline_corners.emplace_back( corner.x, corner.y );
-    }
-
     if( m_DC )
     {
         if( isFillEnabled )
         {
-            GRPoly( m_isClipped ? &m_clipBox : NULL, m_DC, polyline_corners.size(),
-                    &polyline_corners[0], 0, GetLineWidth(), m_Color, m_Color );
+            GRPoly( m_isClipped ? &m_clipBox : NULL, m_DC, aLocalPointList.size(),
+                    &aLocalPointList[0], 0, GetLineWidth(), m_Color, m_Color );
         }
         else
         {
-            for( unsigned ii = 1; ii < polyline_corners.size(); ++ii )
+            for( unsigned ii = 1; ii < aLocalPointList.size(); ++ii )
             {
-                GRCSegm( m_isClipped ? &m_clipBox : NULL, m_DC, polyline_corners[ii-1],
-                         polyline_corners[ii], GetLineWidth(), m_Color );
+                GRCSegm( m_isClipped ? &m_clipBox : NULL, m_DC, aLocalPointList[ii-1],
+                         aLocalPointList[ii], GetLineWidth(), m_Color );
             }
         }
     }
     else if( m_plotter )
     {
-        m_plotter->MoveTo( polyline_corners[0] );
+        m_plotter->MoveTo( aLocalPointList[0] );
 
-        for( unsigned ii = 1; ii < polyline_corners.size(); ii++ )
+        for( unsigned ii = 1; ii < aLocalPointList.size(); ii++ )
         {
-            m_plotter->LineTo( polyline_corners[ii] );
+            m_plotter->LineTo( aLocalPointList[ii] );
         }
 
         m_plotter->PenFinish();
     }
     else if( m_callback )
     {
-        for( unsigned ii = 1; ii < polyline_corners.size(); ii++ )
+        for( unsigned ii = 1; ii < aLocalPointList.size(); ii++ )
         {
-            m_callback( polyline_corners[ii-1].x, polyline_corners[ii-1].y,
-                        polyline_corners[ii].x, polyline_corners[ii].y, m_callbackData );
+            m_callback( aLocalPointList[ii-1].x, aLocalPointList[ii-1].y,
+                        aLocalPointList[ii].x, aLocalPointList[ii].y, m_callbackData );
         }
     }
 }
 
+void BASIC_GAL::DrawPolyline( const std::deque<VECTOR2D>& aPointList )
+{
+    if( aPointList.empty() )
+        return;
+
+    std::deque<VECTOR2D>::const_iterator it = aPointList.begin();
+    std::vector <wxPoint> polyline_corners;
+
+    for( ; it != aPointList.end(); ++it )
+    {
+        VECTOR2D corner = transform(*it);
+        polyline_corners.emplace_back( corner.x, corner.y );
+    }
+
+    doDrawPolyline( polyline_corners );
+}
+
+void BASIC_GAL::DrawPolyline( const VECTOR2D aPointList[], int aListSize )
+{
+    if( aListSize <= 0 )
+        return;
+
+    std::vector <wxPoint> polyline_corners;
+
+    for( int ii = 0; ii < aListSize; ++ii )
+    {
+        VECTOR2D corner = transform( aPointList[ii] );
+        polyline_corners.emplace_back( corner.x, corner.y );
+    }
+
+    doDrawPolyline( polyline_corners );
+}
+
 void BASIC_GAL::DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
 {
     VECTOR2D startVector = transform( aStartPoint );
@@ -45,6 +45,10 @@ using KIGFX::COLOR4D;
 // Create only once, as seeding is *very* expensive
 static boost::uuids::random_generator randomGenerator;
 
+// The generator is not thread safe, and items can be created from several threads (for
+// instance when loading the files of a schematic hierarchy)
+static std::mutex randomGeneratorMutex;
+
 // These don't have the same performance penalty, but might as well be consistent
 static boost::uuids::string_generator stringGenerator;
 static boost::uuids::nil_generator nilGenerator;
@@ -53,19 +57,31 @@ static boost::uuids::nil_generator nilGenerator;
 KIID niluuid( 0 );
 
 
+static boost::uuids::uuid newRandomUuid()
+{
+    std::lock_guard<std::mutex> lock( randomGeneratorMutex );
+
+    return randomGenerator();
+}
+
+
 KIID::KIID() :
-        m_uuid( randomGenerator() ),
+        m_uuid( newRandomUuid() ),
         m_cached_timestamp( 0 )
 {
 #if defined(EESCHEMA)
     // JEY TODO: use legacy timestamps until new EEschema file format is in
+    static std::mutex  timeStampMutex;
     static timestamp_t oldTimeStamp;
-    timestamp_t        newTimeStamp = time( NULL );
+
+    std::unique_lock<std::mutex> lock( timeStampMutex );
+    timestamp_t                  newTimeStamp = time( NULL );
 
     if( newTimeStamp <= oldTimeStamp )
         newTimeStamp = oldTimeStamp + 1;
 
     oldTimeStamp = newTimeStamp;
+    lock.unlock();
 
     *this = KIID( wxString::Format( "%8.8X", newTimeStamp ) );
 #endif
@@ -110,7 +126,7 @@ KIID::KIID( const wxString& aString ) :
         {
             // Failed to parse string representation; best we can do is assign a new
             // random one.
-            m_uuid = randomGenerator();
+            m_uuid = newRandomUuid();
         }
     }
 }
@@ -222,6 +222,10 @@ void EDA_DRAW_PANEL_GAL::onPaint( wxPaintEvent& WXUNUSED( aEvent ) )
 
     m_lastRefresh = wxGetLocalTimeMillis();
     m_drawing = false;
+
+    // Keep on redrawing until the items waiting for an update are all done
+    if( m_view->HasPendingUpdates() )
+        Refresh();
 }
 
 
@@ -35,8 +35,13 @@
 #include <geometry/shape_poly_set.h>
 #include <math/util.h>      // for KiROUND
 #include <bitmap_base.h>
+#include <profile.h>
 
+#include <algorithm>
+#include <atomic>
+#include <future>
 #include <limits>
+#include <thread>
 
 #include <pixman.h>
 
@@ -53,6 +58,9 @@ CAIRO_GAL_BASE::CAIRO_GAL_BASE( GAL_DISPLAY_OPTIONS& aDisplayOptions ) :
     groupCounter        = 0;
     currentGroup        = nullptr;
 
+    // Initialise deferred drawing
+    isRecording         = false;
+
     lineWidth = 1.0;
     linePixelWidth = 1.0;
     lineWidthInPixels = 1.0;
@@ -77,6 +85,7 @@ CAIRO_GAL_BASE::CAIRO_GAL_BASE( GAL_DISPLAY_OPTIONS& aDisplayOptions ) :
 CAIRO_GAL_BASE::~CAIRO_GAL_BASE()
 {
     ClearCache();
+    clearDrawList();
 
     if( surface )
         cairo_surface_destroy( surface );
@@ -243,7 +252,7 @@ void CAIRO_GAL_BASE::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& a
         cairo_move_to( currentContext, p0.x, p0.y );
         cairo_line_to( currentContext, p1.x, p1.y );
         cairo_set_source_rgba( currentContext, fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-        cairo_stroke( currentContext );
+        strokePath();
     }
     else
     {
@@ -509,8 +518,7 @@ void CAIRO_GAL_BASE::DrawBitmap( const BITMAP_BASE& aBitmap )
     }
 
     cairo_surface_mark_dirty( image );
-    cairo_set_source_surface( currentContext, image, 0, 0 );
-    cairo_paint( currentContext );
+    paintSurface( image, w, h );
 
     // store the image handle so it can be destroyed later
     imageSurfaces.push_back( image );
@@ -537,7 +545,7 @@ void CAIRO_GAL_BASE::ClearScreen()
 {
     cairo_set_source_rgb( currentContext, m_clearColor.r, m_clearColor.g, m_clearColor.b );
     cairo_rectangle( currentContext, 0.0, 0.0, screenSize.x, screenSize.y );
-    cairo_fill( currentContext );
+    fillPath();
 }
 
 
@@ -817,13 +825,13 @@ void CAIRO_GAL_BASE::DrawGroup( int aGroupNumber )
         case CMD_STROKE_PATH:
             cairo_set_source_rgba( currentContext, strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
             cairo_append_path( currentContext, it->cairoPath );
-            cairo_stroke( currentContext );
+            strokePath();
             break;
 
         case CMD_FILL_PATH:
             cairo_set_source_rgba( currentContext, fillColor.r, fillColor.g, fillColor.b, strokeColor.a );
             cairo_append_path( currentContext, it->cairoPath );
-            cairo_fill( currentContext );
+            fillPath();
             break;
 
             /*
@@ -977,7 +985,7 @@ void CAIRO_GAL_BASE::drawAxes( const VECTOR2D& aStartPoint, const VECTOR2D& aEnd
     cairo_line_to( currentContext, p1.x, org.y );
     cairo_move_to( currentContext, org.x, p0.y );
     cairo_line_to( currentContext, org.x, p1.y );
-    cairo_stroke( currentContext );
+    strokePath();
 }
 
 
@@ -990,7 +998,7 @@ void CAIRO_GAL_BASE::drawGridLine( const VECTOR2D& aStartPoint, const VECTOR2D&
     cairo_set_source_rgba( currentContext, gridColor.r, gridColor.g, gridColor.b, gridColor.a );
     cairo_move_to( currentContext, p0.x, p0.y );
     cairo_line_to( currentContext, p1.x, p1.y );
-    cairo_stroke( currentContext );
+    strokePath();
 }
 
 
@@ -1010,7 +1018,7 @@ void CAIRO_GAL_BASE::drawGridCross( const VECTOR2D& aPoint )
     cairo_line_to( currentContext, p1.x, p1.y );
     cairo_move_to( currentContext, p2.x, p2.y );
     cairo_line_to( currentContext, p3.x, p3.y );
-    cairo_stroke( currentContext );
+    strokePath();
 }
 
 
@@ -1024,7 +1032,7 @@ void CAIRO_GAL_BASE::drawGridPoint( const VECTOR2D& aPoint, double aSize )
     cairo_arc( currentContext, p.x, p.y, s, 0.0, 2.0 * M_PI );
     cairo_close_path( currentContext );
 
-    cairo_fill( currentContext );
+    fillPath();
 }
 
 void CAIRO_GAL_BASE::flushPath()
@@ -1035,16 +1043,16 @@ void CAIRO_GAL_BASE::flushPath()
                fillColor.r, fillColor.g, fillColor.b, fillColor.a );
 
        if( isStrokeEnabled )
-           cairo_fill_preserve( currentContext );
+           fillPath( true );
        else
-           cairo_fill( currentContext );
+           fillPath();
    }
 
    if( isStrokeEnabled )
    {
        cairo_set_source_rgba( currentContext,
                strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-       cairo_stroke( currentContext );
+       strokePath();
    }
 }
 
@@ -1060,14 +1068,14 @@ void CAIRO_GAL_BASE::storePath()
             if( isFillEnabled )
             {
                 cairo_set_source_rgba( currentContext, fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-                cairo_fill_preserve( currentContext );
+                fillPath( true );
             }
 
             if( isStrokeEnabled )
             {
                 cairo_set_source_rgba( currentContext, strokeColor.r, strokeColor.g,
                                       strokeColor.b, strokeColor.a );
-                cairo_stroke_preserve( currentContext );
+                strokePath( true );
             }
         }
         else
@@ -1097,6 +1105,298 @@ void CAIRO_GAL_BASE::storePath()
 }
 
 
+void CAIRO_GAL_BASE::fillPath( bool aPreserve )
+{
+    double rgba[4];
+
+    // Only solid sources are deferred, anything else is drawn immediately
+    if( !isRecording || cairo_pattern_get_rgba( cairo_get_source( currentContext ), &rgba[0],
+                                                &rgba[1], &rgba[2], &rgba[3] ) != CAIRO_STATUS_SUCCESS )
+    {
+        if( isRecording )
+            replayDrawList( currentContext );
+
+        if( aPreserve )
+            cairo_fill_preserve( currentContext );
+        else
+            cairo_fill( currentContext );
+
+        return;
+    }
+
+    double x0, y0, x1, y1;
+    cairo_path_extents( currentContext, &x0, &y0, &x1, &y1 );
+
+    if( x0 < x1 || y0 < y1 )
+    {
+        DRAW_OP& op = recordOp( OP_FILL );
+        std::copy( rgba, rgba + 4, op.color );
+        op.path = cairo_copy_path( currentContext );
+        updateOpExtents( op, x0, y0, x1, y1, 0.0 );
+    }
+
+    if( !aPreserve )
+        cairo_new_path( currentContext );
+}
+
+
+void CAIRO_GAL_BASE::strokePath( bool aPreserve )
+{
+    double rgba[4];
+
+    if( !isRecording || cairo_pattern_get_rgba( cairo_get_source( currentContext ), &rgba[0],
+                                                &rgba[1], &rgba[2], &rgba[3] ) != CAIRO_STATUS_SUCCESS )
+    {
+        if( isRecording )
+            replayDrawList( currentContext );
+
+        if( aPreserve )
+            cairo_stroke_preserve( currentContext );
+        else
+            cairo_stroke( currentContext );
+
+        return;
+    }
+
+    if( cairo_has_current_point( currentContext ) )
+    {
+        double x0, y0, x1, y1;
+        cairo_path_extents( currentContext, &x0, &y0, &x1, &y1 );
+
+        DRAW_OP& op = recordOp( OP_STROKE );
+        std::copy( rgba, rgba + 4, op.color );
+        op.path = cairo_copy_path( currentContext );
+
+        // Miter joins may extend up to miterLimit * lineWidth / 2 from the path
+        double margin = op.lineWidth / 2.0;
+
+        if( op.lineJoin == CAIRO_LINE_JOIN_MITER )
+            margin *= std::max( op.miterLimit, 1.0 );
+        else if( op.lineCap == CAIRO_LINE_CAP_SQUARE )
+            margin *= M_SQRT2;
+
+        updateOpExtents( op, x0, y0, x1, y1, margin );
+    }
+
+    if( !aPreserve )
+        cairo_new_path( currentContext );
+}
+
+
+void CAIRO_GAL_BASE::paintSurface( cairo_surface_t* aImage, int aWidth, int aHeight )
+{
+    if( !isRecording )
+    {
+        cairo_set_source_surface( currentContext, aImage, 0, 0 );
+        cairo_paint( currentContext );
+        return;
+    }
+
+    DRAW_OP& op = recordOp( OP_PAINT );
+    op.image = cairo_surface_reference( aImage );
+    updateOpExtents( op, 0.0, 0.0, aWidth, aHeight, 0.0 );
+}
+
+
+CAIRO_GAL_BASE::DRAW_OP& CAIRO_GAL_BASE::recordOp( DRAW_OP_TYPE aType )
+{
+    drawList.emplace_back();
+
+    DRAW_OP& op = drawList.back();
+    op.type       = aType;
+    op.path       = nullptr;
+    op.image      = nullptr;
+    op.op         = cairo_get_operator( currentContext );
+    op.lineWidth  = cairo_get_line_width( currentContext );
+    op.miterLimit = cairo_get_miter_limit( currentContext );
+    op.lineCap    = cairo_get_line_cap( currentContext );
+    op.lineJoin   = cairo_get_line_join( currentContext );
+    cairo_get_matrix( currentContext, &op.matrix );
+
+    return op;
+}
+
+
+void CAIRO_GAL_BASE::updateOpExtents( DRAW_OP& aOp, double aX0, double aY0, double aX1,
+                                      double aY1, double aMargin )
+{
+    double xs[4] = { aX0 - aMargin, aX1 + aMargin, aX0 - aMargin, aX1 + aMargin };
+    double ys[4] = { aY0 - aMargin, aY0 - aMargin, aY1 + aMargin, aY1 + aMargin };
+
+    for( int i = 0; i < 4; ++i )
+        cairo_matrix_transform_point( &aOp.matrix, &xs[i], &ys[i] );
+
+    // Clamp before converting, so far off-screen items cannot overflow an int
+    auto toDevice = []( double aValue )
+    {
+        return (int) std::max( -1e9, std::min( aValue, 1e9 ) );
+    };
+
+    // One extra pixel on each side accounts for antialiasing
+    aOp.x0 = toDevice( floor( *std::min_element( xs, xs + 4 ) ) ) - 1;
+    aOp.y0 = toDevice( floor( *std::min_element( ys, ys + 4 ) ) ) - 1;
+    aOp.x1 = toDevice( ceil( *std::max_element( xs, xs + 4 ) ) ) + 1;
+    aOp.y1 = toDevice( ceil( *std::max_element( ys, ys + 4 ) ) ) + 1;
+}
+
+
+void CAIRO_GAL_BASE::updateRecording( RENDER_TARGET aTarget, bool aRecord )
+{
+    if( aTarget == TARGET_OVERLAY )
+    {
+        // The deferred operations belong to the main buffer
+        if( isRecording )
+        {
+            replayDrawList( currentContext );
+            isRecording = false;
+        }
+    }
+    else if( !isRecording )
+    {
+        isRecording = aRecord;
+    }
+}
+
+
+void CAIRO_GAL_BASE::replayDrawList( cairo_t* aContext )
+{
+    if( drawList.empty() )
+        return;
+
+    cairo_surface_t* target = cairo_get_target( aContext );
+    wxCHECK( cairo_surface_get_type( target ) == CAIRO_SURFACE_TYPE_IMAGE, /*void*/ );
+
+    PROF_COUNTER replayTime;
+
+    cairo_surface_flush( target );
+
+    unsigned char*  data   = cairo_image_surface_get_data( target );
+    int             width  = cairo_image_surface_get_width( target );
+    int             height = cairo_image_surface_get_height( target );
+    int             stride = cairo_image_surface_get_stride( target );
+    cairo_format_t  format = cairo_image_surface_get_format( target );
+    cairo_antialias_t antialias = cairo_get_antialias( aContext );
+
+    const int tileSize = TILE_SIZE;
+    const int tilesX   = ( width + tileSize - 1 ) / tileSize;
+    const int tilesY   = ( height + tileSize - 1 ) / tileSize;
+
+    // Sort the operations into the tiles they touch, keeping the drawing order
+    std::vector<std::vector<unsigned int>> tiles( tilesX * tilesY );
+
+    for( unsigned int i = 0; i < drawList.size(); ++i )
+    {
+        const DRAW_OP& op = drawList[i];
+
+        if( op.x1 < 0 || op.y1 < 0 || op.x0 >= width || op.y0 >= height )
+            continue;
+
+        int tx0 = std::max( op.x0, 0 ) / tileSize;
+        int ty0 = std::max( op.y0, 0 ) / tileSize;
+        int tx1 = std::min( op.x1, width - 1 ) / tileSize;
+        int ty1 = std::min( op.y1, height - 1 ) / tileSize;
+
+        for( int ty = ty0; ty <= ty1; ++ty )
+        {
+            for( int tx = tx0; tx <= tx1; ++tx )
+                tiles[ty * tilesX + tx].push_back( i );
+        }
+    }
+
+    std::atomic<size_t> nextTile( 0 );
+    size_t              parallelThreadCount = std::min<size_t>(
+            std::thread::hardware_concurrency(), tiles.size() );
+    std::vector<std::future<void>> returns;
+
+    auto render_lambda = [&]()
+    {
+        for( size_t i = nextTile++; i < tiles.size(); i = nextTile++ )
+        {
+            if( tiles[i].empty() )
+                continue;
+
+            int x = ( i % tilesX ) * tileSize;
+            int y = ( i / tilesX ) * tileSize;
+
+            // Tiles do not overlap, so every thread may write to the shared pixel storage
+            cairo_surface_t* tileSurface = cairo_image_surface_create_for_data(
+                    data + y * stride + x * 4, format, std::min( tileSize, width - x ),
+                    std::min( tileSize, height - y ), stride );
+            cairo_surface_set_device_offset( tileSurface, -x, -y );
+
+            cairo_t* cr = cairo_create( tileSurface );
+            cairo_set_antialias( cr, antialias );
+
+            for( unsigned int opIdx : tiles[i] )
+            {
+                const DRAW_OP& op = drawList[opIdx];
+
+                cairo_set_matrix( cr, &op.matrix );
+                cairo_set_operator( cr, op.op );
+
+                if( op.type == OP_PAINT )
+                {
+                    cairo_set_source_surface( cr, op.image, 0, 0 );
+                    cairo_paint( cr );
+                    continue;
+                }
+
+                cairo_set_source_rgba( cr, op.color[0], op.color[1], op.color[2], op.color[3] );
+                cairo_new_path( cr );
+                cairo_append_path( cr, op.path );
+
+                if( op.type == OP_FILL )
+                {
+                    cairo_fill( cr );
+                }
+                else
+                {
+                    cairo_set_line_width( cr, op.lineWidth );
+                    cairo_set_miter_limit( cr, op.miterLimit );
+                    cairo_set_line_cap( cr, op.lineCap );
+                    cairo_set_line_join( cr, op.lineJoin );
+                    cairo_stroke( cr );
+                }
+            }
+
+            cairo_destroy( cr );
+            cairo_surface_destroy( tileSurface );
+        }
+    };
+
+    for( size_t ii = 1; ii < parallelThreadCount; ++ii )
+        returns.push_back( std::async( std::launch::async, render_lambda ) );
+
+    render_lambda();
+
+    for( std::future<void>& ret : returns )
+        ret.wait();
+
+    cairo_surface_mark_dirty( target );
+
+    replayTime.Stop();
+    wxLogTrace( "GAL_PROFILE", "CAIRO_GAL_BASE::replayDrawList(): %u operations, %d tiles, %.1f ms",
+                (unsigned) drawList.size(), tilesX * tilesY, replayTime.msecs() );
+
+    clearDrawList();
+}
+
+
+void CAIRO_GAL_BASE::clearDrawList()
+{
+    for( DRAW_OP& op : drawList )
+    {
+        if( op.path )
+            cairo_path_destroy( op.path );
+
+        if( op.image )
+            cairo_surface_destroy( op.image );
+    }
+
+    drawList.clear();
+}
+
+
 void CAIRO_GAL_BASE::blitCursor( wxMemoryDC& clientDC )
 {
     if( !IsCursorEnabled() )
@@ -1262,6 +1562,9 @@ void CAIRO_GAL::beginDrawing()
 
     compositor->SetMainContext( context );
     compositor->SetBuffer( mainBuffer );
+
+    // Items drawn to the main buffer are rasterized in tiles when the buffer is switched
+    isRecording = true;
 }
 
 
@@ -1269,6 +1572,12 @@ void CAIRO_GAL::endDrawing()
 {
     CAIRO_GAL_BASE::endDrawing();
 
+    if( isRecording )
+    {
+        replayDrawList( currentContext );
+        isRecording = false;
+    }
+
     // Merge buffers on the screen
     compositor->DrawBuffer( mainBuffer );
     compositor->DrawBuffer( overlayBuffer );
@@ -1356,6 +1665,9 @@ void CAIRO_GAL::SetTarget( RENDER_TARGET aTarget )
     if( isInitialized )
         storePath();
 
+    // Items drawn to the main buffer are rasterized in tiles when the buffer is switched
+    updateRecording( aTarget, isInitialized );
+
     switch( aTarget )
     {
     default:
@@ -1391,6 +1703,11 @@ void CAIRO_GAL::ClearTarget( RENDER_TARGET aTarget )
     case TARGET_CACHED:
     case TARGET_NONCACHED:
         compositor->SetBuffer( mainBuffer );
+
+        // Pending operations would be wiped out by clearing the buffer anyway
+        if( isRecording )
+            clearDrawList();
+
         break;
 
     case TARGET_OVERLAY:
@@ -34,21 +34,20 @@
 #include <gal/opengl/vertex_item.h>
 #include <gal/opengl/utils.h>
 
-#include <list>
 #include <cassert>
+#include <cstring>
+#include <iterator>
 
-#ifdef __WXDEBUG__
 #include <wx/log.h>
 #include <profile.h>
-#endif /* __WXDEBUG__ */
 
 using namespace KIGFX;
 
 CACHED_CONTAINER::CACHED_CONTAINER( unsigned int aSize ) :
-    VERTEX_CONTAINER( aSize ), m_item( NULL ), m_chunkSize( 0 ), m_chunkOffset( 0 ), m_maxIndex( 0 )
+    VERTEX_CONTAINER( aSize ), m_item( NULL ), m_chunkSize( 0 ), m_chunkOffset( 0 ), m_maxIndex( 0 ),
+    m_recycledSpace( 0 )
 {
-    // In the beginning there is only free space
-    m_freeChunks.insert( std::make_pair( aSize, 0 ) );
+    // In the beginning there is only free space above m_maxIndex
 }
 
 
@@ -58,7 +57,7 @@ void CACHED_CONTAINER::SetItem( VERTEX_ITEM* aItem )
 
     unsigned int itemSize = aItem->GetSize();
     m_item      = aItem;
-    m_chunkSize = itemSize;
+    m_chunkSize = itemSize > 0 ? chunkSize( itemSize ) : 0;
 
     // Get the previously set offset if the item was stored previously
     m_chunkOffset = itemSize > 0 ? aItem->GetOffset() : -1;
@@ -75,19 +74,8 @@ void CACHED_CONTAINER::FinishItem()
 
     unsigned int itemSize = m_item->GetSize();
 
-    // Finishing the previously edited item
-    if( itemSize < m_chunkSize )
-    {
-        // There is some not used but reserved memory left, so we should return it to the pool
-        int itemOffset = m_item->GetOffset();
-
-        // Add the not used memory back to the pool
-        addFreeChunk( itemOffset + itemSize, m_chunkSize - itemSize );
-        // mergeFreeChunks();   // veery slow and buggy
-
-        m_maxIndex = std::max( itemOffset + itemSize, m_maxIndex );
-    }
-
+    // The item keeps its whole chunk: the spare space is a part of its size class and
+    // it is used if the item grows later
     if( itemSize > 0 )
         m_items.insert( m_item );
 
@@ -148,19 +136,19 @@ void CACHED_CONTAINER::Delete( VERTEX_ITEM* aItem )
     assert( aItem != NULL );
     assert( m_items.find( aItem ) != m_items.end() || aItem->GetSize() == 0 );
 
-    int size = aItem->GetSize();
+    unsigned int size = aItem->GetSize();
 
     if( size == 0 )
         return;     // Item is not stored here
 
-    int offset = aItem->GetOffset();
+    unsigned int offset = aItem->GetOffset();
 
 #if CACHED_CONTAINER_TEST > 1
     wxLogDebug( wxT( "Removing 0x%08lx (size %d offset %d)" ), (long) aItem, size, offset );
 #endif
 
-    // Insert a free memory chunk entry in the place where item was stored
-    addFreeChunk( offset, size );
+    // Release the chunk where item was stored
+    addFreeChunk( offset, chunkSize( size ) );
 
     // Indicate that the item is not stored in the container anymore
     aItem->setSize( 0 );
@@ -170,21 +158,6 @@ void CACHED_CONTAINER::Delete( VERTEX_ITEM* aItem )
 #if CACHED_CONTAINER_TEST > 0
     test();
 #endif
-
-    // This dynamic memory freeing optimize memory usage, but in fact can create
-    // out of memory issues because freeing and reallocation large chunks of memory
-    // can create memory fragmentation and no room to reallocate large chunks
-    // after many free/reallocate cycles during a session using the same complex board
-    // So it can be disable.
-    // Currently: it is disable to avoid "out of memory" issues
-#if 0
-    // Dynamic memory freeing, there is no point in holding
-    // a large amount of memory when there is no use for it
-    if( m_freeSpace > ( 0.75 * m_currentSize ) && m_currentSize > m_initialSize )
-    {
-        defragmentResize( 0.5 * m_currentSize );
-    }
-#endif
 }
 
 
@@ -192,6 +165,7 @@ void CACHED_CONTAINER::Clear()
 {
     m_freeSpace = m_currentSize;
     m_maxIndex = 0;
+    m_recycledSpace = 0;
     m_failed = false;
 
     // Set the size of all the stored VERTEX_ITEMs to 0, so it is clear that they are not held
@@ -202,8 +176,8 @@ void CACHED_CONTAINER::Clear()
     m_items.clear();
 
     // Now there is only free space left
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, 0 ) );
+    m_freeRegions.clear();
+    m_freeRegionsBySize.clear();
 }
 
 
@@ -213,51 +187,62 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
     assert( IsMapped() );
 
     unsigned int itemSize = m_item->GetSize();
+    unsigned int newChunkSize = chunkSize( aSize );
+    unsigned int newChunkOffset;
 
 #if CACHED_CONTAINER_TEST > 2
     wxLogDebug( wxT( "Resize %p from %d to %d" ), m_item, itemSize, aSize );
 #endif
 
-    // Find a free space chunk >= aSize
-    FREE_CHUNK_MAP::iterator newChunk = m_freeChunks.lower_bound( aSize );
+    // The topmost chunk may simply grow in place, unless there is released space to reuse
+    bool reuseChunk = takeFreeChunk( newChunkSize, newChunkOffset );
+    bool growInPlace = !reuseChunk && itemSize > 0 && m_chunkOffset + m_chunkSize == m_maxIndex;
 
-    // Is there enough space to store vertices?
-    if( newChunk == m_freeChunks.end() )
+    if( !reuseChunk )
     {
-        bool result;
+        // Take the space above the highest used index
+        newChunkOffset = growInPlace ? m_chunkOffset : m_maxIndex;
 
-        // Would it be enough to double the current space?
-        if( aSize < m_freeSpace + m_currentSize )
-        {
-            // Yes: exponential growing
-            result = defragmentResize( m_currentSize * 2 );
-        }
-        else
+        if( m_currentSize - newChunkOffset < newChunkSize )
         {
-            // No: grow to the nearest greater power of 2
-            result = defragmentResize( pow( 2, ceil( log2( m_currentSize * 2 + aSize ) ) ) );
-        }
+            unsigned int newSize = m_currentSize * 2;
+
+            while( newSize - newChunkOffset < newChunkSize )
+                newSize *= 2;
 
-        if( !result )
-            return false;
+            PROF_COUNTER resizeTime;
+
+            if( !resize( newSize ) )
+                return false;
+
+            resizeTime.Stop();
+
+            wxLogTrace( "GAL_CACHED_CONTAINER",
+                        "Enlarged container storing %d vertices to %d / %.1f ms, "
+                        "%d vertices released below the top",
+                        usedSpace(), m_currentSize, resizeTime.msecs(), m_recycledSpace );
+        }
 
-        newChunk = m_freeChunks.lower_bound( aSize );
-        assert( newChunk != m_freeChunks.end() );
+        m_maxIndex = newChunkOffset + newChunkSize;
     }
 
-    // Parameters of the allocated chunk
-    unsigned int newChunkSize   = getChunkSize( *newChunk );
-    unsigned int newChunkOffset = getChunkOffset( *newChunk );
+    assert( newChunkOffset + newChunkSize <= m_currentSize );
 
-    assert( newChunkSize >= aSize );
-    assert( newChunkOffset < m_currentSize );
+    if( growInPlace )
+    {
+        // The item data stays where it is, only the chunk gets larger
+        m_freeSpace -= newChunkSize - m_chunkSize;
+        m_chunkSize = newChunkSize;
+
+        return true;
+    }
 
     // Check if the item was previously stored in the container
     if( itemSize > 0 )
     {
 #if CACHED_CONTAINER_TEST > 3
         wxLogDebug( wxT( "Moving 0x%08x from 0x%08x to 0x%08x" ),
-                    (int) m_item, oldChunkOffset, newChunkOffset );
+                    (int) m_item, m_chunkOffset, newChunkOffset );
 #endif
         // The item was reallocated, so we have to copy all the old data to the new place
         memcpy( &m_vertices[newChunkOffset], &m_vertices[m_chunkOffset], itemSize * VERTEX_SIZE );
@@ -266,8 +251,6 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
         addFreeChunk( m_chunkOffset, m_chunkSize );
     }
 
-    // Remove the new allocated chunk from the free space pool
-    m_freeChunks.erase( newChunk );
     m_freeSpace -= newChunkSize;
 
     m_chunkSize = newChunkSize;
@@ -279,125 +262,125 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
 }
 
 
-void CACHED_CONTAINER::defragment( VERTEX* aTarget )
+unsigned int CACHED_CONTAINER::sizeClass( unsigned int aSize )
 {
-    // Defragmentation
-    ITEMS::iterator it, it_end;
-    int newOffset = 0;
-
-    for( VERTEX_ITEM* item : m_items )
-    {
-        int itemOffset    = item->GetOffset();
-        int itemSize      = item->GetSize();
+    assert( aSize > 0 );
 
-        // Move an item to the new container
-        memcpy( &aTarget[newOffset], &m_vertices[itemOffset], itemSize * VERTEX_SIZE );
+    if( aSize <= 16 )
+        return aSize - 1;
 
-        // Update new offset
-        item->setOffset( newOffset );
+    // Position of the most significant bit of ( aSize - 1 ), at least 4
+    unsigned int msb = 4;
 
-        // Move to the next free space
-        newOffset += itemSize;
-    }
+    while( ( aSize - 1 ) >> ( msb + 1 ) )
+        ++msb;
 
-    // Move the current item and place it at the end
-    if( m_item->GetSize() > 0 )
-    {
-        memcpy( &aTarget[newOffset], &m_vertices[m_item->GetOffset()],
-                m_item->GetSize() * VERTEX_SIZE );
-        m_item->setOffset( newOffset );
-        m_chunkOffset = newOffset;
-    }
+    // The two bits below it select one of four classes between the powers of two
+    unsigned int quarter = ( ( aSize - 1 ) >> ( msb - 2 ) ) - 4;
 
-    m_maxIndex = usedSpace();
+    return 16 + ( msb - 4 ) * 4 + quarter;
 }
 
 
-void CACHED_CONTAINER::mergeFreeChunks()
+unsigned int CACHED_CONTAINER::classSize( unsigned int aClass )
 {
-    if( m_freeChunks.size() <= 1 ) // There are no chunks that can be merged
-        return;
+    if( aClass < 16 )
+        return aClass + 1;
 
-#ifdef __WXDEBUG__
-    PROF_COUNTER totalTime;
-#endif /* __WXDEBUG__ */
+    unsigned int msb = ( aClass - 16 ) / 4 + 4;
+    unsigned int quarter = ( aClass - 16 ) % 4;
 
-    // Reversed free chunks map - this one stores chunk size with its offset as the key
-    std::list<CHUNK> freeChunks;
+    return ( quarter + 5 ) << ( msb - 2 );
+}
 
-    FREE_CHUNK_MAP::const_iterator it, it_end;
 
-    for( it = m_freeChunks.begin(), it_end = m_freeChunks.end(); it != it_end; ++it )
-    {
-        freeChunks.emplace_back( it->second, it->first );
-    }
+void CACHED_CONTAINER::addFreeChunk( unsigned int aOffset, unsigned int aSize )
+{
+    assert( aOffset + aSize <= m_maxIndex );
+    assert( aSize > 0 );
 
-    m_freeChunks.clear();
-    freeChunks.sort();
+    m_freeSpace += aSize;
 
-    std::list<CHUNK>::const_iterator itf, itf_end;
-    unsigned int offset = freeChunks.front().first;
-    unsigned int size   = freeChunks.front().second;
-    freeChunks.pop_front();
+    // Merge with the released regions right before and right after the chunk
+    FREE_REGIONS::iterator next = m_freeRegions.lower_bound( aOffset );
 
-    for( itf = freeChunks.begin(), itf_end = freeChunks.end(); itf != itf_end; ++itf )
+    if( next != m_freeRegions.begin() )
     {
-        if( itf->first == offset + size )
+        FREE_REGIONS::iterator prev = std::prev( next );
+
+        if( prev->first + prev->second == aOffset )
         {
-            // These chunks can be merged, so just increase the current chunk size and go on
-            size += itf->second;
+            aOffset = prev->first;
+            aSize += prev->second;
+            removeFreeRegion( prev );
         }
-        else
-        {
-            // These chunks cannot be merged
-            // So store the previous one
-            m_freeChunks.insert( std::make_pair( size, offset ) );
-            // and let's check the next chunk
-            offset = itf->first;
-            size   = itf->second;
+    }
 
-        }
+    if( next != m_freeRegions.end() && aOffset + aSize == next->first )
+    {
+        aSize += next->second;
+        removeFreeRegion( next );
     }
 
-    // Add the last one
-    m_freeChunks.insert( std::make_pair( size, offset ) );
+    // The topmost region goes back to the never used space
+    if( aOffset + aSize == m_maxIndex )
+    {
+        m_maxIndex = aOffset;
+        return;
+    }
 
-#ifdef __WXDEBUG__
-    totalTime.Stop();
-    wxLogDebug( "Merged free chunks / %.1f ms", totalTime.msecs() );
-#endif /* __WXDEBUG__ */
-#if CACHED_CONTAINER_TEST > 0
-    test();
-#endif
+    m_freeRegions.emplace( aOffset, aSize );
+    m_freeRegionsBySize.emplace( aSize, aOffset );
+    m_recycledSpace += aSize;
 }
 
 
-void CACHED_CONTAINER::addFreeChunk( unsigned int aOffset, unsigned int aSize )
+bool CACHED_CONTAINER::takeFreeChunk( unsigned int aSize, unsigned int& aOffset )
 {
-    assert( aOffset + aSize <= m_currentSize );
-    assert( aSize > 0 );
+    auto bestFit = m_freeRegionsBySize.lower_bound( std::make_pair( aSize, 0u ) );
 
-    m_freeChunks.insert( std::make_pair( aSize, aOffset ) );
-    m_freeSpace += aSize;
+    if( bestFit == m_freeRegionsBySize.end() )
+        return false;
+
+    unsigned int regionSize = bestFit->first;
+    aOffset = bestFit->second;
+
+    removeFreeRegion( m_freeRegions.find( aOffset ) );
+
+    // The remainder is still enclosed by used chunks, so it cannot be merged any further
+    if( regionSize > aSize )
+    {
+        m_freeRegions.emplace( aOffset + aSize, regionSize - aSize );
+        m_freeRegionsBySize.emplace( regionSize - aSize, aOffset + aSize );
+        m_recycledSpace += regionSize - aSize;
+    }
+
+    return true;
+}
+
+
+void CACHED_CONTAINER::removeFreeRegion( FREE_REGIONS::iterator aRegion )
+{
+    assert( aRegion != m_freeRegions.end() );
+
+    m_recycledSpace -= aRegion->second;
+    m_freeRegionsBySize.erase( std::make_pair( aRegion->second, aRegion->first ) );
+    m_freeRegions.erase( aRegion );
 }
 
 
 void CACHED_CONTAINER::showFreeChunks()
 {
 #ifdef __WXDEBUG__
-    FREE_CHUNK_MAP::iterator it;
-
     wxLogDebug( wxT( "Free chunks:" ) );
 
-    for( it = m_freeChunks.begin(); it != m_freeChunks.end(); ++it )
+    for( const auto& region : m_freeRegions )
     {
-        unsigned int offset = getChunkOffset( *it );
-        unsigned int size   = getChunkSize( *it );
-        assert( size > 0 );
-
         wxLogDebug( wxT( "[0x%08x-0x%08x] (size %d)" ),
-                    offset, offset + size - 1, size );
+                    region.first, region.first + region.second - 1, region.second );
     }
+
+    wxLogDebug( wxT( "[0x%08x-0x%08x] (never used)" ), m_maxIndex, m_currentSize - 1 );
 #endif /* __WXDEBUG__ */
 }
 
@@ -427,19 +410,32 @@ void CACHED_CONTAINER::test()
 {
 #ifdef __WXDEBUG__
     // Free space check
-    unsigned int freeSpace = 0;
-    FREE_CHUNK_MAP::iterator itf;
+    unsigned int recycledSpace = 0;
 
-    for( itf = m_freeChunks.begin(); itf != m_freeChunks.end(); ++itf )
-        freeSpace += getChunkSize( *itf );
+    unsigned int regionEnd = 0;
 
-    assert( freeSpace == m_freeSpace );
+    for( const auto& region : m_freeRegions )
+    {
+        // Adjacent released regions are always merged
+        assert( region.first > regionEnd || ( region.first == 0 && regionEnd == 0 ) );
+        regionEnd = region.first + region.second;
+        recycledSpace += region.second;
+    }
+
+    assert( regionEnd < m_maxIndex || m_freeRegions.empty() );
+    assert( m_freeRegionsBySize.size() == m_freeRegions.size() );
+    assert( recycledSpace == m_recycledSpace );
+    assert( m_currentSize - m_maxIndex + recycledSpace == m_freeSpace );
 
     // Used space check
     unsigned int used_space = 0;
     ITEMS::iterator itr;
     for( itr = m_items.begin(); itr != m_items.end(); ++itr )
-        used_space += ( *itr )->GetSize();
+    {
+        // The currently edited item is counted below
+        if( *itr != m_item )
+            used_space += chunkSize( ( *itr )->GetSize() );
+    }
 
     // If we have a chunk assigned, then there must be an item edited
     assert( m_chunkSize == 0 || m_item );
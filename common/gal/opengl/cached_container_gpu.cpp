@@ -28,7 +28,7 @@
 #include <gal/opengl/shader.h>
 #include <gal/opengl/utils.h>
 
-#include <list>
+#include <cstring>
 
 #ifdef __WXDEBUG__
 #include <wx/log.h>
@@ -95,24 +95,20 @@ void CACHED_CONTAINER_GPU::Unmap()
 }
 
 
-bool CACHED_CONTAINER_GPU::defragmentResize( unsigned int aNewSize )
+bool CACHED_CONTAINER_GPU::resize( unsigned int aNewSize )
 {
     if( !m_useCopyBuffer )
-        return defragmentResizeMemcpy( aNewSize );
+        return resizeMemcpy( aNewSize );
 
     wxCHECK( IsMapped(), false );
 
     wxLogTrace( "GAL_CACHED_CONTAINER_GPU",
-            wxT( "Resizing & defragmenting container from %d to %d" ), m_currentSize, aNewSize );
+            wxT( "Resizing container from %d to %d" ), m_currentSize, aNewSize );
 
-    // No shrinking if we cannot fit all the data
-    if( usedSpace() > aNewSize )
+    // No shrinking below the used space
+    if( m_maxIndex > aNewSize )
         return false;
 
-#ifdef __WXDEBUG__
-    PROF_COUNTER totalTime;
-#endif /* __WXDEBUG__ */
-
     GLuint newBuffer;
 
     // glCopyBufferSubData requires a buffer to be unmapped
@@ -130,38 +126,13 @@ bool CACHED_CONTAINER_GPU::defragmentResize( unsigned int aNewSize )
 #endif /* __WXDEBUG__ */
     glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, newBuffer );
     glBufferData( GL_ELEMENT_ARRAY_BUFFER, aNewSize * VERTEX_SIZE, NULL, GL_DYNAMIC_DRAW );
-    checkGlError( "creating buffer during defragmentation" );
-
-    ITEMS::iterator it, it_end;
-    int newOffset = 0;
-
-    // Defragmentation
-    for( it = m_items.begin(), it_end = m_items.end(); it != it_end; ++it )
-    {
-        VERTEX_ITEM* item = *it;
-        int itemOffset    = item->GetOffset();
-        int itemSize      = item->GetSize();
-
-        // Move an item to the new container
-        glCopyBufferSubData( GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER,
-                itemOffset * VERTEX_SIZE, newOffset * VERTEX_SIZE, itemSize * VERTEX_SIZE );
-
-        // Update new offset
-        item->setOffset( newOffset );
-
-        // Move to the next free space
-        newOffset += itemSize;
-    }
+    checkGlError( "creating buffer during resizing" );
 
-    // Move the current item and place it at the end
-    if( m_item->GetSize() > 0 )
+    // Item offsets do not change, so the used space is copied at once
+    if( m_maxIndex > 0 )
     {
         glCopyBufferSubData( GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER,
-                m_item->GetOffset() * VERTEX_SIZE, newOffset * VERTEX_SIZE,
-                m_item->GetSize() * VERTEX_SIZE );
-
-        m_item->setOffset( newOffset );
-        m_chunkOffset = newOffset;
+                0, 0, m_maxIndex * VERTEX_SIZE );
     }
 
     // Cleanup
@@ -176,43 +147,26 @@ bool CACHED_CONTAINER_GPU::defragmentResize( unsigned int aNewSize )
     // Switch to the new vertex buffer
     m_glBufferHandle = newBuffer;
     Map();
-    checkGlError( "switching buffers during defragmentation" );
-
-#ifdef __WXDEBUG__
-    totalTime.Stop();
-
-    wxLogTrace( "GAL_CACHED_CONTAINER_GPU",
-                "Defragmented container storing %d vertices / %.1f ms",
-                m_currentSize - m_freeSpace, totalTime.msecs() );
-#endif /* __WXDEBUG__ */
+    checkGlError( "switching buffers during resizing" );
 
     m_freeSpace += ( aNewSize - m_currentSize );
     m_currentSize = aNewSize;
 
-    // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
-
     return true;
 }
 
 
-bool CACHED_CONTAINER_GPU::defragmentResizeMemcpy( unsigned int aNewSize )
+bool CACHED_CONTAINER_GPU::resizeMemcpy( unsigned int aNewSize )
 {
     wxCHECK( IsMapped(), false );
 
     wxLogTrace( "GAL_CACHED_CONTAINER_GPU",
-            wxT( "Resizing & defragmenting container (memcpy) from %d to %d" ),
-            m_currentSize, aNewSize );
+            wxT( "Resizing container (memcpy) from %d to %d" ), m_currentSize, aNewSize );
 
-    // No shrinking if we cannot fit all the data
-    if( usedSpace() > aNewSize )
+    // No shrinking below the used space
+    if( m_maxIndex > aNewSize )
         return false;
 
-#ifdef __WXDEBUG__
-    PROF_COUNTER totalTime;
-#endif /* __WXDEBUG__ */
-
     GLuint newBuffer;
     VERTEX* newBufferMem;
 
@@ -229,9 +183,10 @@ bool CACHED_CONTAINER_GPU::defragmentResizeMemcpy( unsigned int aNewSize )
     glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, newBuffer );
     glBufferData( GL_ELEMENT_ARRAY_BUFFER, aNewSize * VERTEX_SIZE, NULL, GL_DYNAMIC_DRAW );
     newBufferMem = static_cast<VERTEX*>( glMapBuffer( GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY ) );
-    checkGlError( "creating buffer during defragmentation" );
+    checkGlError( "creating buffer during resizing" );
 
-    defragment( newBufferMem );
+    // Item offsets do not change, so the used space is copied at once
+    memcpy( newBufferMem, m_vertices, m_maxIndex * VERTEX_SIZE );
 
     // Cleanup
     glUnmapBuffer( GL_ELEMENT_ARRAY_BUFFER );
@@ -242,22 +197,10 @@ bool CACHED_CONTAINER_GPU::defragmentResizeMemcpy( unsigned int aNewSize )
     // Switch to the new vertex buffer
     m_glBufferHandle = newBuffer;
     Map();
-    checkGlError( "switching buffers during defragmentation" );
-
-#ifdef __WXDEBUG__
-    totalTime.Stop();
-
-    wxLogTrace( "GAL_CACHED_CONTAINER_GPU",
-                "Defragmented container storing %d vertices / %.1f ms",
-                m_currentSize - m_freeSpace, totalTime.msecs() );
-#endif /* __WXDEBUG__ */
+    checkGlError( "switching buffers during resizing" );
 
     m_freeSpace += ( aNewSize - m_currentSize );
     m_currentSize = aNewSize;
 
-    // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
-
     return true;
 }
@@ -71,45 +71,25 @@ void CACHED_CONTAINER_RAM::Unmap()
 }
 
 
-bool CACHED_CONTAINER_RAM::defragmentResize( unsigned int aNewSize )
+bool CACHED_CONTAINER_RAM::resize( unsigned int aNewSize )
 {
     wxLogTrace( "GAL_CACHED_CONTAINER",
-            wxT( "Resizing & defragmenting container (memcpy) from %d to %d" ),
-            m_currentSize, aNewSize );
+            wxT( "Resizing container (realloc) from %d to %d" ), m_currentSize, aNewSize );
 
-    // No shrinking if we cannot fit all the data
-    if( usedSpace() > aNewSize )
+    // No shrinking below the used space
+    if( m_maxIndex > aNewSize )
         return false;
 
-#ifdef __WXDEBUG__
-    PROF_COUNTER totalTime;
-#endif /* __WXDEBUG__ */
-
-    VERTEX* newBufferMem = static_cast<VERTEX*>( malloc( aNewSize * VERTEX_SIZE ) );
+    // Item offsets do not change, so the stored data is simply moved to the new buffer
+    VERTEX* newBufferMem = static_cast<VERTEX*>( realloc( m_vertices, aNewSize * VERTEX_SIZE ) );
 
     if( !newBufferMem )
         return false;
 
-    defragment( newBufferMem );
-
-    // Switch to the new vertex buffer
-    free( m_vertices );
     m_vertices = newBufferMem;
 
-#ifdef __WXDEBUG__
-    totalTime.Stop();
-
-    wxLogTrace( "GAL_CACHED_CONTAINER",
-                "Defragmented container storing %d vertices / %.1f ms",
-                m_currentSize - m_freeSpace, totalTime.msecs() );
-#endif /* __WXDEBUG__ */
-
     m_freeSpace += ( aNewSize - m_currentSize );
     m_currentSize = aNewSize;
-
-    // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
     m_dirty = true;
 
     return true;
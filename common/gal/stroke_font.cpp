@@ -32,6 +32,11 @@
 #include <wx/string.h>
 #include <gr_text.h>
 
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
 
 using namespace KIGFX;
 
@@ -46,6 +51,147 @@ GLYPH_LIST*         g_newStrokeFontGlyphs = nullptr;     ///< Glyph list
 std::vector<BOX2D>* g_newStrokeFontGlyphBoundingBoxes;   ///< Bounding boxes of the glyphs
 
 
+namespace
+{
+
+/// Everything the layout of a text line depends on
+struct LINE_KEY
+{
+    std::string m_Text;
+    VECTOR2D    m_GlyphSize;
+    double      m_LineWidth;
+    int         m_Style;        ///< horizontal justification, mirroring and italic flags
+
+    bool operator==( const LINE_KEY& aOther ) const
+    {
+        return m_Style == aOther.m_Style && m_GlyphSize == aOther.m_GlyphSize
+               && m_LineWidth == aOther.m_LineWidth && m_Text == aOther.m_Text;
+    }
+};
+
+
+struct LINE_KEY_HASH
+{
+    size_t operator()( const LINE_KEY& aKey ) const
+    {
+        size_t seed = std::hash<std::string>()( aKey.m_Text );
+
+        for( double value : { aKey.m_GlyphSize.x, aKey.m_GlyphSize.y, aKey.m_LineWidth } )
+            seed ^= std::hash<double>()( value ) + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 );
+
+        return seed ^ ( std::hash<int>()( aKey.m_Style ) + 0x9e3779b9 + ( seed << 6 ) );
+    }
+};
+
+}
+
+
+/**
+ * Laid out text lines, kept within a memory budget by evicting the least recently drawn ones.
+ *
+ * Lines are spread over shards by the hash of their key.  Each shard has its own lock, so the
+ * threads drawing text (e.g. plotting while the canvas is redrawn) rarely wait for each other.
+ */
+class STROKE_FONT::LINE_CACHE
+{
+public:
+    typedef std::shared_ptr<const LINE_GEOMETRY> LINE_PTR;
+
+    /// Return the cached line for \a aKey or NULL if it is not cached
+    LINE_PTR Get( const LINE_KEY& aKey )
+    {
+        SHARD& shard = shardFor( aKey );
+        std::lock_guard<std::mutex> lock( shard.m_mutex );
+
+        auto it = shard.m_index.find( aKey );
+
+        if( it == shard.m_index.end() )
+            return LINE_PTR();
+
+        // Move the line to the front of the LRU list
+        shard.m_lru.splice( shard.m_lru.begin(), shard.m_lru, it->second );
+
+        return it->second->m_line;
+    }
+
+    /// Add a line, evicting the least recently used lines if the shard gets too large
+    void Add( const LINE_KEY& aKey, const LINE_PTR& aLine )
+    {
+        SHARD& shard = shardFor( aKey );
+        std::lock_guard<std::mutex> lock( shard.m_mutex );
+
+        auto inserted = shard.m_index.emplace( aKey, shard.m_lru.end() );
+
+        // Another thread laid out the same line in the mean time
+        if( !inserted.second )
+            return;
+
+        ENTRY entry;
+        entry.m_key = &inserted.first->first;
+        entry.m_line = aLine;
+        entry.m_bytes = lineBytes( aKey, *aLine );
+
+        shard.m_lru.push_front( entry );
+        inserted.first->second = shard.m_lru.begin();
+        shard.m_bytes += entry.m_bytes;
+
+        // Always keep the line just added, even if it is larger than the budget on its own
+        while( shard.m_bytes > MAX_SHARD_BYTES && shard.m_lru.size() > 1 )
+        {
+            const ENTRY& oldest = shard.m_lru.back();
+
+            shard.m_bytes -= oldest.m_bytes;
+            shard.m_index.erase( *oldest.m_key );
+            shard.m_lru.pop_back();
+        }
+    }
+
+private:
+    struct ENTRY
+    {
+        const LINE_KEY* m_key;      ///< owned by SHARD::m_index
+        LINE_PTR        m_line;
+        size_t          m_bytes;    ///< approximate memory used by the line and its key
+    };
+
+    typedef std::list<ENTRY> LRU_LIST;
+
+    struct SHARD
+    {
+        SHARD() : m_bytes( 0 ) {}
+
+        std::mutex                                                      m_mutex;
+        LRU_LIST                                                        m_lru;   ///< newest first
+        std::unordered_map<LINE_KEY, LRU_LIST::iterator, LINE_KEY_HASH> m_index;
+        size_t                                                          m_bytes;
+    };
+
+    SHARD& shardFor( const LINE_KEY& aKey )
+    {
+        return m_shards[ LINE_KEY_HASH()( aKey ) % SHARD_COUNT ];
+    }
+
+    static size_t lineBytes( const LINE_KEY& aKey, const LINE_GEOMETRY& aLine )
+    {
+        // Includes a rough estimate of the list and hash map nodes
+        const size_t NODE_OVERHEAD = 64;
+
+        return sizeof( ENTRY ) + sizeof( LINE_KEY ) + NODE_OVERHEAD + aKey.m_Text.capacity()
+               + sizeof( LINE_GEOMETRY )
+               + aLine.m_Overbars.capacity() * sizeof( std::pair<VECTOR2D, VECTOR2D> )
+               + aLine.m_Points.capacity() * sizeof( VECTOR2D )
+               + aLine.m_StrokeSizes.capacity() * sizeof( int );
+    }
+
+    static const size_t SHARD_COUNT = 16;
+
+    /// 32 MB for the whole cache, about 10000 lines of average length
+    static const size_t MAX_SHARD_BYTES = ( 32 << 20 ) / SHARD_COUNT;
+
+    SHARD m_shards[SHARD_COUNT];
+};
+
+
 STROKE_FONT::STROKE_FONT( GAL* aGal ) :
     m_gal( aGal ), m_glyphs( nullptr ), m_glyphBoundingBoxes( nullptr )
 {
@@ -265,57 +411,141 @@ void STROKE_FONT::Draw( const UTF8& aText, const VECTOR2D& aPosition, double aRo
 }
 
 
+void STROKE_FONT::Precache( const UTF8& aText, const EDA_TEXT& aAttributes,
+                            float aLineWidth ) const
+{
+    // Same attributes as GAL::SetTextAttributes() followed by Draw()
+    LINE_ATTRIBUTES attributes;
+    attributes.m_GlyphSize = VECTOR2D( aAttributes.GetTextSize() );
+    attributes.m_LineWidth = aLineWidth;
+    attributes.m_HJustify  = aAttributes.GetHorizJustify();
+    attributes.m_Mirrored  = aAttributes.IsMirrored();
+    attributes.m_Italic    = aAttributes.IsItalic();
+
+    // The GAL stores the line width as a float, which the cache key must match
+    if( aAttributes.IsBold() )
+        attributes.m_LineWidth = (float) ( aLineWidth * BOLD_FACTOR );
+
+    size_t  begin = 0;
+    size_t  newlinePos = aText.find( '\n' );
+
+    while( newlinePos != aText.npos )
+    {
+        getLineGeometry( aText.substr( begin, newlinePos - begin ), attributes );
+
+        begin = newlinePos + 1;
+        newlinePos = aText.find( '\n', begin );
+    }
+
+    if( !aText.empty() )
+        getLineGeometry( aText.substr( begin ), attributes );
+}
+
+
 void STROKE_FONT::drawSingleLineText( const UTF8& aText )
+{
+    LINE_ATTRIBUTES attributes;
+    attributes.m_GlyphSize = m_gal->GetGlyphSize();
+    attributes.m_LineWidth = m_gal->GetLineWidth();
+    attributes.m_HJustify  = m_gal->GetHorizontalJustify();
+    attributes.m_Mirrored  = m_gal->IsTextMirrored();
+    attributes.m_Italic    = m_gal->IsFontItalic();
+
+    std::shared_ptr<const LINE_GEOMETRY> line = getLineGeometry( aText, attributes );
+
+    for( const std::pair<VECTOR2D, VECTOR2D>& overbar : line->m_Overbars )
+        m_gal->DrawLine( overbar.first, overbar.second );
+
+    const VECTOR2D* stroke = line->m_Points.data();
+
+    for( int strokeSize : line->m_StrokeSizes )
+    {
+        m_gal->DrawPolyline( stroke, strokeSize );
+        stroke += strokeSize;
+    }
+}
+
+
+std::shared_ptr<const STROKE_FONT::LINE_GEOMETRY> STROKE_FONT::getLineGeometry(
+        const UTF8& aText, const LINE_ATTRIBUTES& aAttributes ) const
+{
+    // Laying out a line costs much more than drawing it, and the same references, values and
+    // pin names are drawn over and over.  The cache is shared by all the GALs (including the
+    // ones used for plotting), which may run in different threads.
+    static LINE_CACHE cache;
+
+    LINE_KEY key;
+    key.m_Text      = aText;
+    key.m_GlyphSize = aAttributes.m_GlyphSize;
+    key.m_LineWidth = aAttributes.m_LineWidth;
+    key.m_Style     = ( aAttributes.m_HJustify + 1 ) * 4
+                      + ( aAttributes.m_Mirrored ? 2 : 0 ) + ( aAttributes.m_Italic ? 1 : 0 );
+
+    if( std::shared_ptr<const LINE_GEOMETRY> cached = cache.Get( key ) )
+        return cached;
+
+    auto line = std::make_shared<LINE_GEOMETRY>();
+    buildSingleLineText( aText, aAttributes, *line );
+
+    cache.Add( key, line );
+
+    return line;
+}
+
+
+void STROKE_FONT::buildSingleLineText( const UTF8& aText, const LINE_ATTRIBUTES& aAttributes,
+                                       LINE_GEOMETRY& aLine ) const
 {
     double      xOffset;
     double      yOffset;
-    VECTOR2D    baseGlyphSize( m_gal->GetGlyphSize() );
-    double      overbar_italic_comp = computeOverbarVerticalPosition() * ITALIC_TILT;
+    VECTOR2D    baseGlyphSize( aAttributes.m_GlyphSize );
+    double      overbarPosition = ComputeOverbarVerticalPosition( aAttributes.m_GlyphSize.y,
+                                                                  aAttributes.m_LineWidth );
+    double      overbar_italic_comp = overbarPosition * ITALIC_TILT;
 
-    if( m_gal->IsTextMirrored() )
+    if( aAttributes.m_Mirrored )
         overbar_italic_comp = -overbar_italic_comp;
 
     // Compute the text size
-    VECTOR2D textSize = computeTextLineSize( aText );
-    double half_thickness = m_gal->GetLineWidth()/2;
-
-    // Context needs to be saved before any transformations
-    m_gal->Save();
+    VECTOR2D textSize = computeStringBoundaryLimits( aText, aAttributes.m_GlyphSize,
+                                                     aAttributes.m_LineWidth,
+                                                     aAttributes.m_Italic );
+    double half_thickness = aAttributes.m_LineWidth/2;
 
     // First adjust: the text X position is corrected by half_thickness
     // because when the text with thickness is draw, its full size is textSize,
     // but the position of lines is half_thickness to textSize - half_thickness
     // so we must translate the coordinates by half_thickness on the X axis
     // to place the text inside the 0 to textSize X area.
-    m_gal->Translate( VECTOR2D( half_thickness, 0 ) );
+    double xShift = half_thickness;
 
     // Adjust the text position to the given horizontal justification
-    switch( m_gal->GetHorizontalJustify() )
+    switch( aAttributes.m_HJustify )
     {
     case GR_TEXT_HJUSTIFY_CENTER:
-        m_gal->Translate( VECTOR2D( -textSize.x / 2.0, 0 ) );
+        xShift -= textSize.x / 2.0;
         break;
 
     case GR_TEXT_HJUSTIFY_RIGHT:
-        if( !m_gal->IsTextMirrored() )
-            m_gal->Translate( VECTOR2D( -textSize.x, 0 ) );
+        if( !aAttributes.m_Mirrored )
+            xShift -= textSize.x;
         break;
 
     case GR_TEXT_HJUSTIFY_LEFT:
-        if( m_gal->IsTextMirrored() )
-            m_gal->Translate( VECTOR2D( -textSize.x, 0 ) );
+        if( aAttributes.m_Mirrored )
+            xShift -= textSize.x;
         break;
 
     default:
         break;
     }
 
-    if( m_gal->IsTextMirrored() )
+    if( aAttributes.m_Mirrored )
     {
         // In case of mirrored text invert the X scale of points and their X direction
         // (m_glyphSize.x) and start drawing from the position where text normally should end
         // (textSize.x)
-        xOffset = textSize.x - m_gal->GetLineWidth();
+        xOffset = textSize.x - aAttributes.m_LineWidth;
         baseGlyphSize.x = -baseGlyphSize.x;
     }
     else
@@ -430,22 +660,22 @@ void STROKE_FONT::drawSingleLineText( const UTF8& aText )
         if( in_overbar )
         {
             double overbar_start_x = xOffset;
-            double overbar_start_y = - computeOverbarVerticalPosition();
+            double overbar_start_y = - overbarPosition;
             double overbar_end_x = xOffset + glyphSize.x * bbox.GetEnd().x;
             double overbar_end_y = overbar_start_y;
 
             if( !last_had_overbar )
             {
-                if( m_gal->IsFontItalic() )
+                if( aAttributes.m_Italic )
                     overbar_start_x += overbar_italic_comp;
 
                 last_had_overbar = true;
             }
 
-            VECTOR2D startOverbar( overbar_start_x, overbar_start_y );
-            VECTOR2D endOverbar( overbar_end_x, overbar_end_y );
+            VECTOR2D startOverbar( overbar_start_x + xShift, overbar_start_y );
+            VECTOR2D endOverbar( overbar_end_x + xShift, overbar_end_y );
 
-            m_gal->DrawLine( startOverbar, endOverbar );
+            aLine.m_Overbars.emplace_back( startOverbar, endOverbar );
         }
         else
         {
@@ -454,32 +684,34 @@ void STROKE_FONT::drawSingleLineText( const UTF8& aText )
 
         for( const std::vector<VECTOR2D>* ptList : *glyph )
         {
-            std::deque<VECTOR2D> ptListScaled;
+            aLine.m_StrokeSizes.push_back( ptList->size() );
 
             for( const VECTOR2D& pt : *ptList )
             {
-                VECTOR2D scaledPt( pt.x * glyphSize.x + xOffset, pt.y * glyphSize.y + yOffset );
+                VECTOR2D scaledPt( pt.x * glyphSize.x + xOffset + xShift,
+                                   pt.y * glyphSize.y + yOffset );
 
-                if( m_gal->IsFontItalic() )
+                if( aAttributes.m_Italic )
                 {
                     // FIXME should be done other way - referring to the lowest Y value of point
                     // because now italic fonts are translated a bit
-                    if( m_gal->IsTextMirrored() )
+                    if( aAttributes.m_Mirrored )
                         scaledPt.x += scaledPt.y * STROKE_FONT::ITALIC_TILT;
                     else
                         scaledPt.x -= scaledPt.y * STROKE_FONT::ITALIC_TILT;
                 }
 
-                ptListScaled.push_back( scaledPt );
+                aLine.m_Points.push_back( scaledPt );
             }
-
-            m_gal->DrawPolyline( ptListScaled );
         }
 
         xOffset += glyphSize.x * bbox.GetEnd().x;
     }
 
-    m_gal->Restore();
+    // The line is kept in the cache, so do not waste the spare capacity
+    aLine.m_Overbars.shrink_to_fit();
+    aLine.m_Points.shrink_to_fit();
+    aLine.m_StrokeSizes.shrink_to_fit();
 }
 
 
@@ -510,6 +742,14 @@ VECTOR2D STROKE_FONT::computeTextLineSize( const UTF8& aText ) const
 
 VECTOR2D STROKE_FONT::ComputeStringBoundaryLimits( const UTF8& aText, const VECTOR2D& aGlyphSize,
                                                    double aGlyphThickness ) const
+{
+    return computeStringBoundaryLimits( aText, aGlyphSize, aGlyphThickness,
+                                        m_gal->IsFontItalic() );
+}
+
+
+VECTOR2D STROKE_FONT::computeStringBoundaryLimits( const UTF8& aText, const VECTOR2D& aGlyphSize,
+                                                   double aGlyphThickness, bool aItalic ) const
 {
     VECTOR2D string_bbox;
     int line_count = 1;
@@ -607,7 +847,7 @@ VECTOR2D STROKE_FONT::ComputeStringBoundaryLimits( const UTF8& aText, const VECT
     string_bbox.y = line_count * GetInterline( aGlyphSize.y );
 
     // For italic correction, take in account italic tilt
-    if( m_gal->IsFontItalic() )
+    if( aItalic )
         string_bbox.x += string_bbox.y * STROKE_FONT::ITALIC_TILT;
 
     return string_bbox;
@@ -29,9 +29,15 @@
 
 using namespace KIGFX;
 
+// Smallest size in pixels that can still be seen on the screen
+static const double MIN_VISIBLE_SIZE = 1.0;
+
+
 PAINTER::PAINTER( GAL* aGal ) :
     m_gal( aGal ),
-    m_brightenedColor( 0.0, 1.0, 0.0, 0.9 )
+    m_brightenedColor( 0.0, 1.0, 0.0, 0.9 ),
+    m_cullingStats( { 0, 0 } ),
+    m_cachedCullingScale( 0.0 )
 {
 }
 
@@ -39,3 +45,34 @@ PAINTER::PAINTER( GAL* aGal ) :
 PAINTER::~PAINTER()
 {
 }
+
+
+bool PAINTER::IsItemCulled( double aWorldSize )
+{
+    if( aWorldSize * m_gal->GetWorldScale() < MIN_VISIBLE_SIZE )
+    {
+        m_cullingStats.m_culled++;
+        return true;
+    }
+
+    m_cullingStats.m_emitted++;
+    return false;
+}
+
+
+bool PAINTER::isCulled( double aWorldSize )
+{
+    if( m_gal->GetTarget() != TARGET_CACHED )
+        return IsItemCulled( aWorldSize );
+
+    // Cached groups are reused at every scale, so they have to be complete unless they are
+    // known to be drawn only below a given scale
+    if( m_cachedCullingScale > 0.0 && aWorldSize * m_cachedCullingScale < MIN_VISIBLE_SIZE )
+    {
+        m_cullingStats.m_culled++;
+        return true;
+    }
+
+    m_cullingStats.m_emitted++;
+    return false;
+}
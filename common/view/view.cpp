@@ -37,6 +37,13 @@
 #include <gal/graphics_abstraction_layer.h>
 #include <painter.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <thread>
+
 #ifdef __WXDEBUG__
 #include <profile.h>
 #endif /* __WXDEBUG__  */
@@ -52,7 +59,11 @@ public:
         m_view( nullptr ),
         m_flags( KIGFX::VISIBLE ),
         m_requiredUpdate( KIGFX::NONE ),
+        m_updateQueueIndex( -1 ),
+        m_backgroundUpdate( KIGFX::NONE ),
+        m_backgroundQueueIndex( -1 ),
         m_drawPriority( 0 ),
+        m_viewSize( 0.0 ),
         m_groups( nullptr ),
         m_groupsSize( 0 ) {}
 
@@ -89,7 +100,13 @@ private:
     VIEW*   m_view;             ///< Current dynamic view the item is assigned to.
     int     m_flags;            ///< Visibility flags
     int     m_requiredUpdate;   ///< Flag required for updating
+    int     m_updateQueueIndex; ///< Index of the item on the dirty item queue of m_view, or -1
+    int     m_backgroundUpdate; ///< Flag required for the pending background update
+    int     m_backgroundQueueIndex; ///< Index of the item on the background update queue of
+                                    ///< m_view, or -1
     int     m_drawPriority;     ///< Order to draw this item in a layer, lowest first
+    VECTOR2I m_lodCenter;       ///< Bounding box center used to assign the item to LOD tiles
+    double  m_viewSize;         ///< Largest dimension of the bounding box, used for culling
 
     ///> Helper for storing cached items group ids
     typedef std::pair<int, int> GroupPair;
@@ -268,6 +285,15 @@ private:
 };
 
 
+/// Returns the largest dimension of the bounding box of an item, in world units
+static double viewItemSize( const VIEW_ITEM* aItem )
+{
+    const BOX2I bbox = aItem->ViewBBox();
+
+    return std::max( std::abs( (double) bbox.GetWidth() ), std::abs( (double) bbox.GetHeight() ) );
+}
+
+
 void VIEW::OnDestroy( VIEW_ITEM* aItem )
 {
     auto data = aItem->viewPrivData();
@@ -285,6 +311,7 @@ void VIEW::OnDestroy( VIEW_ITEM* aItem )
 
 VIEW::VIEW( bool aIsDynamic ) :
     m_enableOrderModifier( true ),
+    m_bulkAdd( false ),
     m_scale( 4.0 ),
     m_minScale( 0.2 ), m_maxScale( 25000.0 ),
     m_mirrorX( false ), m_mirrorY( false ),
@@ -293,7 +320,12 @@ VIEW::VIEW( bool aIsDynamic ) :
     m_dynamic( aIsDynamic ),
     m_useDrawPriority( false ),
     m_nextDrawPriority( 0 ),
-    m_reverseDrawOrder( false )
+    m_reverseDrawOrder( false ),
+    m_lastUpdatedItemsCount( 0 ),
+    m_lodScale( 0.0 ),
+    m_lodTileSize( 1 ),
+    m_lodReset( false ),
+    m_lodVisibilityChanged( false )
 {
     // Set m_boundary to define the max area size. The default area size
     // is defined here as the max value of a int.
@@ -352,19 +384,33 @@ void VIEW::Add( VIEW_ITEM* aItem, int aDrawPriority )
 
     if( !aItem->m_viewPrivData )
         aItem->m_viewPrivData = new VIEW_ITEM_DATA;
+    else if( aItem->m_viewPrivData->m_view != this )
+    {
+        // left over from another VIEW
+        aItem->m_viewPrivData->m_updateQueueIndex = -1;
+        aItem->m_viewPrivData->m_backgroundUpdate = NONE;
+        aItem->m_viewPrivData->m_backgroundQueueIndex = -1;
+    }
 
     aItem->m_viewPrivData->m_view = this;
     aItem->m_viewPrivData->m_drawPriority = aDrawPriority;
 
     aItem->ViewGetLayers( layers, layers_count );
     aItem->viewPrivData()->saveLayers( layers, layers_count );
+    aItem->viewPrivData()->m_viewSize = viewItemSize( aItem );
+    trackLODItem( aItem );
 
     m_allItems->push_back( aItem );
 
     for( int i = 0; i < layers_count; ++i )
     {
         VIEW_LAYER& l = m_layers[layers[i]];
-        l.items->Insert( aItem );
+
+        if( m_bulkAdd )
+            m_bulkAddItems[layers[i]].push_back( aItem );
+        else
+            l.items->Insert( aItem );
+
         MarkTargetDirty( l.target );
     }
 
@@ -392,6 +438,33 @@ void VIEW::Remove( VIEW_ITEM* aItem )
         viewData->clearUpdateFlags();
     }
 
+    if( viewData->m_updateQueueIndex >= 0 )
+    {
+        // The queue order does not matter, so the last item takes the place of the removed one
+        VIEW_ITEM* last = m_dirtyItems.back();
+
+        m_dirtyItems[viewData->m_updateQueueIndex] = last;
+        last->viewPrivData()->m_updateQueueIndex = viewData->m_updateQueueIndex;
+        m_dirtyItems.pop_back();
+
+        viewData->m_updateQueueIndex = -1;
+    }
+
+    if( viewData->m_backgroundQueueIndex >= 0 )
+    {
+        // Same as above, the queue gets reordered anyway once the view moves
+        VIEW_ITEM* last = m_backgroundItems.back();
+
+        m_backgroundItems[viewData->m_backgroundQueueIndex] = last;
+        last->viewPrivData()->m_backgroundQueueIndex = viewData->m_backgroundQueueIndex;
+        m_backgroundItems.pop_back();
+
+        viewData->m_backgroundUpdate = NONE;
+        viewData->m_backgroundQueueIndex = -1;
+    }
+
+    dirtyLODTiles( aItem );
+
     int layers[VIEW::VIEW_MAX_LAYERS], layers_count;
     viewData->getLayers( layers, layers_count );
 
@@ -401,6 +474,12 @@ void VIEW::Remove( VIEW_ITEM* aItem )
         l.items->Remove( aItem );
         MarkTargetDirty( l.target );
 
+        if( m_bulkAdd )
+        {
+            std::vector<VIEW_ITEM*>& pending = m_bulkAddItems[layers[i]];
+            pending.erase( std::remove( pending.begin(), pending.end(), aItem ), pending.end() );
+        }
+
         // Clear the GAL cache
         int prevGroup = viewData->getGroup( layers[i] );
 
@@ -413,6 +492,69 @@ void VIEW::Remove( VIEW_ITEM* aItem )
 }
 
 
+void VIEW::BeginBulkAdd()
+{
+    m_bulkAdd = true;
+}
+
+
+void VIEW::EndBulkAdd()
+{
+    if( !m_bulkAdd )
+        return;
+
+    m_bulkAdd = false;
+
+    typedef std::vector<std::pair<VIEW_RTREE::Rect, VIEW_ITEM*>> ENTRIES;
+    std::vector<std::pair<VIEW_RTREE*, ENTRIES>> layerEntries;
+
+    // Bounding boxes are taken here, not in the worker threads: some items compute them
+    // lazily, and an item usually lives on several layers.
+    for( auto& pending : m_bulkAddItems )
+    {
+        if( pending.second.empty() )
+            continue;
+
+        layerEntries.emplace_back( m_layers[pending.first].items.get(), ENTRIES() );
+
+        ENTRIES& entries = layerEntries.back().second;
+        entries.reserve( pending.second.size() );
+
+        for( VIEW_ITEM* item : pending.second )
+            entries.emplace_back( VIEW_RTREE::ItemBounds( item ), item );
+    }
+
+    m_bulkAddItems.clear();
+
+    // Biggest layers first, so that they don't end up last on a single thread
+    std::sort( layerEntries.begin(), layerEntries.end(),
+            []( const std::pair<VIEW_RTREE*, ENTRIES>& aA,
+                const std::pair<VIEW_RTREE*, ENTRIES>& aB )
+            {
+                return aA.second.size() > aB.second.size();
+            } );
+
+    std::atomic<size_t> nextLayer( 0 );
+    size_t              parallelThreadCount =
+            std::min<size_t>( std::thread::hardware_concurrency(), layerEntries.size() );
+    std::vector<std::future<void>> returns;
+
+    auto build_lambda = [&]()
+    {
+        for( size_t i = nextLayer++; i < layerEntries.size(); i = nextLayer++ )
+            layerEntries[i].first->BulkInsert( layerEntries[i].second );
+    };
+
+    for( size_t ii = 1; ii < parallelThreadCount; ++ii )
+        returns.push_back( std::async( std::launch::async, build_lambda ) );
+
+    build_lambda();
+
+    for( std::future<void>& ret : returns )
+        ret.wait();
+}
+
+
 void VIEW::SetRequired( int aLayerId, int aRequiredId, bool aRequired )
 {
     wxCHECK( (unsigned) aLayerId < m_layers.size(), /*void*/ );
@@ -727,6 +869,7 @@ void VIEW::ReorderLayerData( std::unordered_map<int, int> aReorderMap )
     }
 
     m_layers = new_map;
+    m_lodReset = true;
 
     for( VIEW_ITEM* item : *m_allItems )
     {
@@ -743,6 +886,7 @@ void VIEW::ReorderLayerData( std::unordered_map<int, int> aReorderMap )
         viewData->reorderGroups( aReorderMap );
 
         viewData->m_requiredUpdate |= COLOR;
+        MarkForUpdate( item );
     }
 
     UpdateItems();
@@ -792,6 +936,9 @@ void VIEW::UpdateLayerColor( int aLayer )
         m_layers[aLayer].items->Query( r, visitor );
         MarkTargetDirty( m_layers[aLayer].target );
     }
+
+    // Tile groups may hold items of different colors, so they are redrawn
+    dirtyLODLayer( aLayer );
 }
 
 
@@ -822,6 +969,9 @@ void VIEW::UpdateAllLayersColor()
         }
     }
 
+    for( auto& lod : m_lodLayers )
+        dirtyLODLayer( lod.first );
+
     MarkDirty();
 }
 
@@ -950,6 +1100,16 @@ void VIEW::UpdateAllLayersOrder()
                     m_gal->ChangeGroupDepth( group, m_layers[layers[i]].renderingOrder );
             }
         }
+
+        for( const auto& lod : m_lodLayers )
+        {
+            for( const auto& tile : lod.second.tiles )
+            {
+                if( tile.second.group >= 0 )
+                    m_gal->ChangeGroupDepth( tile.second.group,
+                                             m_layers[lod.first].renderingOrder );
+            }
+        }
     }
 
     MarkDirty();
@@ -960,6 +1120,7 @@ struct VIEW::drawItem
 {
     drawItem( VIEW* aView, int aLayer, bool aUseDrawPriority, bool aReverseDrawOrder ) :
         view( aView ), layer( aLayer ),
+        cached( aView->IsCached( aLayer ) ),
         useDrawPriority( aUseDrawPriority ),
         reverseDrawOrder( aReverseDrawOrder )
     {
@@ -975,6 +1136,11 @@ struct VIEW::drawItem
         if( !drawCondition )
             return true;
 
+        // The painter culls its own sub-pixel primitives only when drawing immediately, as
+        // cached groups are reused at every scale.  Whole cached items are culled here instead.
+        if( cached && view->m_painter->IsItemCulled( aItem->viewPrivData()->m_viewSize ) )
+            return true;
+
         if( useDrawPriority )
             drawItems.push_back( aItem );
         else
@@ -1002,13 +1168,15 @@ struct VIEW::drawItem
 
     VIEW* view;
     int layer, layers[VIEW_MAX_LAYERS];
-    bool useDrawPriority, reverseDrawOrder;
+    bool cached, useDrawPriority, reverseDrawOrder;
     std::vector<VIEW_ITEM*> drawItems;
 };
 
 
 void VIEW::redrawRect( const BOX2I& aRect )
 {
+    bool useLOD = isLODActive();
+
     for( VIEW_LAYER* l : m_orderedLayers )
     {
         if( l->visible && IsTargetDirty( l->target ) && areRequiredLayersEnabled( l->id ) )
@@ -1017,6 +1185,10 @@ void VIEW::redrawRect( const BOX2I& aRect )
 
             m_gal->SetTarget( l->target );
             m_gal->SetLayerDepth( l->renderingOrder );
+
+            if( useLOD && IsCached( l->id ) && drawLODTiles( *l, aRect ) )
+                continue;
+
             l->items->Query( aRect, drawFunc );
 
             if( m_useDrawPriority )
@@ -1041,7 +1213,7 @@ void VIEW::draw( VIEW_ITEM* aItem, int aLayer, bool aImmediate )
         if( group >= 0 )
             m_gal->DrawGroup( group );
         else
-            Update( aItem );
+            Update( aItem, REPAINT );   // Groups are not built while the item is hidden
     }
     else
     {
@@ -1113,6 +1285,20 @@ void VIEW::Clear()
     BOX2I r;
     r.SetMaximum();
     m_allItems->clear();
+    m_bulkAddItems.clear();
+
+    for( VIEW_ITEM* item : m_dirtyItems )
+        item->viewPrivData()->m_updateQueueIndex = -1;
+
+    m_dirtyItems.clear();
+
+    for( VIEW_ITEM* item : m_backgroundItems )
+    {
+        item->viewPrivData()->m_backgroundUpdate = NONE;
+        item->viewPrivData()->m_backgroundQueueIndex = -1;
+    }
+
+    m_backgroundItems.clear();
 
     for( LAYER_MAP_ITER i = m_layers.begin(); i != m_layers.end(); ++i )
         i->second.items->RemoveAll();
@@ -1120,6 +1306,9 @@ void VIEW::Clear()
     m_nextDrawPriority = 0;
 
     m_gal->ClearCache();
+
+    // The tile groups went away with the cache
+    clearLODTiles( false );
 }
 
 
@@ -1210,11 +1399,16 @@ void VIEW::clearGroupCache()
         VIEW_LAYER* l = &( ( *i ).second );
         l->items->Query( r, visitor );
     }
+
+    clearLODTiles( false );
 }
 
 
 void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
 {
+    // The tiles holding the item before the change
+    dirtyLODTiles( aItem );
+
     if( aUpdateFlags & INITIAL_ADD )
     {
         // Don't update layers or bbox, since it was done in VIEW::Add()
@@ -1232,6 +1426,9 @@ void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
         {
             updateBbox( aItem );
         }
+
+        if( aUpdateFlags & ( GEOMETRY | LAYERS ) )
+            aItem->viewPrivData()->m_viewSize = viewItemSize( aItem );
     }
 
     int layers[VIEW_MAX_LAYERS], layers_count;
@@ -1245,7 +1442,15 @@ void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
         if( IsCached( layerId ) )
         {
             if( aUpdateFlags & ( GEOMETRY | LAYERS | REPAINT ) )
-                updateItemGeometry( aItem, layerId );
+            {
+                // Do not build geometry nobody can see.  draw() requests a repaint if the
+                // item is drawn on the layer later.  An existing group is kept up to date,
+                // so showing the layer again does not rebuild all of its items.
+                bool hasGroup = aItem->viewPrivData()->getGroup( layerId ) >= 0;
+
+                if( hasGroup || !isHiddenOnLayer( aItem, layerId ) )
+                    updateItemGeometry( aItem, layerId );
+            }
             else if( aUpdateFlags & COLOR )
                 updateItemColor( aItem, layerId );
         }
@@ -1254,6 +1459,7 @@ void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
         MarkTargetDirty( m_layers[layerId].target );
     }
 
+    trackLODItem( aItem );
     aItem->viewPrivData()->clearUpdateFlags();
 }
 
@@ -1292,6 +1498,15 @@ void VIEW::updateItemColor( VIEW_ITEM* aItem, int aLayer )
 }
 
 
+bool VIEW::isHiddenOnLayer( VIEW_ITEM* aItem, int aLayer )
+{
+    const VIEW_LAYER& l = m_layers.at( aLayer );
+
+    return !l.visible || !areRequiredLayersEnabled( aLayer )
+           || aItem->ViewGetLOD( aLayer, this ) == std::numeric_limits<unsigned int>::max();
+}
+
+
 void VIEW::updateItemGeometry( VIEW_ITEM* aItem, int aLayer )
 {
     auto viewData = aItem->viewPrivData();
@@ -1415,6 +1630,59 @@ void VIEW::RecacheAllItems()
             l->items->Query( r, visitor );
         }
     }
+
+    for( auto& lod : m_lodLayers )
+        dirtyLODLayer( lod.first );
+}
+
+
+void VIEW::precacheItems( const std::vector<VIEW_ITEM*>& aItems )
+{
+    // Spawning threads is not worth it for the few items changed by a typical edit; their
+    // painter does the same work when drawing them anyway.
+    const size_t MIN_ITEMS_TO_PRECACHE = 256;
+
+    if( !m_painter || aItems.size() < MIN_ITEMS_TO_PRECACHE )
+        return;
+
+    std::vector<const VIEW_ITEM*> items;
+
+    for( VIEW_ITEM* item : aItems )
+    {
+        if( item->viewPrivData()->m_requiredUpdate & ( INITIAL_ADD | GEOMETRY | LAYERS | REPAINT ) )
+            items.push_back( item );
+    }
+
+    std::atomic<size_t> nextItem( 0 );
+    size_t              parallelThreadCount = std::min<size_t>(
+            std::thread::hardware_concurrency(), items.size() / MIN_ITEMS_TO_PRECACHE + 1 );
+    std::vector<std::future<void>> returns;
+
+    auto precache_lambda = [&]()
+    {
+        for( size_t i = nextItem++; i < items.size(); i = nextItem++ )
+            m_painter->Precache( items[i] );
+    };
+
+    for( size_t ii = 1; ii < parallelThreadCount; ++ii )
+        returns.push_back( std::async( std::launch::async, precache_lambda ) );
+
+    precache_lambda();
+
+    for( std::future<void>& ret : returns )
+        ret.wait();
+}
+
+
+void VIEW::MarkForUpdate( VIEW_ITEM* aItem )
+{
+    auto viewData = aItem->viewPrivData();
+
+    if( !viewData || viewData->m_updateQueueIndex >= 0 )
+        return;
+
+    viewData->m_updateQueueIndex = m_dirtyItems.size();
+    m_dirtyItems.push_back( aItem );
 }
 
 
@@ -1422,21 +1690,146 @@ void VIEW::UpdateItems()
 {
     if( m_gal->IsVisible() )
     {
+#ifdef __WXDEBUG__
+        PROF_COUNTER totalRealTime;
+#endif /* __WXDEBUG__ */
+
         GAL_UPDATE_CONTEXT ctx( m_gal );
 
-        for( VIEW_ITEM* item : *m_allItems )
+        // Items marked while we are updating (if any) are left for the next call
+        std::vector<VIEW_ITEM*> dirtyItems;
+        dirtyItems.swap( m_dirtyItems );
+
+        // An immediate update supersedes a pending background one
+        for( VIEW_ITEM* item : dirtyItems )
         {
             auto viewData = item->viewPrivData();
+            viewData->m_updateQueueIndex = -1;
+            viewData->m_requiredUpdate |= viewData->m_backgroundUpdate;
+            viewData->m_backgroundUpdate = NONE;
+        }
 
-            if( !viewData )
+        precacheItems( dirtyItems );
+
+        for( VIEW_ITEM* item : dirtyItems )
+        {
+            auto viewData = item->viewPrivData();
+
+            if( viewData->m_requiredUpdate != NONE )
+            {
+                invalidateItem( item, viewData->m_requiredUpdate );
+                viewData->m_requiredUpdate = NONE;
+            }
+        }
+
+        m_lastUpdatedItemsCount = dirtyItems.size();
+
+        // Leave enough of the frame for the redraw, so the view stays responsive while
+        // the background queue is being processed
+        const double BACKGROUND_UPDATE_BUDGET_MS = 20.0;
+
+        updateBackgroundItems( BACKGROUND_UPDATE_BUDGET_MS );
+
+        // Tile groups are only kept while zoomed out, with some margin so zooming back and
+        // forth around the threshold does not rebuild them every time
+        const double LOD_RELEASE_FACTOR = 1.5;
+
+        // Tile groups can only be built in an update context, so they are prepared here
+        // for the following redraw
+        if( isLODActive() )
+            updateLODTiles();
+        else if( !m_lodLayers.empty()
+                 && ( m_useDrawPriority || m_scale > LOD_RELEASE_FACTOR * m_lodScale ) )
+            clearLODTiles( true );
+
+        // Keep the allocation around, the queue is refilled on every edit
+        dirtyItems.clear();
+
+        if( m_dirtyItems.empty() )
+            m_dirtyItems.swap( dirtyItems );
+
+#ifdef __WXDEBUG__
+        totalRealTime.Stop();
+        wxLogTrace( "GAL_PROFILE", "VIEW::UpdateItems(): %d items, %.1f ms",
+                    (int) m_lastUpdatedItemsCount, totalRealTime.msecs() );
+#endif /* __WXDEBUG__ */
+    }
+}
+
+
+void VIEW::updateBackgroundItems( double aBudgetMs )
+{
+    if( m_backgroundItems.empty() )
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    auto elapsedMs = [&start]()
+    {
+        return std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start ).count();
+    };
+
+    // Reorder the queue whenever the view has moved, so what the user is looking at gets
+    // refreshed first. Items outside of the viewport go to the front of the queue.
+    BOX2D viewport = GetViewport();
+
+    if( viewport != m_backgroundViewport )
+    {
+        m_backgroundViewport = viewport;
+
+        std::partition( m_backgroundItems.begin(), m_backgroundItems.end(),
+                [&viewport]( VIEW_ITEM* aItem )
+                {
+                    const BOX2I bbox = aItem->ViewBBox();
+                    BOX2D itemBox( VECTOR2D( bbox.GetPosition() ), VECTOR2D( bbox.GetSize() ) );
+
+                    return !viewport.Intersects( itemBox.Normalize() );
+                } );
+
+        for( size_t i = 0; i < m_backgroundItems.size(); ++i )
+            m_backgroundItems[i]->viewPrivData()->m_backgroundQueueIndex = i;
+    }
+
+    // Items are refreshed in chunks, large enough to be precached in parallel
+    const size_t CHUNK_SIZE = 1024;
+    std::vector<VIEW_ITEM*> chunk;
+
+    while( !m_backgroundItems.empty() && elapsedMs() < aBudgetMs )
+    {
+        chunk.clear();
+
+        while( chunk.size() < CHUNK_SIZE && !m_backgroundItems.empty() )
+        {
+            VIEW_ITEM* item = m_backgroundItems.back();
+            auto viewData = item->viewPrivData();
+
+            m_backgroundItems.pop_back();
+            viewData->m_backgroundQueueIndex = -1;
+
+            // Already refreshed by an immediate update
+            if( viewData->m_backgroundUpdate == NONE )
                 continue;
 
+            viewData->m_requiredUpdate |= viewData->m_backgroundUpdate;
+            viewData->m_backgroundUpdate = NONE;
+            chunk.push_back( item );
+        }
+
+        precacheItems( chunk );
+
+        for( VIEW_ITEM* item : chunk )
+        {
+            auto viewData = item->viewPrivData();
+
             if( viewData->m_requiredUpdate != NONE )
             {
                 invalidateItem( item, viewData->m_requiredUpdate );
                 viewData->m_requiredUpdate = NONE;
             }
         }
+
+        m_lastUpdatedItemsCount += chunk.size();
     }
 }
 
@@ -1451,6 +1844,7 @@ void VIEW::UpdateAllItems( int aUpdateFlags )
             continue;
 
         viewData->m_requiredUpdate |= aUpdateFlags;
+        MarkForUpdate( item );
     }
 }
 
@@ -1468,11 +1862,346 @@ void VIEW::UpdateAllItemsConditionally( int aUpdateFlags,
                 continue;
 
             viewData->m_requiredUpdate |= aUpdateFlags;
+            MarkForUpdate( item );
         }
     }
 }
 
 
+void VIEW::UpdateAllItemsInBackground( int aUpdateFlags,
+                                       std::function<bool( VIEW_ITEM* )> aCondition )
+{
+    for( VIEW_ITEM* item : *m_allItems )
+    {
+        if( !aCondition || aCondition( item ) )
+            UpdateInBackground( item, aUpdateFlags );
+    }
+}
+
+
+void VIEW::SetLODScale( double aScale, int aTileSize )
+{
+    wxCHECK( aTileSize > 0, /*void*/ );
+
+    clearLODTiles( true );
+    m_lodScale = aScale;
+    m_lodTileSize = aTileSize;
+    MarkDirty();
+}
+
+
+VECTOR2I VIEW::lodTileCell( const VECTOR2I& aPoint ) const
+{
+    return VECTOR2I( (int) std::floor( (double) aPoint.x / m_lodTileSize ),
+                     (int) std::floor( (double) aPoint.y / m_lodTileSize ) );
+}
+
+
+void VIEW::dirtyLODTiles( VIEW_ITEM* aItem )
+{
+    auto viewData = aItem->viewPrivData();
+
+    if( m_lodLayers.empty() || !viewData )
+        return;
+
+    int64_t key = lodTileKey( lodTileCell( viewData->m_lodCenter ) );
+
+    for( int layer : viewData->m_layers )
+    {
+        auto lod = m_lodLayers.find( layer );
+
+        if( lod == m_lodLayers.end() )
+            continue;
+
+        auto tile = lod->second.tiles.find( key );
+
+        if( tile != lod->second.tiles.end() )
+        {
+            tile->second.dirty = true;
+            lod->second.valid = false;
+        }
+    }
+}
+
+
+void VIEW::trackLODItem( VIEW_ITEM* aItem )
+{
+    auto viewData = aItem->viewPrivData();
+
+    // Items are assigned to tiles when a layer gets its tiles (see updateLODTiles())
+    if( m_lodLayers.empty() || !viewData )
+        return;
+
+    viewData->m_lodCenter = aItem->ViewBBox().Centre();
+
+    VECTOR2I cell = lodTileCell( viewData->m_lodCenter );
+    int64_t  key = lodTileKey( cell );
+
+    for( int layer : viewData->m_layers )
+    {
+        auto lod = m_lodLayers.find( layer );
+
+        if( lod == m_lodLayers.end() )
+            continue;
+
+        LOD_TILE& tile = lod->second.tiles[key];
+        tile.cell = cell;
+        tile.dirty = true;
+        lod->second.valid = false;
+    }
+}
+
+
+void VIEW::updateLODTiles()
+{
+    if( m_lodReset )
+        clearLODTiles( true );
+
+    if( m_lodVisibilityChanged )
+        checkLODTiles();
+
+    BOX2I r;
+    r.SetMaximum();
+
+    for( VIEW_LAYER* l : m_orderedLayers )
+    {
+        if( !IsCached( l->id ) )
+            continue;
+
+        // Hidden layers do not need their tiles until they are shown again
+        if( !l->visible || !areRequiredLayersEnabled( l->id ) )
+        {
+            clearLODLayer( l->id );
+            continue;
+        }
+
+        auto lod = m_lodLayers.find( l->id );
+
+        if( lod == m_lodLayers.end() )
+        {
+            lod = m_lodLayers.emplace( l->id, LOD_LAYER() ).first;
+            auto& tiles = lod->second.tiles;
+
+            auto assignTile = [&]( VIEW_ITEM* aItem ) -> bool
+            {
+                auto viewData = aItem->viewPrivData();
+                viewData->m_lodCenter = aItem->ViewBBox().Centre();
+
+                VECTOR2I cell = lodTileCell( viewData->m_lodCenter );
+                tiles[lodTileKey( cell )].cell = cell;
+                return true;
+            };
+
+            l->items->Query( r, assignTile );
+        }
+
+        if( lod->second.valid )
+            continue;
+
+        auto& tiles = lod->second.tiles;
+
+        for( auto it = tiles.begin(); it != tiles.end(); )
+        {
+            LOD_TILE& tile = it->second;
+
+            if( tile.dirty )
+                rebuildLODTile( *l, tile );
+
+            if( tile.group < 0 && tile.looseItems.empty() )
+                it = tiles.erase( it );
+            else
+                ++it;
+        }
+
+        lod->second.valid = true;
+    }
+}
+
+
+void VIEW::dirtyLODLayer( int aLayer )
+{
+    auto lod = m_lodLayers.find( aLayer );
+
+    if( lod == m_lodLayers.end() )
+        return;
+
+    for( auto& tile : lod->second.tiles )
+        tile.second.dirty = true;
+
+    lod->second.valid = false;
+}
+
+
+void VIEW::checkLODTiles()
+{
+    for( auto& lod : m_lodLayers )
+    {
+        for( auto& entry : lod.second.tiles )
+        {
+            LOD_TILE& tile = entry.second;
+
+            // Dirty tiles may refer to removed items, they are rebuilt anyway
+            if( tile.dirty )
+                continue;
+
+            // Items are merged only when their visibility does not depend on the scale
+            auto lodChanged = [&]( const std::vector<VIEW_ITEM*>& aItems, bool aMerged ) -> bool
+            {
+                for( VIEW_ITEM* item : aItems )
+                {
+                    if( ( item->ViewGetLOD( lod.first, this ) == 0 ) != aMerged )
+                        return true;
+                }
+
+                return false;
+            };
+
+            if( lodChanged( tile.mergedItems, true ) || lodChanged( tile.looseItems, false ) )
+            {
+                tile.dirty = true;
+                lod.second.valid = false;
+            }
+        }
+    }
+
+    m_lodVisibilityChanged = false;
+}
+
+
+void VIEW::clearLODLayer( int aLayer )
+{
+    auto lod = m_lodLayers.find( aLayer );
+
+    if( lod == m_lodLayers.end() )
+        return;
+
+    for( const auto& tile : lod->second.tiles )
+    {
+        if( tile.second.group >= 0 )
+            m_gal->DeleteGroup( tile.second.group );
+    }
+
+    m_lodLayers.erase( lod );
+}
+
+
+void VIEW::rebuildLODTile( const VIEW_LAYER& aLayer, LOD_TILE& aTile )
+{
+    // Smallest size in pixels that can still be seen on the screen
+    const double MIN_VISIBLE_SIZE = 1.0;
+
+    if( aTile.group >= 0 )
+    {
+        m_gal->DeleteGroup( aTile.group );
+        aTile.group = -1;
+    }
+
+    aTile.mergedItems.clear();
+    aTile.looseItems.clear();
+    aTile.dirty = false;
+
+    // Tiles are never drawn above the LOD scale, so anything smaller than a pixel at that
+    // scale can be left out of them (the world scale is proportional to the view scale)
+    const double cullingScale = m_gal->GetWorldScale() * m_lodScale / m_scale;
+
+    BOX2I cellBox( VECTOR2I( aTile.cell.x * m_lodTileSize, aTile.cell.y * m_lodTileSize ),
+                   VECTOR2I( m_lodTileSize - 1, m_lodTileSize - 1 ) );
+    auto& merged = aTile.mergedItems;
+
+    // An item belongs to the tile containing its center, even if it spans several tiles
+    auto collect = [&]( VIEW_ITEM* aItem ) -> bool
+    {
+        auto viewData = aItem->viewPrivData();
+
+        if( !viewData->isRenderable() || lodTileCell( viewData->m_lodCenter ) != aTile.cell
+                || viewData->m_viewSize * cullingScale < MIN_VISIBLE_SIZE )
+            return true;
+
+        if( merged.empty() && aTile.looseItems.empty() )
+            aTile.bbox = aItem->ViewBBox();
+        else
+            aTile.bbox.Merge( aItem->ViewBBox() );
+
+        if( aItem->ViewGetLOD( aLayer.id, this ) == 0 )
+            merged.push_back( aItem );
+        else
+            aTile.looseItems.push_back( aItem );
+
+        return true;
+    };
+
+    aLayer.items->Query( cellBox, collect );
+
+    if( merged.empty() )
+        return;
+
+    m_gal->SetTarget( aLayer.target );
+    m_gal->SetLayerDepth( aLayer.renderingOrder );
+
+    // Decimate the details of the merged items as well
+    m_painter->SetCachedCullingScale( cullingScale );
+    aTile.group = m_gal->BeginGroup();
+
+    for( VIEW_ITEM* item : merged )
+    {
+        if( !m_painter->Draw( item, aLayer.id ) )
+            item->ViewDraw( aLayer.id, this ); // Alternative drawing method
+    }
+
+    m_gal->EndGroup();
+    m_painter->SetCachedCullingScale( 0.0 );
+}
+
+
+bool VIEW::drawLODTiles( const VIEW_LAYER& aLayer, const BOX2I& aRect )
+{
+    auto lod = m_lodLayers.find( aLayer.id );
+
+    if( m_lodReset || m_lodVisibilityChanged || lod == m_lodLayers.end()
+            || !lod->second.valid )
+        return false;
+
+    for( const auto& entry : lod->second.tiles )
+    {
+        const LOD_TILE& tile = entry.second;
+
+        if( !tile.bbox.Intersects( aRect ) )
+            continue;
+
+        if( tile.group >= 0 )
+            m_gal->DrawGroup( tile.group );
+
+        for( VIEW_ITEM* item : tile.looseItems )
+        {
+            if( item->ViewGetLOD( aLayer.id, this ) < m_scale )
+                draw( item, aLayer.id );
+        }
+    }
+
+    return true;
+}
+
+
+void VIEW::clearLODTiles( bool aDeleteGroups )
+{
+    if( aDeleteGroups )
+    {
+        for( const auto& lod : m_lodLayers )
+        {
+            for( const auto& tile : lod.second.tiles )
+            {
+                if( tile.second.group >= 0 )
+                    m_gal->DeleteGroup( tile.second.group );
+            }
+        }
+    }
+
+    m_lodLayers.clear();
+    m_lodReset = false;
+    m_lodVisibilityChanged = false;
+}
+
+
 std::unique_ptr<VIEW> VIEW::DataReference() const
 {
     auto ret = std::make_unique<VIEW>();
@@ -1548,6 +2277,32 @@ void VIEW::Update( VIEW_ITEM* aItem, int aUpdateFlags )
 
     viewData->m_requiredUpdate |= aUpdateFlags;
 
+    // Items are refreshed by the VIEW holding them (see UpdateItems())
+    if( viewData->m_view )
+        viewData->m_view->MarkForUpdate( aItem );
+}
+
+
+void VIEW::UpdateInBackground( VIEW_ITEM* aItem, int aUpdateFlags )
+{
+    auto viewData = aItem->viewPrivData();
+
+    if( !viewData || !viewData->m_view )
+        return;
+
+    assert( aUpdateFlags != NONE );
+
+    VIEW* view = viewData->m_view;
+    viewData->m_backgroundUpdate |= aUpdateFlags;
+
+    if( viewData->m_backgroundQueueIndex < 0 )
+    {
+        viewData->m_backgroundQueueIndex = view->m_backgroundItems.size();
+        view->m_backgroundItems.push_back( aItem );
+
+        // Force the queue to be reordered against the current viewport
+        view->m_backgroundViewport = BOX2D();
+    }
 }
 
 
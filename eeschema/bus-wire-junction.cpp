@@ -62,23 +62,11 @@ void SCH_EDIT_FRAME::GetSchematicConnections( std::vector< wxPoint >& aConnectio
 
 bool SCH_EDIT_FRAME::TestDanglingEnds()
 {
-    std::vector<DANGLING_END_ITEM> endPoints;
-    bool hasStateChanged = false;
-
-    for( auto item : GetScreen()->Items() )
-        item->GetEndPoints( endPoints );
-
-    for( auto item : GetScreen()->Items() )
-    {
-        if( item->UpdateDanglingState( endPoints ) )
-        {
-            GetCanvas()->GetView()->Update( item, KIGFX::REPAINT );
-            hasStateChanged = true;
-        }
-        item->GetEndPoints( endPoints );
-    }
-
-    return hasStateChanged;
+    return GetScreen()->TestDanglingEnds( nullptr,
+            [&]( SCH_ITEM* aChangedItem )
+            {
+                GetCanvas()->GetView()->Update( aChangedItem, KIGFX::REPAINT );
+            } );
 }
 
 
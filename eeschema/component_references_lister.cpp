@@ -32,8 +32,11 @@
 
 #include <wx/regex.h>
 #include <algorithm>
-#include <vector>
+#include <set>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <fctsys.h>
 #include <refdes_utils.h>
@@ -144,28 +147,6 @@ bool SCH_REFERENCE_LIST::sortByTimeStamp( const SCH_REFERENCE& item1,
 }
 
 
-int SCH_REFERENCE_LIST::FindUnit( size_t aIndex, int aUnit )
-{
-    int NumRef;
-
-    NumRef = flatList[aIndex].m_NumRef;
-
-    for( size_t ii = 0; ii < flatList.size(); ii++ )
-    {
-        if(  ( aIndex == ii )
-          || ( flatList[ii].m_IsNew )
-          || ( flatList[ii].m_NumRef != NumRef )
-          || ( flatList[aIndex].CompareRef( flatList[ii] ) != 0 ) )
-            continue;
-
-        if( flatList[ii].m_Unit == aUnit )
-            return (int) ii;
-    }
-
-    return -1;
-}
-
-
 int SCH_REFERENCE_LIST::FindRefByPath( const wxString& aPath ) const
 {
     for( size_t i = 0; i < flatList.size(); ++i )
@@ -178,28 +159,6 @@ int SCH_REFERENCE_LIST::FindRefByPath( const wxString& aPath ) const
 }
 
 
-void SCH_REFERENCE_LIST::GetRefsInUse( int aIndex, std::vector< int >& aIdList, int aMinRefId )
-{
-    aIdList.clear();
-
-    for( SCH_REFERENCE& ref : flatList )
-    {
-        if( flatList[aIndex].CompareRef( ref ) == 0 && ref.m_NumRef >= aMinRefId )
-            aIdList.push_back( ref.m_NumRef );
-    }
-
-    sort( aIdList.begin(), aIdList.end() );
-
-    // Ensure each reference number appears only once.  If there are components with
-    // multiple parts per package the same number will be stored for each part.
-    std::vector< int >::iterator it = unique( aIdList.begin(), aIdList.end() );
-
-    // Using the C++ unique algorithm only moves the duplicate entries to the end of
-    // of the array.  This removes the duplicate entries from the array.
-    aIdList.resize( it - aIdList.begin() );
-}
-
-
 int SCH_REFERENCE_LIST::GetLastReference( int aIndex, int aMinValue )
 {
     int lastNumber = aMinValue;
@@ -219,39 +178,72 @@ int SCH_REFERENCE_LIST::GetLastReference( int aIndex, int aMinValue )
 }
 
 
-int SCH_REFERENCE_LIST::CreateFirstFreeRefId( std::vector<int>& aIdList, int aFirstValue )
+/**
+ * The reference numbers of a reference prefix, indexed for SCH_REFERENCE_LIST::Annotate()
+ * so the free numbers and the units of a package can be found without scanning the list.
+ */
+struct REF_PREFIX_NUMBERS
 {
-    int expectedId = aFirstValue;
+    /// Number of references using each reference number
+    std::unordered_map<int, int> m_useCount;
+
+    /// Sorted reference numbers in use.  Like the list of numbers in use built for each
+    /// annotation group, numbers no longer used are only removed at the start of a group.
+    std::set<int> m_inUse;
 
-    // We search for expected Id a value >= aFirstValue.
-    // Skip existing Id < aFirstValue
-    unsigned ii = 0;
+    /// Numbers no longer used since the start of the current group
+    std::vector<int> m_released;
 
-    for( ; ii < aIdList.size(); ii++ )
+    /// Indexes of the references by reference number (may contain stale entries)
+    std::unordered_map<int, std::vector<unsigned>> m_units;
+
+    /// Indexes of the references not yet annotated, by value
+    std::unordered_map<wxString, std::vector<unsigned>> m_candidates;
+
+    /// Next number to try when allocating a number in the current group
+    int m_next = 0;
+
+    void AddNumber( int aNumber )
     {
-        if( expectedId <= aIdList[ii] )
-            break;
+        if( aNumber >= 0 && m_useCount[ aNumber ]++ == 0 )
+            m_inUse.insert( aNumber );
     }
 
-    // Ids are sorted by increasing value, from aFirstValue
-    // So we search from aFirstValue the first not used value, i.e. the first hole in list.
-    for( ; ii < aIdList.size(); ii++ )
+    void RemoveNumber( int aNumber )
     {
-        if( expectedId != aIdList[ii] )    // This id is not yet used.
+        if( aNumber >= 0 && --m_useCount[ aNumber ] == 0 )
+            m_released.push_back( aNumber );
+    }
+
+    /**
+     * Start a new annotation group, whose new reference numbers are >= \a aFirstValue.
+     */
+    void StartGroup( int aFirstValue )
+    {
+        for( int number : m_released )
         {
-            // Insert this free Id, in order to keep list sorted
-            aIdList.insert( aIdList.begin() + ii, expectedId );
-            return expectedId;
+            if( m_useCount[ number ] == 0 )
+                m_inUse.erase( number );
         }
 
-        expectedId++;
+        m_released.clear();
+        m_next = aFirstValue;
     }
 
-    // All existing Id are tested, and all values are found in use.
-    // So Create a new one.
-    aIdList.push_back( expectedId );
-    return expectedId;
-}
+    /**
+     * @return the first free number of the current group, which must then be added with
+     *         AddNumber().
+     */
+    int CreateFirstFreeNumber()
+    {
+        // Numbers are only removed from m_inUse at the start of a group, so the first free
+        // number can only increase until the next group
+        for( auto it = m_inUse.lower_bound( m_next ); it != m_inUse.end() && *it == m_next; ++it )
+            m_next++;
+
+        return m_next++;
+    }
+};
 
 
 // A helper function to build a full reference string of a SCH_REFERENCE item
@@ -278,6 +270,75 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
     int LastReferenceNumber = 0;
     int NumberOfUnits, Unit;
 
+    // Index the reference numbers and the units to annotate of each reference prefix once,
+    // rather than rescanning the list for each component.
+    std::unordered_map<std::string, REF_PREFIX_NUMBERS> prefixes;
+    std::vector<REF_PREFIX_NUMBERS*>                     prefixOf( flatList.size() );
+
+    // The instances of each component, to find the components of aLockedUnitMap
+    std::unordered_map<SCH_COMPONENT*, std::vector<unsigned>>            instances;
+    std::unordered_map<SCH_COMPONENT*, std::vector<SCH_REFERENCE_LIST*>> lockedLists;
+
+    for( unsigned ii = 0; ii < flatList.size(); ii++ )
+    {
+        SCH_REFERENCE&      ref = flatList[ii];
+        REF_PREFIX_NUMBERS& prefix = prefixes[ ref.GetRefStr() ];
+
+        prefixOf[ii] = &prefix;
+        prefix.AddNumber( ref.m_NumRef );
+
+        prefix.m_units[ ref.m_NumRef ].push_back( ii );
+
+        if( ref.m_IsNew )
+            prefix.m_candidates[ ref.m_Value->GetText() ].push_back( ii );
+
+        instances[ ref.GetComp() ].push_back( ii );
+    }
+
+    for( SCH_MULTI_UNIT_REFERENCE_MAP::value_type& pair : aLockedUnitMap )
+    {
+        for( unsigned thisRefI = 0; thisRefI < pair.second.GetCount(); ++thisRefI )
+            lockedLists[ pair.second[thisRefI].GetComp() ].push_back( &pair.second );
+    }
+
+    // Change the reference number of the item at aIndex, keeping the indexes up to date
+    auto setRefNumber =
+            [&]( unsigned aIndex, int aNumber )
+            {
+                REF_PREFIX_NUMBERS* prefix = prefixOf[aIndex];
+
+                prefix->RemoveNumber( flatList[aIndex].m_NumRef );
+                prefix->AddNumber( aNumber );
+                prefix->m_units[ aNumber ].push_back( aIndex );
+
+                flatList[aIndex].m_NumRef = aNumber;
+            };
+
+    // Search for another annotated item with the same reference and the given unit.  Use this
+    // to manage components with multiple parts per package.
+    auto findUnit =
+            [&]( unsigned aIndex, int aUnit ) -> int
+            {
+                const SCH_REFERENCE& ref = flatList[aIndex];
+                auto                 it = prefixOf[aIndex]->m_units.find( ref.m_NumRef );
+
+                if( it == prefixOf[aIndex]->m_units.end() )
+                    return -1;
+
+                for( unsigned ii : it->second )
+                {
+                    if(  ( aIndex == ii )
+                      || ( flatList[ii].m_IsNew )
+                      || ( flatList[ii].m_NumRef != ref.m_NumRef ) )
+                        continue;
+
+                    if( flatList[ii].m_Unit == aUnit )
+                        return (int) ii;
+                }
+
+                return -1;
+            };
+
     /* calculate index of the first component with the same reference prefix
      * than the current component.  All components having the same reference
      * prefix will receive a reference number with consecutive values:
@@ -306,10 +367,9 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
     // inUseRefs keep trace of previously allocated references
     std::unordered_set<wxString> inUseRefs;
 
-    // This is the list of all Id already in use for a given reference prefix.
-    // Will be refilled for each new reference prefix.
-    std::vector<int>idList;
-    GetRefsInUse( first, idList, minRefId );
+    // This is the set of all Ids already in use for the current reference prefix.
+    REF_PREFIX_NUMBERS* idList = prefixOf[first];
+    idList->StartGroup( minRefId );
 
     for( unsigned ii = 0; ii < flatList.size(); ii++ )
     {
@@ -320,21 +380,26 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
 
         // Check whether this component is in aLockedUnitMap.
         SCH_REFERENCE_LIST* lockedList = NULL;
-        for( SCH_MULTI_UNIT_REFERENCE_MAP::value_type& pair : aLockedUnitMap )
-        {
-            unsigned n_refs = pair.second.GetCount();
+        auto                locked = lockedLists.find( ref_unit.GetComp() );
 
-            for( unsigned thisRefI = 0; thisRefI < n_refs; ++thisRefI )
+        if( locked != lockedLists.end() )
+        {
+            for( SCH_REFERENCE_LIST* list : locked->second )
             {
-                SCH_REFERENCE &thisRef = pair.second[thisRefI];
+                unsigned n_refs = list->GetCount();
 
-                if( thisRef.IsSameInstance( ref_unit ) )
+                for( unsigned thisRefI = 0; thisRefI < n_refs; ++thisRefI )
                 {
-                    lockedList = &pair.second;
-                    break;
+                    SCH_REFERENCE &thisRef = (*list)[thisRefI];
+
+                    if( thisRef.IsSameInstance( ref_unit ) )
+                    {
+                        lockedList = list;
+                        break;
+                    }
                 }
+                if( lockedList != NULL ) break;
             }
-            if( lockedList != NULL ) break;
         }
 
         if(  ( flatList[first].CompareRef( ref_unit ) != 0 )
@@ -349,7 +414,8 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
             else
                 minRefId = aStartNumber + 1;
 
-            GetRefsInUse( first, idList, minRefId );
+            idList = prefixOf[first];
+            idList->StartGroup( minRefId );
         }
 
         // Annotation of one part per package components (trivial case).
@@ -357,8 +423,8 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
         {
             if( ref_unit.m_IsNew )
             {
-                LastReferenceNumber = CreateFirstFreeRefId( idList, minRefId );
-                ref_unit.m_NumRef = LastReferenceNumber;
+                LastReferenceNumber = idList->CreateFirstFreeNumber();
+                setRefNumber( ii, LastReferenceNumber );
             }
 
             ref_unit.m_Unit  = 1;
@@ -372,8 +438,8 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
 
         if( ref_unit.m_IsNew )
         {
-            LastReferenceNumber = CreateFirstFreeRefId( idList, minRefId );
-            ref_unit.m_NumRef = LastReferenceNumber;
+            LastReferenceNumber = idList->CreateFirstFreeNumber();
+            setRefNumber( ii, LastReferenceNumber );
 
             if( !ref_unit.IsUnitsLocked() )
                 ref_unit.m_Unit = 1;
@@ -406,9 +472,14 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
                     continue;
 
                 // Find the matching component
-                for( unsigned jj = ii + 1; jj < flatList.size(); jj++ )
+                auto instance = instances.find( thisRef.GetComp() );
+
+                if( instance == instances.end() )
+                    continue;
+
+                for( unsigned jj : instance->second )
                 {
-                    if( ! thisRef.IsSameInstance( flatList[jj] ) )
+                    if( jj <= ii || ! thisRef.IsSameInstance( flatList[jj] ) )
                         continue;
 
                     wxString ref_candidate = buildFullReference( ref_unit, thisRef.m_Unit );
@@ -418,7 +489,7 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
                     // multiunits components have duplicate references)
                     if( inUseRefs.find( ref_candidate ) == inUseRefs.end() )
                     {
-                        flatList[jj].m_NumRef = ref_unit.m_NumRef;
+                        setRefNumber( jj, ref_unit.m_NumRef );
                         flatList[jj].m_Unit = thisRef.m_Unit;
                         flatList[jj].m_IsNew = false;
                         flatList[jj].m_Flag = 1;
@@ -435,30 +506,34 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
             * we search for others parts that have the same value and the same
             * reference prefix (ref without ref number)
             */
+            auto candidates = prefixOf[ii]->m_candidates.find( ref_unit.m_Value->GetText() );
+
             for( Unit = 1; Unit <= NumberOfUnits; Unit++ )
             {
                 if( ref_unit.m_Unit == Unit )
                     continue;
 
-                int found = FindUnit( ii, Unit );
+                int found = findUnit( ii, Unit );
 
                 if( found >= 0 )
                     continue; // this unit exists for this reference (unit already annotated)
 
+                if( candidates == prefixOf[ii]->m_candidates.end() )
+                    continue;
+
                 // Search a component to annotate ( same prefix, same value, not annotated)
-                for( unsigned jj = ii + 1; jj < flatList.size(); jj++ )
+                // after this one.  Candidates are stored by increasing index.
+                const std::vector<unsigned>& cmp_units = candidates->second;
+
+                for( auto it = std::upper_bound( cmp_units.begin(), cmp_units.end(), ii );
+                     it != cmp_units.end(); ++it )
                 {
-                    auto& cmp_unit = flatList[jj];
+                    unsigned jj = *it;
+                    auto&    cmp_unit = flatList[jj];
 
                     if( cmp_unit.m_Flag )    // already tested
                         continue;
 
-                    if( cmp_unit.CompareRef( ref_unit ) != 0 )
-                        continue;
-
-                    if( cmp_unit.CompareValue( ref_unit ) != 0 )
-                        continue;
-
                     if( cmp_unit.CompareLibName( ref_unit ) != 0 )
                         continue;
 
@@ -473,7 +548,7 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
                     if( !cmp_unit.IsUnitsLocked()
                         || ( cmp_unit.m_Unit == Unit ) )
                     {
-                        cmp_unit.m_NumRef = ref_unit.m_NumRef;
+                        setRefNumber( jj, ref_unit.m_NumRef );
                         cmp_unit.m_Unit   = Unit;
                         cmp_unit.m_Flag   = 1;
                         cmp_unit.m_IsNew  = false;
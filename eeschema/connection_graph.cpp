@@ -18,12 +18,15 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
 #include <list>
 #include <thread>
 #include <algorithm>
+#include <functional>
 #include <future>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <profile.h>
 
 #include <common.h>
@@ -360,6 +363,9 @@ void CONNECTION_GRAPH::Reset()
     m_net_name_to_subgraphs_map.clear();
     m_local_label_cache.clear();
     m_global_label_cache.clear();
+    m_sheet_to_items_map.clear();
+    m_subgraph_code_map.clear();
+    m_link_key_to_subgraphs_map.clear();
     m_last_net_code = 1;
     m_last_bus_code = 1;
     m_last_subgraph_code = 1;
@@ -371,23 +377,147 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
     PROF_COUNTER recalc_time;
     PROF_COUNTER update_items;
 
-    if( aUnconditional )
+    bool incremental = !aUnconditional && !m_subgraphs.empty();
+
+    // Bus aliases are used when the drivers are resolved, so any subgraph may depend on them
+    if( recacheBusAliases() )
+        incremental = false;
+
+    if( !incremental )
+    {
         Reset();
+        recacheBusAliases();
+    }
 
-    for( const SCH_SHEET_PATH& sheet : aSheetList )
+    std::vector<std::vector<SCH_ITEM*>> sheet_items( aSheetList.size() );
+    std::vector<std::vector<SCH_ITEM*>> changed_items( aSheetList.size() );
+    std::unordered_set<SCH_ITEM*>       removed_items;
+    std::unordered_set<SCH_SCREEN*>     dirty_screens;
+
+    // All the sheets are checked before any is updated, because the connectivity dirty flags
+    // of the items of a screen are cleared by the update of its first sheet
+    for( size_t i = 0; i < aSheetList.size(); i++ )
     {
-        std::vector<SCH_ITEM*> items;
+        const SCH_SHEET_PATH& sheet = aSheetList[i];
 
         for( auto item : sheet.LastScreen()->Items() )
         {
-            if( item->IsConnectable() && ( aUnconditional || item->IsConnectivityDirty() ) )
-                items.push_back( item );
+            if( item->IsConnectable() )
+                sheet_items[i].push_back( item );
+        }
+
+        if( findChangedItems( sheet, sheet_items[i], changed_items[i], removed_items ) )
+            dirty_screens.insert( sheet.LastScreen() );
+    }
+
+    // The items of the sheets that are no longer in the hierarchy are gone too, unless their
+    // screen is still used by another sheet
+    std::unordered_set<SCH_SHEET_PATH> sheets( aSheetList.begin(), aSheetList.end() );
+
+    for( auto it = m_sheet_to_items_map.begin(); it != m_sheet_to_items_map.end(); )
+    {
+        if( sheets.count( it->first ) )
+        {
+            ++it;
+            continue;
         }
 
-        updateItemConnectivity( sheet, items );
+        removed_items.insert( it->second.begin(), it->second.end() );
+        it = m_sheet_to_items_map.erase( it );
+    }
+
+    for( const std::vector<SCH_ITEM*>& items : sheet_items )
+    {
+        for( SCH_ITEM* item : items )
+            removed_items.erase( item );
+    }
+
+    // Sheets are independent at this stage, except for the instances of a same screen that
+    // share their items, so each screen is handled by a single thread
+    std::vector<std::vector<size_t>>        screen_sheets;
+    std::unordered_map<SCH_SCREEN*, size_t> screen_index;
+
+    for( size_t i = 0; i < aSheetList.size(); i++ )
+    {
+        if( !dirty_screens.count( aSheetList[i].LastScreen() ) )
+            continue;
+
+        auto it = screen_index.emplace( aSheetList[i].LastScreen(), screen_sheets.size() );
+
+        if( it.second )
+            screen_sheets.emplace_back();
+
+        screen_sheets[ it.first->second ].push_back( i );
+    }
+
+    std::atomic<size_t> nextScreen( 0 );
+    std::atomic<size_t> updated_sheets( 0 );
+
+    auto update_lambda = [&]() -> size_t
+    {
+        for( size_t screenId = nextScreen++; screenId < screen_sheets.size();
+             screenId = nextScreen++ )
+        {
+            for( size_t i : screen_sheets[screenId] )
+            {
+                const SCH_SHEET_PATH& sheet = aSheetList[i];
+
+                updateItemConnectivity( sheet, sheet_items[i], !incremental );
+
+                // UpdateDanglingState() also adds connected items for SCH_TEXT
+                sheet.LastScreen()->TestDanglingEnds( &sheet );
+
+                updated_sheets++;
+            }
+        }
+
+        return 1;
+    };
+
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                   screen_sheets.size() );
+
+    if( parallelThreadCount <= 1 )
+    {
+        update_lambda();
+    }
+    else
+    {
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, update_lambda );
+
+        // Finalize the threads
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
 
-        // UpdateDanglingState() also adds connected items for SCH_TEXT
-        sheet.LastScreen()->TestDanglingEnds( &sheet );
+        // Keep the sheet order for the invisible power pins, their subgraph codes depend on it
+        std::unordered_map<SCH_SHEET_PATH, size_t> sheet_index;
+
+        for( size_t i = 0; i < aSheetList.size(); i++ )
+            sheet_index.emplace( aSheetList[i], i );
+
+        std::stable_sort( m_invisible_power_pins.begin(), m_invisible_power_pins.end(),
+                          [&]( const std::pair<SCH_SHEET_PATH, SCH_PIN*>& a,
+                               const std::pair<SCH_SHEET_PATH, SCH_PIN*>& b )
+                          {
+                              return sheet_index[a.first] < sheet_index[b.first];
+                          } );
+    }
+
+    wxLogTrace( "CONN_PROFILE", "Item connectivity updated on %lu of %lu sheets",
+                (unsigned long) updated_sheets, (unsigned long) aSheetList.size() );
+
+    // Only the items of the subgraphs to rebuild go through buildConnectionGraph()
+    std::vector<CONNECTION_SUBGRAPH*> kept_subgraphs;
+
+    if( incremental )
+    {
+        m_items.clear();
+        m_invisible_power_pins.clear();
+
+        kept_subgraphs = invalidateSubgraphs( aSheetList, changed_items, removed_items );
     }
 
     update_items.Stop();
@@ -396,6 +526,7 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
     PROF_COUNTER build_graph;
 
     buildConnectionGraph();
+    restoreSubgraphs( kept_subgraphs );
 
     build_graph.Stop();
     wxLogTrace( "CONN_PROFILE", "BuildConnectionGraph() %0.4f ms", build_graph.msecs() );
@@ -416,10 +547,382 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
 }
 
 
+bool CONNECTION_GRAPH::recacheBusAliases()
+{
+    std::unordered_map< wxString, std::shared_ptr<BUS_ALIAS> > aliases;
+    SCH_SHEET_LIST all_sheets( g_RootSheet );
+
+    for( unsigned i = 0; i < all_sheets.size(); i++ )
+    {
+        for( const auto& alias : all_sheets[i].LastScreen()->GetBusAliases() )
+            aliases[ alias->GetName() ] = alias;
+    }
+
+    // The bus manager replaces the aliases it edits, so comparing pointers is enough
+    if( aliases == m_bus_alias_cache )
+        return false;
+
+    m_bus_alias_cache = std::move( aliases );
+    return true;
+}
+
+
+bool CONNECTION_GRAPH::findChangedItems( const SCH_SHEET_PATH& aSheet,
+                                         const std::vector<SCH_ITEM*>& aItemList,
+                                         std::vector<SCH_ITEM*>& aChangedItems,
+                                         std::unordered_set<SCH_ITEM*>& aRemovedItems )
+{
+    auto                   it = m_sheet_to_items_map.find( aSheet );
+    bool                   new_sheet = ( it == m_sheet_to_items_map.end() );
+    std::vector<SCH_ITEM*> items;
+
+    auto check_item = [&]( SCH_ITEM* aItem, bool aParentChanged )
+    {
+        items.push_back( aItem );
+
+        if( new_sheet || aParentChanged || aItem->IsConnectivityDirty()
+                || !aItem->Connection( aSheet ) )
+        {
+            aChangedItems.push_back( aItem );
+        }
+    };
+
+    for( SCH_ITEM* item : aItemList )
+    {
+        // Pins are rebuilt when their symbol is updated, without their parent being changed
+        if( item->Type() == SCH_SHEET_T )
+        {
+            bool changed = new_sheet || item->IsConnectivityDirty();
+
+            // The sheet itself is reported too: it may have been renamed, which changes the
+            // names of all the nets of its subsheets
+            items.push_back( item );
+
+            if( changed )
+                aChangedItems.push_back( item );
+
+            for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( item )->GetPins() )
+                check_item( pin, changed );
+        }
+        else if( item->Type() == SCH_COMPONENT_T )
+        {
+            SCH_COMPONENT* component = static_cast<SCH_COMPONENT*>( item );
+
+            items.push_back( item );
+
+            for( SCH_PIN* pin : component->GetSchPins( &aSheet ) )
+                check_item( pin, component->IsConnectivityDirty() );
+        }
+        else
+        {
+            check_item( item, false );
+        }
+    }
+
+    if( new_sheet )
+    {
+        m_sheet_to_items_map[ aSheet ] = std::move( items );
+        return true;
+    }
+
+    bool dirty = !aChangedItems.empty();
+
+    if( it->second != items )
+    {
+        std::unordered_set<SCH_ITEM*> current( items.begin(), items.end() );
+
+        for( SCH_ITEM* item : it->second )
+        {
+            if( !current.count( item ) )
+                aRemovedItems.insert( item );
+        }
+
+        it->second = std::move( items );
+        dirty = true;
+    }
+
+    return dirty;
+}
+
+
+std::vector<CONNECTION_SUBGRAPH*> CONNECTION_GRAPH::invalidateSubgraphs(
+        const SCH_SHEET_LIST& aSheetList,
+        const std::vector<std::vector<SCH_ITEM*>>& aChangedItems,
+        const std::unordered_set<SCH_ITEM*>& aRemovedItems )
+{
+    std::unordered_set<SCH_SHEET_PATH>             sheets( aSheetList.begin(), aSheetList.end() );
+    std::unordered_set<SCH_ITEM*>                  changed_items;
+    std::unordered_set<SCH_SHEET*>                 changed_sheets;
+    std::unordered_set<const CONNECTION_SUBGRAPH*> invalid;
+    std::vector<CONNECTION_SUBGRAPH*>              search_list;
+    std::unordered_set<wxString>                   keys;
+    std::vector<wxString>                          changed_keys;
+
+    auto invalidate = [&]( CONNECTION_SUBGRAPH* aSubgraph )
+    {
+        if( invalid.insert( aSubgraph ).second )
+            search_list.push_back( aSubgraph );
+    };
+
+    auto invalidate_item = [&]( SCH_ITEM* aItem, const SCH_SHEET_PATH& aSheet )
+    {
+        SCH_CONNECTION* connection = aItem->Connection( aSheet );
+
+        if( !connection )
+            return;
+
+        auto it = m_subgraph_code_map.find( connection->SubgraphCode() );
+
+        if( it != m_subgraph_code_map.end() )
+            invalidate( it->second );
+    };
+
+    auto invalidate_keys = [&]( const std::vector<wxString>& aKeys )
+    {
+        for( const wxString& key : aKeys )
+        {
+            if( !keys.insert( key ).second )
+                continue;
+
+            auto it = m_link_key_to_subgraphs_map.find( key );
+
+            if( it == m_link_key_to_subgraphs_map.end() )
+                continue;
+
+            for( CONNECTION_SUBGRAPH* subgraph : it->second )
+                invalidate( subgraph );
+        }
+    };
+
+    // The subgraphs holding a changed item before and after the change
+    for( size_t i = 0; i < aSheetList.size(); i++ )
+    {
+        for( SCH_ITEM* item : aChangedItems[i] )
+        {
+            changed_items.insert( item );
+
+            if( item->Type() == SCH_SHEET_T )
+            {
+                changed_sheets.insert( static_cast<SCH_SHEET*>( item ) );
+                continue;
+            }
+
+            invalidate_item( item, aSheetList[i] );
+
+            for( SCH_ITEM* neighbor : item->ConnectedItems( aSheetList[i] ) )
+                invalidate_item( neighbor, aSheetList[i] );
+
+            getLinkKeys( aSheetList[i], item, changed_keys );
+        }
+    }
+
+    // Item pointers are compared here, not dereferenced, as the removed items may be deleted
+    for( CONNECTION_SUBGRAPH* subgraph : m_subgraphs )
+    {
+        bool stale = !sheets.count( subgraph->m_sheet );
+
+        for( size_t i = 0; i < subgraph->m_sheet.size() && !stale; i++ )
+            stale = changed_sheets.count( subgraph->m_sheet.GetSheet( i ) ) > 0;
+
+        for( size_t i = 0; i < subgraph->m_items.size() && !stale; i++ )
+        {
+            stale = changed_items.count( subgraph->m_items[i] ) > 0
+                    || aRemovedItems.count( subgraph->m_items[i] ) > 0;
+        }
+
+        if( stale )
+            invalidate( subgraph );
+    }
+
+    // Now follow all the links a rebuilt subgraph may have to others: these ones will not be
+    // merged, named or propagated to correctly unless they are rebuilt too
+    invalidate_keys( changed_keys );
+
+    for( size_t i = 0; i < search_list.size(); i++ )
+    {
+        CONNECTION_SUBGRAPH* subgraph = search_list[i];
+
+        invalidate_keys( subgraph->m_link_keys );
+
+        if( !sheets.count( subgraph->m_sheet ) )
+            continue;
+
+        for( SCH_ITEM* item : subgraph->m_items )
+        {
+            if( aRemovedItems.count( item ) )
+                continue;
+
+            for( SCH_ITEM* neighbor : item->ConnectedItems( subgraph->m_sheet ) )
+                invalidate_item( neighbor, subgraph->m_sheet );
+        }
+    }
+
+    wxLogTrace( "CONN_PROFILE", "Rebuilding %lu of %lu subgraphs",
+                (unsigned long) invalid.size(), (unsigned long) m_subgraphs.size() );
+
+    for( CONNECTION_SUBGRAPH* subgraph : search_list )
+    {
+        if( !sheets.count( subgraph->m_sheet ) )
+            continue;
+
+        for( SCH_ITEM* item : subgraph->m_items )
+        {
+            if( !aRemovedItems.count( item ) )
+                resetItemConnection( subgraph->m_sheet, item );
+        }
+    }
+
+    for( size_t i = 0; i < aSheetList.size(); i++ )
+    {
+        for( SCH_ITEM* item : aChangedItems[i] )
+        {
+            if( item->Type() != SCH_SHEET_T )
+                resetItemConnection( aSheetList[i], item );
+        }
+    }
+
+    auto is_invalid = [&]( const CONNECTION_SUBGRAPH* aSubgraph )
+    {
+        return invalid.count( aSubgraph ) > 0;
+    };
+
+    auto remove_invalid = [&]( auto& aCache )
+    {
+        for( auto it = aCache.begin(); it != aCache.end(); )
+        {
+            auto& vec = it->second;
+            vec.erase( std::remove_if( vec.begin(), vec.end(), is_invalid ), vec.end() );
+
+            if( vec.empty() )
+                it = aCache.erase( it );
+            else
+                ++it;
+        }
+    };
+
+    remove_invalid( m_net_name_to_subgraphs_map );
+    remove_invalid( m_local_label_cache );
+    remove_invalid( m_global_label_cache );
+    remove_invalid( m_link_key_to_subgraphs_map );
+
+    for( auto it = m_subgraph_code_map.begin(); it != m_subgraph_code_map.end(); )
+    {
+        if( is_invalid( it->second ) )
+            it = m_subgraph_code_map.erase( it );
+        else
+            ++it;
+    }
+
+    std::vector<CONNECTION_SUBGRAPH*> kept_subgraphs;
+
+    for( CONNECTION_SUBGRAPH* subgraph : m_subgraphs )
+    {
+        if( is_invalid( subgraph ) )
+            delete subgraph;
+        else
+            kept_subgraphs.push_back( subgraph );
+    }
+
+    m_subgraphs.clear();
+    m_driver_subgraphs.clear();
+    m_sheet_to_subgraphs_map.clear();
+    m_net_code_to_subgraphs_map.clear();
+
+    return kept_subgraphs;
+}
+
+
+void CONNECTION_GRAPH::restoreSubgraphs( const std::vector<CONNECTION_SUBGRAPH*>& aSubgraphs )
+{
+    for( CONNECTION_SUBGRAPH* subgraph : aSubgraphs )
+    {
+        m_subgraphs.push_back( subgraph );
+
+        if( !subgraph->m_driver )
+            continue;
+
+        m_driver_subgraphs.push_back( subgraph );
+        m_sheet_to_subgraphs_map[ subgraph->m_sheet ].emplace_back( subgraph );
+
+        if( subgraph->m_driver_connection->IsBus() )
+            continue;
+
+        auto key = std::make_pair( subgraph->GetNetName(),
+                                   subgraph->m_driver_connection->NetCode() );
+        m_net_code_to_subgraphs_map[ key ].push_back( subgraph );
+    }
+}
+
+
+void CONNECTION_GRAPH::addGraphItems(
+        const std::vector<SCH_ITEM*>& aItems,
+        const std::vector<std::pair<SCH_SHEET_PATH, SCH_PIN*>>& aInvisiblePowerPins )
+{
+    // Several sheets are updated at the same time (see Recalculate())
+    std::lock_guard<std::mutex> lock( m_item_mutex );
+
+    m_items.insert( aItems.begin(), aItems.end() );
+    m_invisible_power_pins.insert( m_invisible_power_pins.end(), aInvisiblePowerPins.begin(),
+                                   aInvisiblePowerPins.end() );
+}
+
+
+SCH_CONNECTION* CONNECTION_GRAPH::initializeConnection( const SCH_SHEET_PATH& aSheet,
+                                                        SCH_ITEM* aItem )
+{
+    SCH_CONNECTION* conn = aItem->InitializeConnection( aSheet );
+
+    // Set bus/net property here so that the propagation code uses it
+    switch( aItem->Type() )
+    {
+    case SCH_LINE_T:
+        conn->SetType( aItem->GetLayer() == LAYER_BUS ? CONNECTION_TYPE::BUS :
+                                                        CONNECTION_TYPE::NET );
+        break;
+
+    case SCH_BUS_BUS_ENTRY_T:
+        conn->SetType( CONNECTION_TYPE::BUS );
+        break;
+
+    case SCH_PIN_T:
+    case SCH_BUS_WIRE_ENTRY_T:
+        conn->SetType( CONNECTION_TYPE::NET );
+        break;
+
+    default:
+        break;
+    }
+
+    return conn;
+}
+
+
+void CONNECTION_GRAPH::resetItemConnection( const SCH_SHEET_PATH& aSheet, SCH_ITEM* aItem )
+{
+    m_items.insert( aItem );
+
+    if( aItem->Type() != SCH_PIN_T )
+    {
+        initializeConnection( aSheet, aItem );
+        return;
+    }
+
+    SCH_PIN* pin = static_cast<SCH_PIN*>( aItem );
+
+    pin->InitializeConnection( aSheet );
+
+    if( pin->IsPowerConnection() && !pin->IsVisible() )
+        m_invisible_power_pins.emplace_back( std::make_pair( aSheet, pin ) );
+}
+
+
 void CONNECTION_GRAPH::updateItemConnectivity( SCH_SHEET_PATH aSheet,
-                                               const std::vector<SCH_ITEM*>& aItemList )
+                                               const std::vector<SCH_ITEM*>& aItemList,
+                                               bool aResetConnections )
 {
     std::unordered_map< wxPoint, std::vector<SCH_ITEM*> > connection_map;
+    std::vector<SCH_ITEM*>                                 graph_items;
+    std::vector<std::pair<SCH_SHEET_PATH, SCH_PIN*>>       invisible_power_pins;
 
     for( SCH_ITEM* item : aItemList )
     {
@@ -431,14 +934,13 @@ void CONNECTION_GRAPH::updateItemConnectivity( SCH_SHEET_PATH aSheet,
         {
             for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( item )->GetPins() )
             {
-                if( !pin->Connection( aSheet ) )
+                if( aResetConnections || !pin->Connection( aSheet ) )
                     pin->InitializeConnection( aSheet );
 
                 pin->ConnectedItems( aSheet ).clear();
-                pin->Connection( aSheet )->Reset();
 
                 connection_map[ pin->GetTextPos() ].push_back( pin );
-                m_items.insert( pin );
+                graph_items.push_back( pin );
             }
         }
         else if( item->Type() == SCH_COMPONENT_T )
@@ -454,55 +956,41 @@ void CONNECTION_GRAPH::updateItemConnectivity( SCH_SHEET_PATH aSheet,
 
             for( SCH_PIN* pin : component->GetSchPins( &aSheet ) )
             {
-                pin->InitializeConnection( aSheet );
+                if( aResetConnections || !pin->Connection( aSheet ) )
+                    pin->InitializeConnection( aSheet );
 
                 wxPoint pos = pin->GetPosition();
 
-                // because calling the first time is not thread-safe
+                // Cache the default net name now: the first call may set the reference of the
+                // component, which is only safe from the thread handling its screen
                 pin->GetDefaultNetName( aSheet );
                 pin->ConnectedItems( aSheet ).clear();
 
                 // Invisible power pins need to be post-processed later
 
                 if( pin->IsPowerConnection() && !pin->IsVisible() )
-                    m_invisible_power_pins.emplace_back( std::make_pair( aSheet, pin ) );
+                    invisible_power_pins.emplace_back( std::make_pair( aSheet, pin ) );
 
                 connection_map[ pos ].push_back( pin );
-                m_items.insert( pin );
+                graph_items.push_back( pin );
             }
         }
         else
         {
-            m_items.insert( item );
-            auto conn = item->InitializeConnection( aSheet );
+            graph_items.push_back( item );
 
-            // Set bus/net property here so that the propagation code uses it
-            switch( item->Type() )
-            {
-            case SCH_LINE_T:
-                conn->SetType( item->GetLayer() == LAYER_BUS ? CONNECTION_TYPE::BUS :
-                                                               CONNECTION_TYPE::NET );
-                break;
+            if( aResetConnections || !item->Connection( aSheet ) )
+                initializeConnection( aSheet, item );
 
-            case SCH_BUS_BUS_ENTRY_T:
-                conn->SetType( CONNECTION_TYPE::BUS );
-                // clean previous (old) links:
+            // clean previous (old) links:
+            if( item->Type() == SCH_BUS_BUS_ENTRY_T )
+            {
                 static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[0] = nullptr;
                 static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[1] = nullptr;
-                break;
-
-            case SCH_PIN_T:
-                conn->SetType( CONNECTION_TYPE::NET );
-                break;
-
-            case SCH_BUS_WIRE_ENTRY_T:
-                conn->SetType( CONNECTION_TYPE::NET );
-                // clean previous (old) link:
+            }
+            else if( item->Type() == SCH_BUS_WIRE_ENTRY_T )
+            {
                 static_cast<SCH_BUS_WIRE_ENTRY*>( item )->m_connected_bus_item = nullptr;
-                break;
-
-            default:
-                break;
             }
 
             for( const wxPoint& point : points )
@@ -512,6 +1000,8 @@ void CONNECTION_GRAPH::updateItemConnectivity( SCH_SHEET_PATH aSheet,
         item->SetConnectivityDirty( false );
     }
 
+    addGraphItems( graph_items, invisible_power_pins );
+
     for( const auto& it : connection_map )
     {
         auto connection_vec = it.second;
@@ -635,16 +1125,6 @@ void CONNECTION_GRAPH::updateItemConnectivity( SCH_SHEET_PATH aSheet,
 
 void CONNECTION_GRAPH::buildConnectionGraph()
 {
-    // Recache all bus aliases for later use
-
-    SCH_SHEET_LIST all_sheets( g_RootSheet );
-
-    for( unsigned i = 0; i < all_sheets.size(); i++ )
-    {
-        for( const auto& alias : all_sheets[i].LastScreen()->GetBusAliases() )
-            m_bus_alias_cache[ alias->GetName() ] = alias;
-    }
-
     // Build subgraphs from items (on a per-sheet basis)
 
     for( SCH_ITEM* item : m_items )
@@ -811,7 +1291,7 @@ void CONNECTION_GRAPH::buildConnectionGraph()
                 case SCH_PIN_T:
                 {
                     auto pin = static_cast<SCH_PIN*>( driver );
-                    // NOTE(JE) GetDefaultNetName is not thread-safe.
+                    // The default net name was cached by updateItemConnectivity()
                     connection->ConfigureFromLabel( pin->GetDefaultNetName( sheet ) );
 
                     break;
@@ -1422,6 +1902,38 @@ void CONNECTION_GRAPH::buildConnectionGraph()
         m_net_code_to_subgraphs_map[ key ].push_back( subgraph );
     }
 
+    // Point the caches to the subgraphs that absorbed the ones deleted below, so that they
+    // never hold a deleted subgraph for the next incremental update
+    auto follow_absorbed = [&]( auto& aCache )
+    {
+        for( auto& it : aCache )
+        {
+            for( auto& subgraph : it.second )
+            {
+                while( subgraph->m_absorbed )
+                    subgraph = subgraph->m_absorbed_by;
+            }
+        }
+    };
+
+    follow_absorbed( m_net_name_to_subgraphs_map );
+    follow_absorbed( m_local_label_cache );
+    follow_absorbed( m_global_label_cache );
+
+    for( CONNECTION_SUBGRAPH* subgraph : m_subgraphs )
+    {
+        CONNECTION_SUBGRAPH* owner = subgraph;
+
+        while( owner->m_absorbed )
+            owner = owner->m_absorbed_by;
+
+        // The items of an absorbed subgraph may still have its code on other sheets
+        m_subgraph_code_map[ subgraph->m_code ] = owner;
+
+        if( !subgraph->m_absorbed )
+            cacheLinkKeys( subgraph );
+    }
+
     // Clean up and deallocate stale subgraphs
     m_subgraphs.erase( std::remove_if( m_subgraphs.begin(), m_subgraphs.end(),
             [&]( const CONNECTION_SUBGRAPH* sg )
@@ -1859,6 +2371,93 @@ void CONNECTION_GRAPH::recacheSubgraphName(
 }
 
 
+/**
+ * Adds the names of a connection and of its bus members, qualified as link keys.
+ */
+static void addConnectionLinkKeys( const SCH_SHEET_PATH& aSheet, const SCH_CONNECTION& aConnection,
+                                   std::vector<wxString>& aKeys )
+{
+    aKeys.push_back( "N:" + aConnection.Name() );
+    aKeys.push_back( "L:" + aSheet.PathAsString() + aConnection.Name( true ) );
+
+    for( const auto& member : aConnection.Members() )
+        addConnectionLinkKeys( aSheet, *member, aKeys );
+}
+
+
+void CONNECTION_GRAPH::getLinkKeys( const SCH_SHEET_PATH& aSheet, SCH_ITEM* aItem,
+                                    std::vector<wxString>& aKeys )
+{
+    wxString name;
+
+    switch( aItem->Type() )
+    {
+    case SCH_PIN_T:
+    {
+        auto pin = static_cast<SCH_PIN*>( aItem );
+
+        // Weak drivers matter too: their subgraphs get a suffix when the names conflict
+        if( pin->IsPowerConnection() )
+            name = pin->GetName();
+        else
+            name = pin->GetDefaultNetName( aSheet );
+
+        break;
+    }
+
+    case SCH_SHEET_PIN_T:
+    {
+        auto           pin = static_cast<SCH_SHEET_PIN*>( aItem );
+        SCH_SHEET_PATH path = aSheet;
+
+        path.push_back( pin->GetParent() );
+        name = pin->GetShownText();
+        aKeys.push_back( "H:" + path.PathAsString() + name );
+        break;
+    }
+
+    case SCH_HIER_LABEL_T:
+        name = static_cast<SCH_TEXT*>( aItem )->GetShownText();
+        aKeys.push_back( "H:" + aSheet.PathAsString() + name );
+        break;
+
+    case SCH_LABEL_T:
+    case SCH_GLOBAL_LABEL_T:
+        name = static_cast<SCH_TEXT*>( aItem )->GetShownText();
+        break;
+
+    default:
+        return;
+    }
+
+    SCH_CONNECTION connection( aItem, aSheet );
+    connection.ConfigureFromLabel( name );
+
+    addConnectionLinkKeys( aSheet, connection, aKeys );
+}
+
+
+void CONNECTION_GRAPH::cacheLinkKeys( CONNECTION_SUBGRAPH* aSubgraph )
+{
+    std::vector<wxString>& keys = aSubgraph->m_link_keys;
+
+    keys.clear();
+
+    for( SCH_ITEM* item : aSubgraph->m_items )
+        getLinkKeys( aSubgraph->m_sheet, item, keys );
+
+    // The final names link the subgraphs renamed by the propagation
+    if( aSubgraph->m_driver_connection )
+        addConnectionLinkKeys( aSubgraph->m_sheet, *aSubgraph->m_driver_connection, keys );
+
+    std::sort( keys.begin(), keys.end() );
+    keys.erase( std::unique( keys.begin(), keys.end() ), keys.end() );
+
+    for( const wxString& key : keys )
+        m_link_key_to_subgraphs_map[ key ].push_back( aSubgraph );
+}
+
+
 std::shared_ptr<BUS_ALIAS> CONNECTION_GRAPH::GetBusAlias( const wxString& aName )
 {
     if( m_bus_alias_cache.count( aName ) )
@@ -1868,6 +2467,20 @@ std::shared_ptr<BUS_ALIAS> CONNECTION_GRAPH::GetBusAlias( const wxString& aName
 }
 
 
+CONNECTION_SUBGRAPH* CONNECTION_GRAPH::GetSubgraphForItem( SCH_ITEM* aItem,
+                                                          const SCH_SHEET_PATH& aSheet ) const
+{
+    SCH_CONNECTION* connection = aItem->Connection( aSheet );
+
+    if( !connection )
+        return nullptr;
+
+    auto it = m_subgraph_code_map.find( connection->SubgraphCode() );
+
+    return it != m_subgraph_code_map.end() ? it->second : nullptr;
+}
+
+
 std::vector<const CONNECTION_SUBGRAPH*> CONNECTION_GRAPH::GetBusesNeedingMigration()
 {
     std::vector<const CONNECTION_SUBGRAPH*> ret;
@@ -1918,59 +2531,119 @@ std::vector<const CONNECTION_SUBGRAPH*> CONNECTION_GRAPH::GetBusesNeedingMigrati
 
 int CONNECTION_GRAPH::RunERC()
 {
-    int error_count = 0;
-
-    for( auto&& subgraph : m_subgraphs )
+    // The checks only read the graph, except for ResolveDrivers() which updates the subgraph
+    // it is called on.  So each subgraph is checked by a single thread, and the errors are
+    // kept per subgraph.  Creating a marker is not thread safe, so the markers are created
+    // and added to the screens in subgraph order once all the threads are done, which also
+    // makes the results independent of the scheduling.
+    //
+    // ercCheckLabels() looks at the drivers of the hierarchical parent subgraph, which may
+    // belong to another thread, so the drivers are all resolved in a first pass.
+
+    std::vector<std::vector<ERC_PENDING_MARKER>> markers( m_subgraphs.size() );
+    std::vector<int>                             error_counts( m_subgraphs.size(), 0 );
+
+    auto run_parallel = [&]( const std::function<void( size_t )>& aCheck )
     {
-        // Graph is supposed to be up-to-date before calling RunERC()
-        wxASSERT( !subgraph->m_dirty );
+        size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                ( m_subgraphs.size() + 3 ) / 4 );
+
+        std::atomic<size_t> nextSubgraph( 0 );
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        auto check_lambda = [&]() -> size_t
+        {
+            for( size_t ii = nextSubgraph++; ii < m_subgraphs.size(); ii = nextSubgraph++ )
+                aCheck( ii );
+
+            return 1;
+        };
 
-        /**
-         * NOTE:
-         *
-         * We could check that labels attached to bus subgraphs follow the
-         * proper format (i.e. actually define a bus).
-         *
-         * This check doesn't need to be here right now because labels
-         * won't actually be connected to bus wires if they aren't in the right
-         * format due to their TestDanglingEnds() implementation.
-         */
+        if( parallelThreadCount <= 1 )
+            check_lambda();
+        else
+        {
+            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+                returns[ii] = std::async( std::launch::async, check_lambda );
 
-        if( g_ErcSettings->IsTestEnabled( ERCE_DRIVER_CONFLICT ) && !subgraph->ResolveDrivers() )
-            error_count++;
+            // Finalize the threads
+            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+                returns[ii].wait();
+        }
+    };
 
-        if( g_ErcSettings->IsTestEnabled( ERCE_BUS_TO_NET_CONFLICT )
-                && !ercCheckBusToNetConflicts( subgraph ) )
-            error_count++;
+    if( g_ErcSettings->IsTestEnabled( ERCE_DRIVER_CONFLICT ) )
+    {
+        run_parallel( [&]( size_t aIndex )
+                {
+                    if( !m_subgraphs[aIndex]->ResolveDrivers() )
+                        error_counts[aIndex]++;
+                } );
+    }
 
-        if( g_ErcSettings->IsTestEnabled( ERCE_BUS_ENTRY_CONFLICT )
-                && !ercCheckBusToBusEntryConflicts( subgraph ) )
-            error_count++;
+    run_parallel( [&]( size_t aIndex )
+            {
+                CONNECTION_SUBGRAPH*             subgraph = m_subgraphs[aIndex];
+                std::vector<ERC_PENDING_MARKER>& subgraph_markers = markers[aIndex];
+                int&                             error_count = error_counts[aIndex];
+
+                // Graph is supposed to be up-to-date before calling RunERC()
+                wxASSERT( !subgraph->m_dirty );
+
+                /**
+                 * NOTE:
+                 *
+                 * We could check that labels attached to bus subgraphs follow the
+                 * proper format (i.e. actually define a bus).
+                 *
+                 * This check doesn't need to be here right now because labels
+                 * won't actually be connected to bus wires if they aren't in the right
+                 * format due to their TestDanglingEnds() implementation.
+                 */
+
+                if( g_ErcSettings->IsTestEnabled( ERCE_BUS_TO_NET_CONFLICT )
+                        && !ercCheckBusToNetConflicts( subgraph, subgraph_markers ) )
+                    error_count++;
+
+                if( g_ErcSettings->IsTestEnabled( ERCE_BUS_ENTRY_CONFLICT )
+                        && !ercCheckBusToBusEntryConflicts( subgraph, subgraph_markers ) )
+                    error_count++;
+
+                if( g_ErcSettings->IsTestEnabled( ERCE_BUS_TO_BUS_CONFLICT )
+                        && !ercCheckBusToBusConflicts( subgraph, subgraph_markers ) )
+                    error_count++;
+
+                // The following checks are always performed since they don't currently
+                // have an option exposed to the user
+
+                if( !ercCheckNoConnects( subgraph, subgraph_markers ) )
+                    error_count++;
+
+                if( ( g_ErcSettings->IsTestEnabled( ERCE_LABEL_NOT_CONNECTED )
+                        || g_ErcSettings->IsTestEnabled( ERCE_GLOBLABEL ) )
+                        && !ercCheckLabels( subgraph, subgraph_markers ) )
+                    error_count++;
+            } );
 
-        if( g_ErcSettings->IsTestEnabled( ERCE_BUS_TO_BUS_CONFLICT )
-                && !ercCheckBusToBusConflicts( subgraph ) )
-            error_count++;
+    int error_count = 0;
 
-        // The following checks are always performed since they don't currently
-        // have an option exposed to the user
+    for( size_t ii = 0; ii < m_subgraphs.size(); ii++ )
+    {
+        SCH_SCREEN* screen = m_subgraphs[ii]->m_sheet.LastScreen();
 
-        if( !ercCheckNoConnects( subgraph ) )
-            error_count++;
+        for( const ERC_PENDING_MARKER& error : markers[ii] )
+            screen->Append( error.CreateMarker() );
 
-        if( ( g_ErcSettings->IsTestEnabled( ERCE_LABEL_NOT_CONNECTED )
-                || g_ErcSettings->IsTestEnabled( ERCE_GLOBLABEL ) ) && !ercCheckLabels( subgraph ) )
-            error_count++;
+        error_count += error_counts[ii];
     }
 
     return error_count;
 }
 
 
-bool CONNECTION_GRAPH::ercCheckBusToNetConflicts( const CONNECTION_SUBGRAPH* aSubgraph )
+bool CONNECTION_GRAPH::ercCheckBusToNetConflicts( const CONNECTION_SUBGRAPH* aSubgraph,
+                                                  std::vector<ERC_PENDING_MARKER>& aMarkers )
 {
-    auto sheet = aSubgraph->m_sheet;
-    auto screen = sheet.LastScreen();
-
     SCH_ITEM* net_item = nullptr;
     SCH_ITEM* bus_item = nullptr;
     SCH_CONNECTION conn;
@@ -2009,11 +2682,8 @@ bool CONNECTION_GRAPH::ercCheckBusToNetConflicts( const CONNECTION_SUBGRAPH* aSu
 
     if( net_item && bus_item )
     {
-        ERC_ITEM* ercItem = new ERC_ITEM( ERCE_BUS_TO_NET_CONFLICT );
-        ercItem->SetItems( net_item, bus_item );
-
-        SCH_MARKER* marker = new SCH_MARKER( ercItem, net_item->GetPosition() );
-        screen->Append( marker );
+        aMarkers.push_back( { ERCE_BUS_TO_NET_CONFLICT, net_item->GetPosition(),
+                              net_item, bus_item } );
 
         return false;
     }
@@ -2022,11 +2692,11 @@ bool CONNECTION_GRAPH::ercCheckBusToNetConflicts( const CONNECTION_SUBGRAPH* aSu
 }
 
 
-bool CONNECTION_GRAPH::ercCheckBusToBusConflicts( const CONNECTION_SUBGRAPH* aSubgraph )
+bool CONNECTION_GRAPH::ercCheckBusToBusConflicts( const CONNECTION_SUBGRAPH* aSubgraph,
+                                                  std::vector<ERC_PENDING_MARKER>& aMarkers )
 {
     wxString msg;
     auto sheet = aSubgraph->m_sheet;
-    auto screen = sheet.LastScreen();
 
     SCH_ITEM* label = nullptr;
     SCH_ITEM* port = nullptr;
@@ -2077,11 +2747,7 @@ bool CONNECTION_GRAPH::ercCheckBusToBusConflicts( const CONNECTION_SUBGRAPH* aSu
 
         if( !match )
         {
-            ERC_ITEM* ercItem = new ERC_ITEM( ERCE_BUS_TO_BUS_CONFLICT );
-            ercItem->SetItems( label, port );
-
-            SCH_MARKER* marker = new SCH_MARKER( ercItem, label->GetPosition() );
-            screen->Append( marker );
+            aMarkers.push_back( { ERCE_BUS_TO_BUS_CONFLICT, label->GetPosition(), label, port } );
 
             return false;
         }
@@ -2091,11 +2757,11 @@ bool CONNECTION_GRAPH::ercCheckBusToBusConflicts( const CONNECTION_SUBGRAPH* aSu
 }
 
 
-bool CONNECTION_GRAPH::ercCheckBusToBusEntryConflicts( const CONNECTION_SUBGRAPH* aSubgraph )
+bool CONNECTION_GRAPH::ercCheckBusToBusEntryConflicts( const CONNECTION_SUBGRAPH* aSubgraph,
+                                                       std::vector<ERC_PENDING_MARKER>& aMarkers )
 {
     bool conflict = false;
     auto sheet = aSubgraph->m_sheet;
-    auto screen = sheet.LastScreen();
 
     SCH_BUS_WIRE_ENTRY* bus_entry = nullptr;
     SCH_ITEM* bus_wire = nullptr;
@@ -2157,11 +2823,8 @@ bool CONNECTION_GRAPH::ercCheckBusToBusEntryConflicts( const CONNECTION_SUBGRAPH
 
     if( conflict )
     {
-        ERC_ITEM* ercItem = new ERC_ITEM( ERCE_BUS_ENTRY_CONFLICT );
-        ercItem->SetItems( bus_entry, bus_wire );
-
-        SCH_MARKER* marker = new SCH_MARKER( ercItem, bus_entry->GetPosition() );
-        screen->Append( marker );
+        aMarkers.push_back( { ERCE_BUS_ENTRY_CONFLICT, bus_entry->GetPosition(),
+                              bus_entry, bus_wire } );
 
         return false;
     }
@@ -2171,11 +2834,11 @@ bool CONNECTION_GRAPH::ercCheckBusToBusEntryConflicts( const CONNECTION_SUBGRAPH
 
 
 // TODO(JE) Check sheet pins here too?
-bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph )
+bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph,
+                                           std::vector<ERC_PENDING_MARKER>& aMarkers )
 {
     wxString msg;
     auto sheet = aSubgraph->m_sheet;
-    auto screen = sheet.LastScreen();
 
     if( aSubgraph->m_no_connect != nullptr )
     {
@@ -2210,22 +2873,17 @@ bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph
 
         if( pin && has_invalid_items )
         {
-            ERC_ITEM* ercItem = new ERC_ITEM( ERCE_NOCONNECT_CONNECTED );
-            ercItem->SetItems( pin );
-
-            SCH_MARKER* marker = new SCH_MARKER( ercItem, pin->GetTransformedPosition() );
-            screen->Append( marker );
+            aMarkers.push_back( { ERCE_NOCONNECT_CONNECTED, pin->GetTransformedPosition(),
+                                  pin, nullptr } );
 
             return false;
         }
 
         if( !has_other_items )
         {
-            ERC_ITEM* ercItem = new ERC_ITEM( ERCE_NOCONNECT_NOT_CONNECTED );
-            ercItem->SetItems( aSubgraph->m_no_connect );
-
-            SCH_MARKER* marker = new SCH_MARKER( ercItem, aSubgraph->m_no_connect->GetPosition() );
-            screen->Append( marker );
+            aMarkers.push_back( { ERCE_NOCONNECT_NOT_CONNECTED,
+                                  aSubgraph->m_no_connect->GetPosition(), aSubgraph->m_no_connect,
+                                  nullptr } );
 
             return false;
         }
@@ -2276,11 +2934,8 @@ bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph
 
         if( pin && !has_other_connections && pin->GetType() != ELECTRICAL_PINTYPE::PT_NC )
         {
-            ERC_ITEM* ercItem = new ERC_ITEM( ERCE_PIN_NOT_CONNECTED );
-            ercItem->SetItems( pin );
-
-            SCH_MARKER* marker = new SCH_MARKER( ercItem, pin->GetTransformedPosition() );
-            screen->Append( marker );
+            aMarkers.push_back( { ERCE_PIN_NOT_CONNECTED, pin->GetTransformedPosition(),
+                                  pin, nullptr } );
 
             return false;
         }
@@ -2290,7 +2945,8 @@ bool CONNECTION_GRAPH::ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph
 }
 
 
-bool CONNECTION_GRAPH::ercCheckLabels( const CONNECTION_SUBGRAPH* aSubgraph )
+bool CONNECTION_GRAPH::ercCheckLabels( const CONNECTION_SUBGRAPH* aSubgraph,
+                                       std::vector<ERC_PENDING_MARKER>& aMarkers )
 {
     // Label connection rules:
     // Local labels are flagged if they don't connect to any pins and don't have a no-connect
@@ -2368,11 +3024,9 @@ bool CONNECTION_GRAPH::ercCheckLabels( const CONNECTION_SUBGRAPH* aSubgraph )
 
     if( !has_other_connections )
     {
-        ERC_ITEM* ercItem = new ERC_ITEM( is_global ? ERCE_GLOBLABEL : ERCE_LABEL_NOT_CONNECTED );
-        ercItem->SetItems( text );
+        int errorCode = is_global ? ERCE_GLOBLABEL : ERCE_LABEL_NOT_CONNECTED;
 
-        SCH_MARKER* marker = new SCH_MARKER( ercItem, text->GetPosition() );
-        aSubgraph->m_sheet.LastScreen()->Append( marker );
+        aMarkers.push_back( { errorCode, text->GetPosition(), text, nullptr } );
 
         return false;
     }
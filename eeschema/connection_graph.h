@@ -22,6 +22,7 @@
 #define _CONNECTION_GRAPH_H
 
 #include <mutex>
+#include <unordered_set>
 #include <vector>
 
 #include <common.h>
@@ -38,9 +39,12 @@
 
 class SCH_EDIT_FRAME;
 class SCH_HIERLABEL;
+class SCH_MARKER;
 class SCH_PIN;
 class SCH_SHEET_PIN;
 
+struct ERC_PENDING_MARKER;
+
 
 /**
  * A subgraph is a set of items that are electrically connected on a single sheet.
@@ -196,6 +200,10 @@ public:
 
     // If not null, this indicates the subgraph on a higher level sheet that is linked to this one
     CONNECTION_SUBGRAPH* m_hier_parent;
+
+    /// Names through which this subgraph may be linked to other subgraphs (labels, power pins,
+    /// hierarchical connections and net names), used to find the subgraphs affected by an edit
+    std::vector<wxString> m_link_keys;
 };
 
 /// Associates a net code with the final name of a net
@@ -227,6 +235,12 @@ public:
     /**
      * Updates the connection graph for the given list of sheets.
      *
+     * Unless aUnconditional is set, an existing graph is updated incrementally: the item
+     * connectivity is only rebuilt on the sheets with changed (or added or removed) items,
+     * and only the subgraphs holding these items are rebuilt, along with all the subgraphs
+     * they may be linked to through their names, buses or the hierarchy.  The drivers are
+     * resolved and propagated again for these subgraphs only, the others are kept as is.
+     *
      * @param aSheetList is the list of possibly modified sheets
      * @param aUnconditional is true if an unconditional full recalculation should be done
      */
@@ -240,6 +254,13 @@ public:
      */
     std::shared_ptr<BUS_ALIAS> GetBusAlias( const wxString& aName );
 
+    /**
+     * Returns the subgraph holding an item on a given sheet.
+     *
+     * @return the subgraph, or nullptr if the item is not part of the graph
+     */
+    CONNECTION_SUBGRAPH* GetSubgraphForItem( SCH_ITEM* aItem, const SCH_SHEET_PATH& aSheet ) const;
+
     /**
      * Determines which subgraphs have more than one conflicting bus label.
      *
@@ -252,6 +273,9 @@ public:
     /**
      * Runs electrical rule checks on the connectivity graph.
      *
+     * The subgraphs are checked in parallel; the resulting markers are added to the
+     * schematic in subgraph order.
+     *
      * Precondition: graph is up-to-date
      *
      * @return the number of errors found
@@ -279,6 +303,16 @@ private:
 
     std::vector<std::pair<SCH_SHEET_PATH, SCH_PIN*>> m_invisible_power_pins;
 
+    // Connectable items (including component and sheet pins) of each sheet, as of the last
+    // update of its item connectivity.  Used to find the sheets that need to be updated.
+    std::unordered_map<SCH_SHEET_PATH, std::vector<SCH_ITEM*>> m_sheet_to_items_map;
+
+    // Cache to lookup subgraphs in m_subgraphs by code
+    std::unordered_map<long, CONNECTION_SUBGRAPH*> m_subgraph_code_map;
+
+    // Subgraphs by CONNECTION_SUBGRAPH::m_link_keys, to find the subgraphs linked to a changed one
+    std::unordered_map<wxString, std::vector<CONNECTION_SUBGRAPH*>> m_link_key_to_subgraphs_map;
+
     std::unordered_map< wxString, std::shared_ptr<BUS_ALIAS> > m_bus_alias_cache;
 
     std::map<wxString, int> m_net_name_to_code_map;
@@ -332,9 +366,89 @@ private:
      *
      * @param aSheet is the path to the sheet of all items in the list
      * @param aItemList is a list of items to consider
+     * @param aResetConnections is false to keep the existing connections of the items, which
+     *                          are then reset by invalidateSubgraphs() as needed
      */
     void updateItemConnectivity( SCH_SHEET_PATH aSheet,
-                                 const std::vector<SCH_ITEM*>& aItemList );
+                                 const std::vector<SCH_ITEM*>& aItemList,
+                                 bool aResetConnections = true );
+
+    /**
+     * Adds the items of a sheet to the graph.  Thread-safe, so sheets can be updated in
+     * parallel.
+     *
+     * @param aItems are the items (and pins) of the sheet
+     * @param aInvisiblePowerPins are the invisible power pins of the sheet, to be processed
+     *                            by buildConnectionGraph()
+     */
+    void addGraphItems( const std::vector<SCH_ITEM*>& aItems,
+            const std::vector<std::pair<SCH_SHEET_PATH, SCH_PIN*>>& aInvisiblePowerPins );
+
+    /**
+     * Creates a new connection for an item (or resets its existing one) and sets its type
+     * (bus or net) so that the propagation code uses it.
+     */
+    SCH_CONNECTION* initializeConnection( const SCH_SHEET_PATH& aSheet, SCH_ITEM* aItem );
+
+    /**
+     * Checks if the item connectivity of a sheet has to be rebuilt, i.e. if some of its
+     * connectable items have changed since the last update, and stores the current items
+     * for the next check.
+     *
+     * @param aSheet is the path to the sheet of all items in the list
+     * @param aItemList is the list of connectable items of the sheet
+     * @param aChangedItems receives the changed items of the sheet (pins instead of their
+     *                      component or sheet, but also the changed sheets themselves)
+     * @param aRemovedItems receives the items removed from the sheet, which may be deleted
+     * @return true if the sheet has changed
+     */
+    bool findChangedItems( const SCH_SHEET_PATH& aSheet, const std::vector<SCH_ITEM*>& aItemList,
+                           std::vector<SCH_ITEM*>& aChangedItems,
+                           std::unordered_set<SCH_ITEM*>& aRemovedItems );
+
+    /**
+     * Refreshes the bus alias cache from the screens of the schematic.
+     *
+     * @return true if the aliases have changed since the last call
+     */
+    bool recacheBusAliases();
+
+    /**
+     * Prepares an incremental update: finds the subgraphs holding the changed items and all
+     * the subgraphs they may be linked to, deletes them and resets the connections of their
+     * items, so buildConnectionGraph() rebuilds them.
+     *
+     * @param aSheetList is the list of sheets of the schematic
+     * @param aChangedItems are the changed items of each sheet of the list
+     * @param aRemovedItems are the items removed from the schematic
+     * @return the subgraphs that are not affected by the changes
+     */
+    std::vector<CONNECTION_SUBGRAPH*> invalidateSubgraphs(
+            const SCH_SHEET_LIST& aSheetList,
+            const std::vector<std::vector<SCH_ITEM*>>& aChangedItems,
+            const std::unordered_set<SCH_ITEM*>& aRemovedItems );
+
+    /**
+     * Adds back the subgraphs kept by invalidateSubgraphs() once the others are rebuilt.
+     */
+    void restoreSubgraphs( const std::vector<CONNECTION_SUBGRAPH*>& aSubgraphs );
+
+    /**
+     * Resets the connection of an item of a subgraph being rebuilt, and adds the item to the
+     * graph.  The links between items are kept.
+     */
+    void resetItemConnection( const SCH_SHEET_PATH& aSheet, SCH_ITEM* aItem );
+
+    /**
+     * Adds the names through which an item may link its subgraph to others to aKeys.
+     */
+    void getLinkKeys( const SCH_SHEET_PATH& aSheet, SCH_ITEM* aItem,
+                      std::vector<wxString>& aKeys );
+
+    /**
+     * Stores the link keys of a newly built subgraph, see CONNECTION_SUBGRAPH::m_link_keys.
+     */
+    void cacheLinkKeys( CONNECTION_SUBGRAPH* aSubgraph );
 
     /**
      * Generates the connection graph (after all item connectivity has been updated)
@@ -402,9 +516,11 @@ private:
      * For example, a net wire connected to a bus port/pin, or vice versa
      *
      * @param  aSubgraph      is the subgraph to examine
+     * @param  aMarkers       receives the errors found
      * @return                true for no errors, false for errors
      */
-    bool ercCheckBusToNetConflicts( const CONNECTION_SUBGRAPH* aSubgraph );
+    bool ercCheckBusToNetConflicts( const CONNECTION_SUBGRAPH* aSubgraph,
+                                    std::vector<ERC_PENDING_MARKER>& aMarkers );
 
     /**
      * Checks one subgraph for conflicting connections between two bus items
@@ -414,9 +530,11 @@ private:
      * sheet pin
      *
      * @param  aSubgraph      is the subgraph to examine
+     * @param  aMarkers       receives the errors found
      * @return                true for no errors, false for errors
      */
-    bool ercCheckBusToBusConflicts( const CONNECTION_SUBGRAPH* aSubgraph );
+    bool ercCheckBusToBusConflicts( const CONNECTION_SUBGRAPH* aSubgraph,
+                                    std::vector<ERC_PENDING_MARKER>& aMarkers );
 
     /**
      * Checks one subgraph for conflicting bus entry to bus connections
@@ -428,9 +546,11 @@ private:
      * "USB.DP" but someone might accidentally just enter "DP"
      *
      * @param  aSubgraph      is the subgraph to examine
+     * @param  aMarkers       receives the errors found
      * @return                true for no errors, false for errors
      */
-    bool ercCheckBusToBusEntryConflicts( const CONNECTION_SUBGRAPH* aSubgraph );
+    bool ercCheckBusToBusEntryConflicts( const CONNECTION_SUBGRAPH* aSubgraph,
+                                         std::vector<ERC_PENDING_MARKER>& aMarkers );
 
     /**
      * Checks one subgraph for proper presence or absence of no-connect symbols
@@ -439,9 +559,11 @@ private:
      * A pin without a no-connect symbol should have at least one connection
      *
      * @param  aSubgraph      is the subgraph to examine
+     * @param  aMarkers       receives the errors found
      * @return                true for no errors, false for errors
      */
-    bool ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph );
+    bool ercCheckNoConnects( const CONNECTION_SUBGRAPH* aSubgraph,
+                             std::vector<ERC_PENDING_MARKER>& aMarkers );
 
     /**
      * Checks one subgraph for proper connection of labels
@@ -449,10 +571,11 @@ private:
      * Labels should be connected to something
      *
      * @param  aSubgraph      is the subgraph to examine
-     * @param  aCheckGlobalLabels is true if global labels should be checked for loneliness
+     * @param  aMarkers       receives the errors found
      * @return                true for no errors, false for errors
      */
-    bool ercCheckLabels( const CONNECTION_SUBGRAPH* aSubgraph );
+    bool ercCheckLabels( const CONNECTION_SUBGRAPH* aSubgraph,
+                         std::vector<ERC_PENDING_MARKER>& aMarkers );
 
 };
 
@@ -406,8 +406,9 @@ void SCH_EDIT_FRAME::KiwayMailIn( KIWAY_EXPRESS& mail )
         }
 
         {
-            NETLIST_OBJECT_LIST* net_atoms = BuildNetListBase();
-            NETLIST_EXPORTER_KICAD exporter( this, net_atoms, g_ConnectionGraph );
+            RecalculateConnections( NO_CLEANUP );
+
+            NETLIST_EXPORTER_KICAD exporter( this, nullptr, g_ConnectionGraph );
             STRING_FORMATTER formatter;
 
             exporter.Format( &formatter, GNL_ALL );
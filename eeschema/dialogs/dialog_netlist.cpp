@@ -497,12 +497,10 @@ bool NETLIST_DIALOG::TransferDataFromWindow()
     else
         m_Parent->SetNetListerCommand( wxEmptyString );
 
-    auto netlist = m_Parent->CreateNetlist( false, false );
-
-    if( netlist == nullptr )
+    if( !m_Parent->ReadyToNetlist( false, false ) )
         wxMessageBox( _( "Schematic netlist not available" ) );
     else
-        m_Parent->WriteNetListFile( netlist, currPage->m_IdNetType, fullpath, netlist_opt, NULL );
+        m_Parent->WriteNetListFile( currPage->m_IdNetType, fullpath, netlist_opt, NULL );
 
     WriteCurrentNetlistSetup();
 
@@ -40,6 +40,13 @@
 #include <sch_reference_list.h>
 #include <wx/ffile.h>
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <map>
+#include <thread>
+#include <unordered_map>
+
 
 /* ERC tests :
  *  1 - conflicts between connected pins ( example: 2 connected outputs )
@@ -375,7 +382,27 @@ int TestMultiunitFootprints( SCH_SHEET_LIST& aSheetList )
 }
 
 
-void Diagnose( NETLIST_OBJECT* aNetItemRef, NETLIST_OBJECT* aNetItemTst, int aMinConn, int aDiag )
+SCH_MARKER* ERC_PENDING_MARKER::CreateMarker() const
+{
+    ERC_ITEM* ercItem = new ERC_ITEM( m_errorCode );
+    ercItem->SetItems( m_mainItem, m_auxItem );
+
+    return new SCH_MARKER( ercItem, m_position );
+}
+
+
+static void addMarker( SCH_SCREEN* aScreen, const ERC_PENDING_MARKER& aError,
+                       ERC_PENDING_MARKERS* aMarkers )
+{
+    if( aMarkers )
+        aMarkers->emplace_back( aScreen, aError );
+    else
+        aScreen->Append( aError.CreateMarker() );
+}
+
+
+void Diagnose( NETLIST_OBJECT* aNetItemRef, NETLIST_OBJECT* aNetItemTst, int aMinConn, int aDiag,
+               ERC_PENDING_MARKERS* aMarkers )
 {
     if( aDiag == OK || aMinConn < 1 || aNetItemRef->m_Type != NETLIST_ITEM::PIN )
         return;
@@ -386,29 +413,24 @@ void Diagnose( NETLIST_OBJECT* aNetItemRef, NETLIST_OBJECT* aNetItemTst, int aMi
     {
         if( aMinConn == NOD )    /* Nothing driving the net. */
         {
-            ERC_ITEM* ercItem = new ERC_ITEM( ERCE_PIN_NOT_DRIVEN );
-            ercItem->SetItems( pin );
-
-            SCH_MARKER* marker = new SCH_MARKER( ercItem, aNetItemRef->m_Start );
-            aNetItemRef->m_SheetPath.LastScreen()->Append( marker );
+            addMarker( aNetItemRef->m_SheetPath.LastScreen(),
+                       { ERCE_PIN_NOT_DRIVEN, aNetItemRef->m_Start, pin, nullptr }, aMarkers );
             return;
         }
     }
 
     if( aNetItemTst && aNetItemTst->m_Type == NETLIST_ITEM::PIN )  /* Error between 2 pins */
     {
-        ERC_ITEM* ercItem = new ERC_ITEM( aDiag == ERR ? ERCE_PIN_TO_PIN_ERROR
-                                                       : ERCE_PIN_TO_PIN_WARNING );
-        ercItem->SetItems( pin, static_cast<SCH_PIN*>( aNetItemTst->m_Comp ) );
+        int errorCode = aDiag == ERR ? ERCE_PIN_TO_PIN_ERROR : ERCE_PIN_TO_PIN_WARNING;
 
-        SCH_MARKER* marker = new SCH_MARKER( ercItem, aNetItemRef->m_Start );
-        aNetItemRef->m_SheetPath.LastScreen()->Append( marker );
+        addMarker( aNetItemRef->m_SheetPath.LastScreen(),
+                   { errorCode, aNetItemRef->m_Start, pin, aNetItemTst->m_Comp }, aMarkers );
     }
 }
 
 
 void TestOthersItems( NETLIST_OBJECT_LIST* aList, unsigned aNetItemRef, unsigned aNetStart,
-                      int* aMinConnexion )
+                      int* aMinConnexion, ERC_PENDING_MARKERS* aMarkers )
 {
     unsigned netItemTst = aNetStart;
     ELECTRICAL_PINTYPE jj;
@@ -482,7 +504,7 @@ void TestOthersItems( NETLIST_OBJECT_LIST* aList, unsigned aNetItemRef, unsigned
                 }
 
                 if( seterr )
-                    Diagnose( aList->GetItem( aNetItemRef ), NULL, local_minconn, WAR );
+                    Diagnose( aList->GetItem( aNetItemRef ), NULL, local_minconn, WAR, aMarkers );
 
                 *aMinConnexion = DRV;   // inhibiting other messages of this
                                        // type for the net.
@@ -529,7 +551,7 @@ void TestOthersItems( NETLIST_OBJECT_LIST* aList, unsigned aNetItemRef, unsigned
                     if( aList->GetConnectionType( netItemTst ) == NET_CONNECTION::UNCONNECTED )
                     {
                         Diagnose( aList->GetItem( aNetItemRef ), aList->GetItem( netItemTst ),
-                                  0, erc );
+                                  0, erc, aMarkers );
                         aList->SetConnectionType( netItemTst,
                                                   NET_CONNECTION::NOCONNECT_SYMBOL_PRESENT );
                     }
@@ -541,6 +563,70 @@ void TestOthersItems( NETLIST_OBJECT_LIST* aList, unsigned aNetItemRef, unsigned
     }
 }
 
+void TestPinToPinConflicts( NETLIST_OBJECT_LIST* aList )
+{
+    std::vector<std::pair<unsigned, unsigned>> nets;   // [first, last) item of each net
+
+    for( unsigned ii = 0; ii < aList->size(); ii++ )
+    {
+        NETLIST_OBJECT* item = aList->GetItem( ii );
+
+        if( nets.empty() || aList->GetItemNet( nets.back().first ) != item->GetNet() )
+            nets.emplace_back( ii, ii );
+
+        nets.back().second = ii + 1;
+
+        // GetRef() stores the reference of an instance when it is missing, so make sure
+        // this happens here rather than from the threads below.
+        if( item->m_Type == NETLIST_ITEM::PIN && item->m_Link )
+            static_cast<SCH_COMPONENT*>( item->m_Link )->GetRef( &item->m_SheetPath );
+    }
+
+    // A net only changes the connection type of its own items, and the search for other
+    // instances of an unconnected pin only reads the list.
+    std::vector<ERC_PENDING_MARKERS> markers( nets.size() );
+    std::atomic<size_t>              nextNet( 0 );
+
+    auto test_lambda = [&]() -> size_t
+    {
+        for( size_t net = nextNet++; net < nets.size(); net = nextNet++ )
+        {
+            int minConn = NOC;
+
+            for( unsigned ii = nets[net].first; ii < nets[net].second; ii++ )
+            {
+                if( aList->GetItemType( ii ) == NETLIST_ITEM::PIN )
+                    TestOthersItems( aList, ii, nets[net].first, &minConn, &markers[net] );
+            }
+        }
+
+        return 1;
+    };
+
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+            ( nets.size() + 15 ) / 16 );
+
+    if( parallelThreadCount <= 1 )
+        test_lambda();
+    else
+    {
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, test_lambda );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
+    }
+
+    for( const ERC_PENDING_MARKERS& netMarkers : markers )
+    {
+        for( const auto& pending : netMarkers )
+            pending.first->Append( pending.second.CreateMarker() );
+    }
+}
+
+
 // this code try to detect similar labels, i.e. labels which are identical
 // when they are compared using case insensitive coparisons.
 
@@ -567,17 +653,46 @@ struct compare_label_names
     }
 };
 
-struct compare_paths
+// Helper functions to build the warning messages about Similar Labels:
+static void SimilarLabelsDiagnose( NETLIST_OBJECT* aItemA, NETLIST_OBJECT* aItemB );
+
+
+/// The labels of a sheet path, for TestforSimilarLabels()
+struct SHEET_LABELS
 {
-    bool operator() ( const NETLIST_OBJECT* lab1, const NETLIST_OBJECT* lab2 ) const
+    std::set<NETLIST_OBJECT*, compare_label_names> m_unique;  ///< One label per name
+    std::unordered_map<wxString, int>              m_counts;  ///< Number of labels per name
+};
+
+
+/**
+ * Calls \a aFunc( a, b ) for each pair of labels of \a aLabels whose names only differ by
+ * case, with a before b in \a aLabels.  The labels are grouped by their lower case name, so
+ * this is linear in the number of labels rather than comparing every pair.
+ */
+template<typename FUNC>
+static void forEachSimilarLabel( const std::set<NETLIST_OBJECT*, compare_label_names>& aLabels,
+                                 FUNC aFunc )
+{
+    std::unordered_map<wxString, std::vector<NETLIST_OBJECT*>> groups;
+    std::vector<std::pair<NETLIST_OBJECT*, size_t>>           positions;
+
+    for( NETLIST_OBJECT* label : aLabels )
     {
-        return lab1->m_SheetPath.Path() < lab2->m_SheetPath.Path();
+        std::vector<NETLIST_OBJECT*>& group = groups[ label->m_Label.Lower() ];
+
+        positions.emplace_back( label, group.size() );
+        group.push_back( label );
     }
-};
 
-// Helper functions to build the warning messages about Similar Labels:
-static int countIndenticalLabels( std::vector<NETLIST_OBJECT*>& aList, NETLIST_OBJECT* aRef );
-static void SimilarLabelsDiagnose( NETLIST_OBJECT* aItemA, NETLIST_OBJECT* aItemB );
+    for( const auto& position : positions )
+    {
+        const std::vector<NETLIST_OBJECT*>& group = groups[ position.first->m_Label.Lower() ];
+
+        for( size_t ii = position.second + 1; ii < group.size(); ii++ )
+            aFunc( position.first, group[ii] );
+    }
+}
 
 
 void NETLIST_OBJECT_LIST::TestforSimilarLabels()
@@ -620,110 +735,65 @@ void NETLIST_OBJECT_LIST::TestforSimilarLabels()
         }
     }
 
-    // build global labels and compare
-    std::set<NETLIST_OBJECT*, compare_label_names> loc_labelList;
+    // Count the labels once, rather than scanning the full list for each similar pair:
+    // global labels by name in the full project, and all labels by name in each sheet path.
+    std::unordered_map<wxString, int> globalLabelCounts;
+    std::map<KIID_PATH, SHEET_LABELS> sheetLabels;
 
-    for( NETLIST_OBJECT* label : uniqueLabelList )
+    for( NETLIST_OBJECT* label : fullLabelList )
     {
         if( label->IsLabelGlobal() )
-            loc_labelList.insert( label );
+            globalLabelCounts[ label->m_Label ]++;
+
+        sheetLabels[ label->m_SheetPath.Path() ].m_counts[ label->m_Label ]++;
     }
 
-    // compare global labels (same label names appears only once in list)
-    for( auto it = loc_labelList.begin(); it != loc_labelList.end(); ++it )
+    auto countIdenticalLabels = [&]( NETLIST_OBJECT* aRef ) -> int
     {
-        auto it_aux = it;
+        if( aRef->IsLabelGlobal() )
+            return globalLabelCounts[ aRef->m_Label ];
+        else
+            return sheetLabels[ aRef->m_SheetPath.Path() ].m_counts[ aRef->m_Label ];
+    };
 
-        for( ++it_aux; it_aux != loc_labelList.end(); ++it_aux )
-        {
-            if( (*it)->m_Label.CmpNoCase( (*it_aux)->m_Label ) == 0 )
-            {
-                // Create new marker for ERC.
-                int cntA = countIndenticalLabels( fullLabelList, *it );
-                int cntB = countIndenticalLabels( fullLabelList, *it_aux );
-
-                if( cntA <= cntB )
-                    SimilarLabelsDiagnose( (*it), (*it_aux) );
-                else
-                    SimilarLabelsDiagnose( (*it_aux), (*it) );
-            }
-        }
-    }
+    auto diagnose = [&]( NETLIST_OBJECT* aItemA, NETLIST_OBJECT* aItemB )
+    {
+        // Create new marker for ERC.
+        if( countIdenticalLabels( aItemA ) <= countIdenticalLabels( aItemB ) )
+            SimilarLabelsDiagnose( aItemA, aItemB );
+        else
+            SimilarLabelsDiagnose( aItemB, aItemA );
+    };
 
-    // Build paths list
-    std::set<NETLIST_OBJECT*, compare_paths> pathsList;
+    // build global labels and compare
+    std::set<NETLIST_OBJECT*, compare_label_names> loc_labelList;
 
     for( NETLIST_OBJECT* label : uniqueLabelList )
-        pathsList.insert( label );
-
-    // Examine each label inside a sheet path:
-    for( NETLIST_OBJECT* candidate : pathsList )
     {
-        loc_labelList.clear();
-
-        for( NETLIST_OBJECT* uniqueLabel : uniqueLabelList)
-        {
-            if( candidate->m_SheetPath.Path() == uniqueLabel->m_SheetPath.Path() )
-                loc_labelList.insert( uniqueLabel );
-        }
-
-        // at this point, loc_labelList contains labels of the current sheet path.
-        // Detect similar labels (same label names appears only once in list)
-
-        for( auto ref_it = loc_labelList.begin(); ref_it != loc_labelList.end(); ++ref_it )
-        {
-            NETLIST_OBJECT* ref_item = *ref_it;
-            auto it_aux = ref_it;
-
-            for( ++it_aux; it_aux != loc_labelList.end(); ++it_aux )
-            {
-                // global label versus global label was already examined.
-                // here, at least one label must be local
-                if( ref_item->IsLabelGlobal() && ( *it_aux )->IsLabelGlobal() )
-                    continue;
+        if( label->IsLabelGlobal() )
+            loc_labelList.insert( label );
 
-                if( ref_item->m_Label.CmpNoCase( ( *it_aux )->m_Label ) == 0 )
-                {
-                    // Create new marker for ERC.
-                    int cntA = countIndenticalLabels( fullLabelList, ref_item );
-                    int cntB = countIndenticalLabels( fullLabelList, *it_aux );
-
-                    if( cntA <= cntB )
-                        SimilarLabelsDiagnose( ref_item, ( *it_aux ) );
-                    else
-                        SimilarLabelsDiagnose( ( *it_aux ), ref_item );
-                }
-            }
-        }
+        sheetLabels[ label->m_SheetPath.Path() ].m_unique.insert( label );
     }
-}
-
 
-// Helper function: count the number of labels identical to aLabel
-//  for global label: global labels in the full project
-//  for local label: all labels in the current sheet
-static int countIndenticalLabels( std::vector<NETLIST_OBJECT*>& aList, NETLIST_OBJECT* aRef )
-{
-    int count = 0;
+    // compare global labels (same label names appears only once in list)
+    forEachSimilarLabel( loc_labelList, diagnose );
 
-    if( aRef->IsLabelGlobal() )
-    {
-        for( NETLIST_OBJECT* i : aList )
-        {
-            if( i->IsLabelGlobal() && i->m_Label == aRef->m_Label )
-                count++;
-        }
-    }
-    else
+    // Examine each label inside a sheet path:
+    for( auto& sheet : sheetLabels )
     {
-        for( NETLIST_OBJECT* i : aList )
-        {
-            if( i->m_Label == aRef->m_Label && i->m_SheetPath.Path() == aRef->m_SheetPath.Path() )
-                count++;
-        }
-    }
+        // Detect similar labels (same label names appears only once in list)
+        forEachSimilarLabel( sheet.second.m_unique,
+                [&]( NETLIST_OBJECT* aRef, NETLIST_OBJECT* aOther )
+                {
+                    // global label versus global label was already examined.
+                    // here, at least one label must be local
+                    if( aRef->IsLabelGlobal() && aOther->IsLabelGlobal() )
+                        return;
 
-    return count;
+                    diagnose( aRef, aOther );
+                } );
+    }
 }
 
 
@@ -30,11 +30,40 @@
 #ifndef _ERC_H
 #define _ERC_H
 
+#include <utility>
+#include <vector>
 
+#include <wx/gdicmn.h>
+
+
+class EDA_ITEM;
 class NETLIST_OBJECT;
 class NETLIST_OBJECT_LIST;
+class SCH_MARKER;
+class SCH_SCREEN;
 class SCH_SHEET_LIST;
 
+/**
+ * An ERC error found by a check running on a worker thread.
+ *
+ * ERC_ITEMs and SCH_MARKERs get a new KIID when they are created, which is not thread
+ * safe, so the checks only record the error and the markers are created by the calling
+ * thread once the workers are done.
+ */
+struct ERC_PENDING_MARKER
+{
+    int       m_errorCode;
+    wxPoint   m_position;
+    EDA_ITEM* m_mainItem;
+    EDA_ITEM* m_auxItem;       ///< may be nullptr
+
+    /// Create the marker for this error, with its ERC_ITEM
+    SCH_MARKER* CreateMarker() const;
+};
+
+/// ERC errors not yet added to their screen as markers.
+typedef std::vector<std::pair<SCH_SCREEN*, ERC_PENDING_MARKER>> ERC_PENDING_MARKERS;
+
 /* For ERC markers: error types (used in diags, and to set the color):
 */
 enum errortype
@@ -88,9 +117,10 @@ enum ERCE_T
  * Performs ERC testing and creates an ERC marker to show the ERC problem for aNetItemRef
  * or between aNetItemRef and aNetItemTst.
  *  if MinConn < 0: this is an error on labels
+ * The error is added to \a aMarkers if given, otherwise a marker is added to the schematic.
  */
 void Diagnose( NETLIST_OBJECT* NetItemRef, NETLIST_OBJECT* NetItemTst, int MinConnexion,
-               int Diag );
+               int Diag, ERC_PENDING_MARKERS* aMarkers = nullptr );
 
 /**
  * Perform ERC testing for electrical conflicts between \a NetItemRef and other items
@@ -100,9 +130,18 @@ void Diagnose( NETLIST_OBJECT* NetItemRef, NETLIST_OBJECT* NetItemTst, int MinCo
  * @param aNetStart = index in list of net objects of the first item
  * @param aMinConnexion = a pointer to a variable to store the minimal connection
  * found( NOD, DRV, NPI, NET_NC)
+ * @param aMarkers = if given, receives the errors instead of the schematic
  */
 void TestOthersItems( NETLIST_OBJECT_LIST* aList, unsigned aNetItemRef, unsigned aNetStart,
-                      int* aMinConnexion );
+                      int* aMinConnexion, ERC_PENDING_MARKERS* aMarkers = nullptr );
+
+/**
+ * Perform the pin to pin ERC tests (TestOthersItems()) on all the pins of \a aList.
+ * The nets are tested in parallel, and the markers are added to the schematic in net
+ * order once all of them have been tested.
+ * @param aList = the list of connected objects, sorted by net code
+ */
+void TestPinToPinConflicts( NETLIST_OBJECT_LIST* aList );
 
 /**
  * Function TestDuplicateSheetNames( )
@@ -87,7 +87,9 @@ struct LIB_PART_LESS_THAN
 class NETLIST_EXPORTER
 {
 protected:
-    NETLIST_OBJECT_LIST*  m_masterList;       /// yes ownership, connected items flat list
+    /// yes ownership, connected items flat list.  May be null for the exporters which
+    /// work from the CONNECTION_GRAPH instead.
+    NETLIST_OBJECT_LIST*  m_masterList;
 
     /// Used to temporarily store and filter the list of pins of a schematic component
     /// when generating schematic component data in netlist (comp section). No ownership
@@ -34,47 +34,209 @@
 #include <class_library.h>
 #include <sch_base_frame.h>
 #include <symbol_lib_table.h>
+#include <richio.h>
+
+#include <memory>
 
 
 static bool sortPinsByNumber( LIB_PIN* aPin1, LIB_PIN* aPin2 );
 
-bool NETLIST_EXPORTER_GENERIC::WriteNetlist( const wxString& aOutFileName, unsigned aNetlistOptions )
+
+/**
+ * Escapes \a aText for use as XML character data, or as an attribute value when
+ * \a aAttribute is true.
+ */
+static wxString escapeXml( const wxString& aText, bool aAttribute )
 {
-    // Prepare list of nets generation
-    for( unsigned ii = 0; ii < m_masterList->size(); ii++ )
-        m_masterList->GetItem( ii )->m_Flag = 0;
+    wxString escaped;
 
-    // output the XML format netlist.
-    wxXmlDocument   xdoc;
+    escaped.reserve( aText.length() );
 
-    xdoc.SetRoot( makeRoot( GNL_ALL ) );
+    for( wxUniChar c : aText )
+    {
+        switch( c.GetValue() )
+        {
+        case '<':  escaped << "&lt;";    break;
+        case '>':  escaped << "&gt;";    break;
+        case '&':  escaped << "&amp;";   break;
+        case '"':  escaped << ( aAttribute ? "&quot;" : "\"" );  break;
+        case '\t': escaped << ( aAttribute ? "&#x9;" : "\t" );   break;
+        case '\n': escaped << ( aAttribute ? "&#xA;" : "\n" );   break;
+        case '\r': escaped << ( aAttribute ? "&#xD;" : "\r" );   break;
+        default:   escaped << c;         break;
+        }
+    }
 
-    return xdoc.Save( aOutFileName, 2 /* indent bug, today was ignored by wxXml lib */ );
+    return escaped;
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeRoot( int aCtl )
+/**
+ * Writes \a aNode and its children as XML, laid out the way wxXmlDocument::Save() does
+ * with an indentation step of 2.  The caller is expected to have placed the output at the
+ * start of a line indented by \a aIndent spaces.
+ */
+static void formatXml( OUTPUTFORMATTER* aOut, XNODE* aNode, int aIndent )
 {
-    XNODE*      xroot = node( "export" );
+    if( aNode->GetType() == wxXML_TEXT_NODE )
+    {
+        aOut->Print( 0, "%s", TO_UTF8( escapeXml( aNode->GetContent(), false ) ) );
+        return;
+    }
 
-    xroot->AddAttribute( "version", "D" );
+    aOut->Print( 0, "<%s", TO_UTF8( aNode->GetName() ) );
+
+    for( wxXmlAttribute* attr = aNode->GetAttributes(); attr; attr = attr->GetNext() )
+    {
+        aOut->Print( 0, " %s=\"%s\"", TO_UTF8( attr->GetName() ),
+                     TO_UTF8( escapeXml( attr->GetValue(), true ) ) );
+    }
+
+    if( !aNode->GetChildren() )
+    {
+        aOut->Print( 0, "/>" );
+        return;
+    }
+
+    aOut->Print( 0, ">" );
+
+    XNODE* last = nullptr;
+
+    for( XNODE* kid = aNode->GetChildren(); kid; kid = kid->GetNext() )
+    {
+        if( kid->GetType() != wxXML_TEXT_NODE )
+            aOut->Print( 0, "\n%*s", aIndent + 2, "" );
+
+        formatXml( aOut, kid, aIndent + 2 );
+        last = kid;
+    }
+
+    if( last->GetType() != wxXML_TEXT_NODE )
+        aOut->Print( 0, "\n%*s", aIndent, "" );
+
+    aOut->Print( 0, "</%s>", TO_UTF8( aNode->GetName() ) );
+}
+
+
+bool NETLIST_EXPORTER_GENERIC::WriteNetlist( const wxString& aOutFileName, unsigned aNetlistOptions )
+{
+    // Prepare list of nets generation
+    if( m_masterList )
+    {
+        for( unsigned ii = 0; ii < m_masterList->size(); ii++ )
+            m_masterList->GetItem( ii )->m_Flag = 0;
+    }
+
+    // Output the XML format netlist.  Each section is written one element at a time
+    // rather than through a wxXmlDocument, so the whole document tree never needs to
+    // exist in memory at once.
+    try
+    {
+        FILE_OUTPUTFORMATTER formatter( aOutFileName );
+        wxString             section;
+        bool                 sectionIsEmpty = true;
+
+        formatter.Print( 0, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n" );
+        formatter.Print( 0, "<export version=\"D\">" );
+
+        visitRoot( GNL_ALL,
+                [&]( const wxString& aSection )
+                {
+                    section = aSection;
+                    sectionIsEmpty = true;
+                    formatter.Print( 0, "\n  <%s", TO_UTF8( section ) );
+                },
+                [&]( XNODE* aElement )
+                {
+                    std::unique_ptr<XNODE> element( aElement );
+
+                    if( sectionIsEmpty )
+                        formatter.Print( 0, ">" );
+
+                    sectionIsEmpty = false;
+                    formatter.Print( 0, "\n    " );
+                    formatXml( &formatter, element.get(), 4 );
+                },
+                [&]()
+                {
+                    if( sectionIsEmpty )
+                        formatter.Print( 0, "/>" );
+                    else
+                        formatter.Print( 0, "\n  </%s>", TO_UTF8( section ) );
+                } );
 
+        formatter.Print( 0, "\n</export>\n" );
+    }
+    catch( const IO_ERROR& )
+    {
+        return false;
+    }
+
+    return true;
+}
+
+
+void NETLIST_EXPORTER_GENERIC::visitRoot( int aCtl,
+                                          const std::function<void( const wxString& )>& aBeginSection,
+                                          const XNODE_SINK& aElement,
+                                          const std::function<void()>& aEndSection )
+{
     if( aCtl & GNL_HEADER )
+    {
         // add the "design" header
-        xroot->AddChild( makeDesignHeader() );
+        aBeginSection( "design" );
+        visitDesignHeader( aElement );
+        aEndSection();
+    }
 
     if( aCtl & GNL_COMPONENTS )
-        xroot->AddChild( makeComponents() );
+    {
+        aBeginSection( "components" );
+        visitComponents( aElement );
+        aEndSection();
+    }
 
     if( aCtl & GNL_PARTS )
-        xroot->AddChild( makeLibParts() );
+    {
+        aBeginSection( "libparts" );
+        visitLibParts( aElement );
+        aEndSection();
+    }
 
     if( aCtl & GNL_LIBRARIES )
-        // must follow makeGenericLibParts()
-        xroot->AddChild( makeLibraries() );
+    {
+        // must follow visitLibParts()
+        aBeginSection( "libraries" );
+        visitLibraries( aElement );
+        aEndSection();
+    }
 
     if( aCtl & GNL_NETS )
-        xroot->AddChild( makeListOfNets() );
+    {
+        aBeginSection( "nets" );
+        visitNets( aElement );
+        aEndSection();
+    }
+}
+
+
+XNODE* NETLIST_EXPORTER_GENERIC::makeRoot( int aCtl )
+{
+    XNODE*      xroot = node( "export" );
+    XNODE*      xsection = nullptr;
+
+    xroot->AddAttribute( "version", "D" );
+
+    visitRoot( aCtl,
+            [&]( const wxString& aSection )
+            {
+                xroot->AddChild( xsection = node( aSection ) );
+            },
+            [&]( XNODE* aElement )
+            {
+                xsection->AddChild( aElement );
+            },
+            []() {} );
 
     return xroot;
 }
@@ -197,10 +359,8 @@ void NETLIST_EXPORTER_GENERIC::addComponentFields( XNODE* xcomp, SCH_COMPONENT*
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeComponents()
+void NETLIST_EXPORTER_GENERIC::visitComponents( const XNODE_SINK& aSink )
 {
-    XNODE*      xcomps = node( "components" );
-
     m_ReferencesAlreadyFound.Clear();
 
     SCH_SHEET_LIST sheetList( g_RootSheet );
@@ -247,7 +407,7 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeComponents()
             // under XSL processing systems which do sequential searching within
             // an element.
 
-            xcomps->AddChild( xcomp = node( "comp" ) );
+            xcomp = node( "comp" );
             xcomp->AddAttribute( "ref", comp->GetRef( &sheetList[i] ) );
 
             addComponentFields( xcomp, comp, &sheetList[i] );
@@ -272,17 +432,16 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeComponents()
             xsheetpath->AddAttribute( "names", sheetList[i].PathHumanReadable() );
             xsheetpath->AddAttribute( "tstamps", sheetList[i].PathAsString() );
             xcomp->AddChild( node( "tstamp", comp->m_Uuid.AsString() ) );
+
+            aSink( xcomp );
         }
     }
-
-    return xcomps;
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeDesignHeader()
+void NETLIST_EXPORTER_GENERIC::visitDesignHeader( const XNODE_SINK& aSink )
 {
     SCH_SCREEN* screen;
-    XNODE*     xdesign = node( "design" );
     XNODE*     xtitleBlock;
     XNODE*     xsheet;
     XNODE*     xcomment;
@@ -290,12 +449,12 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeDesignHeader()
     wxFileName sourceFileName;
 
     // the root sheet is a special sheet, call it source
-    xdesign->AddChild( node( "source", g_RootSheet->GetScreen()->GetFileName() ) );
+    aSink( node( "source", g_RootSheet->GetScreen()->GetFileName() ) );
 
-    xdesign->AddChild( node( "date", DateAndTime() ) );
+    aSink( node( "date", DateAndTime() ) );
 
     // which Eeschema tool
-    xdesign->AddChild( node( "tool", wxString( "Eeschema " ) + GetBuildVersion() ) );
+    aSink( node( "tool", wxString( "Eeschema " ) + GetBuildVersion() ) );
 
     /*
         Export the sheets information
@@ -306,7 +465,7 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeDesignHeader()
     {
         screen = sheetList[i].LastScreen();
 
-        xdesign->AddChild( xsheet = node( "sheet" ) );
+        xsheet = node( "sheet" );
 
         // get the string representation of the sheet index number.
         // Note that sheet->GetIndex() is zero index base and we need to increment the
@@ -365,16 +524,14 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeDesignHeader()
         xtitleBlock->AddChild( xcomment = node( "comment" ) );
         xcomment->AddAttribute( "number", "9" );
         xcomment->AddAttribute( "value", tb.GetComment( 8 ) );
-    }
 
-    return xdesign;
+        aSink( xsheet );
+    }
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeLibraries()
+void NETLIST_EXPORTER_GENERIC::visitLibraries( const XNODE_SINK& aSink )
 {
-    XNODE*  xlibs = node( "libraries" );     // auto_ptr
-
     for( std::set<wxString>::iterator it = m_libraries.begin(); it!=m_libraries.end();  ++it )
     {
         wxString    libNickname = *it;
@@ -382,22 +539,20 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeLibraries()
 
         if( m_libTable->HasLibrary( libNickname ) )
         {
-            xlibs->AddChild( xlibrary = node( "library" ) );
+            xlibrary = node( "library" );
             xlibrary->AddAttribute( "logical", libNickname );
             xlibrary->AddChild( node( "uri",  m_libTable->GetFullURI( libNickname ) ) );
-        }
 
-        // @todo: add more fun stuff here
-    }
+            // @todo: add more fun stuff here
 
-    return xlibs;
+            aSink( xlibrary );
+        }
+    }
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeLibParts()
+void NETLIST_EXPORTER_GENERIC::visitLibParts( const XNODE_SINK& aSink )
 {
-    XNODE*      xlibparts = node( "libparts" );   // auto_ptr
-
     LIB_PINS    pinList;
     LIB_FIELDS  fieldList;
 
@@ -412,7 +567,7 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeLibParts()
             m_libraries.insert( libNickname );  // inserts component's library if unique
 
         XNODE* xlibpart;
-        xlibparts->AddChild( xlibpart = node( "libpart" ) );
+        xlibpart = node( "libpart" );
         xlibpart->AddAttribute( "lib", libNickname );
         xlibpart->AddAttribute( "part", lcomp->GetName()  );
 
@@ -491,15 +646,14 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeLibParts()
                 // caution: construction work site here, drive slowly
             }
         }
-    }
 
-    return xlibparts;
+        aSink( xlibpart );
+    }
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets( bool aUseGraph )
+void NETLIST_EXPORTER_GENERIC::visitNets( const XNODE_SINK& aSink, bool aUseGraph )
 {
-    XNODE*      xnets = node( "nets" );      // auto_ptr if exceptions ever get used.
     wxString    netCodeTxt;
     wxString    netName;
     wxString    ref;
@@ -582,7 +736,7 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets( bool aUseGraph )
 
                 if( !added )
                 {
-                    xnets->AddChild( xnet = node( "net" ) );
+                    xnet = node( "net" );
                     netCodeTxt.Printf( "%d", code );
                     xnet->AddAttribute( "code", netCodeTxt );
                     xnet->AddAttribute( "name", net_name );
@@ -603,6 +757,9 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets( bool aUseGraph )
                     xnode->AddAttribute( "pinfunction", pinName );
 
             }
+
+            if( added )
+                aSink( xnet );
         }
     }
     else
@@ -615,6 +772,10 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets( bool aUseGraph )
             // New net found, write net id;
             if( ( netCode = nitem->GetNet() ) != lastNetCode )
             {
+                // The previous net is complete
+                if( sameNetcodeCount > 0 )
+                    aSink( xnet );
+
                 sameNetcodeCount = 0;   // item count for this net
                 netName = nitem->GetNetName();
                 lastNetCode  = netCode;
@@ -635,7 +796,7 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets( bool aUseGraph )
 
             if( ++sameNetcodeCount == 1 )
             {
-                xnets->AddChild( xnet = node( "net" ) );
+                xnet = node( "net" );
                 netCodeTxt.Printf( "%d", netCode );
                 xnet->AddAttribute( "code", netCodeTxt );
                 xnet->AddAttribute( "name", netName );
@@ -649,9 +810,10 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets( bool aUseGraph )
             if( !nitem->GetPinNameText().IsEmpty() )
                 xnode->AddAttribute( "pinfunction", nitem->GetPinNameText() );
         }
-    }
 
-    return xnets;
+        if( sameNetcodeCount > 0 )
+            aSink( xnet );
+    }
 }
 
 
@@ -33,6 +33,8 @@
 
 #include <sch_edit_frame.h>
 
+#include <functional>
+
 class CONNECTION_GRAPH;
 class SYMBOL_LIB_TABLE;
 
@@ -70,12 +72,24 @@ protected:
 public:
     NETLIST_EXPORTER_GENERIC( SCH_EDIT_FRAME* aFrame,
                               NETLIST_OBJECT_LIST* aMasterList,
-                              CONNECTION_GRAPH* aGraph = nullptr  ) :
+                              CONNECTION_GRAPH* aGraph = nullptr ) :
         NETLIST_EXPORTER( aMasterList ),
         m_libTable( aFrame->Prj().SchSymbolLibTable() ),
         m_graph( aGraph )
     {}
 
+    /**
+     * Constructor for use without a schematic editor frame, e.g. from a command line tool.
+     * @param aLibTable is the symbol library table used to resolve library URIs.
+     */
+    NETLIST_EXPORTER_GENERIC( SYMBOL_LIB_TABLE* aLibTable,
+                              NETLIST_OBJECT_LIST* aMasterList,
+                              CONNECTION_GRAPH* aGraph = nullptr ) :
+        NETLIST_EXPORTER( aMasterList ),
+        m_libTable( aLibTable ),
+        m_graph( aGraph )
+    {}
+
     /**
      * Function WriteNetlist
      * writes to specified output file
@@ -96,6 +110,22 @@ protected:
      */
     XNODE* node( const wxString& aName, const wxString& aTextualContent = wxEmptyString );
 
+    /// Receives the elements produced by the visit*() functions, one at a time.  The
+    /// receiver takes ownership of the node.
+    typedef std::function<void( XNODE* )> XNODE_SINK;
+
+    /**
+     * Function visitRoot
+     * walks the document described by makeRoot() one top level section at a time, so that
+     * exporters can write it out without building the whole tree in memory.
+     * @param aCtl - a bitset or-ed together from GNL_ENUM values
+     * @param aBeginSection is called with the name of each section before its elements.
+     * @param aElement receives each element of the current section.
+     * @param aEndSection is called once all the elements of a section have been visited.
+     */
+    void visitRoot( int aCtl, const std::function<void( const wxString& )>& aBeginSection,
+                    const XNODE_SINK& aElement, const std::function<void()>& aEndSection );
+
     /**
      * Function makeGenericRoot
      * builds the entire document tree for the generic export.  This is factored
@@ -107,39 +137,35 @@ protected:
     XNODE* makeRoot( int aCtl = GNL_ALL );
 
     /**
-     * Function makeComponents
-     * @return XNODE* - returns a sub-tree holding all the schematic components.
+     * Function visitComponents
+     * builds one "comp" node per schematic component and passes each to \a aSink.
      */
-    XNODE* makeComponents();
+    void visitComponents( const XNODE_SINK& aSink );
 
     /**
-     * Function makeDesignHeader
-     * fills out a project "design" header into an XML node.
-     * @return XNODE* - the design header
+     * Function visitDesignHeader
+     * builds the children of the project "design" header and passes each to \a aSink.
      */
-    XNODE* makeDesignHeader();
+    void visitDesignHeader( const XNODE_SINK& aSink );
 
     /**
-     * Function makeLibParts
-     * fills out an XML node with the unique library parts and returns it.
-     * @return XNODE* - the library parts nodes
+     * Function visitLibParts
+     * builds one "libpart" node per unique library part and passes each to \a aSink.
      */
-    XNODE* makeLibParts();
+    void visitLibParts( const XNODE_SINK& aSink );
 
     /**
-     * Function makeListOfNets
-     * fills out an XML node with a list of nets and returns it.
-     * @return XNODE* - the list of nets nodes
+     * Function visitNets
+     * builds one "net" node per net and passes each to \a aSink.
      */
-    XNODE* makeListOfNets( bool aUseGraph = true );
+    void visitNets( const XNODE_SINK& aSink, bool aUseGraph = true );
 
     /**
-     * Function makeLibraries
-     * fills out an XML node with a list of used libraries and returns it.
-     * Must have called makeGenericLibParts() before this function.
-     * @return XNODE* - the library nodes
+     * Function visitLibraries
+     * builds one "library" node per used library and passes each to \a aSink.
+     * Must have called visitLibParts() before this function.
      */
-    XNODE* makeLibraries();
+    void visitLibraries( const XNODE_SINK& aSink );
 
     void addComponentFields(  XNODE* xcomp, SCH_COMPONENT* comp, SCH_SHEET_PATH* aSheet );
 };
@@ -25,9 +25,9 @@
 
 
 #include <algorithm>
+#include <memory>
 #include <fctsys.h>
 #include <build_version.h>
-#include <confirm.h>
 
 #include <sch_edit_frame.h>
 #include <xnode.h>
@@ -44,9 +44,9 @@ bool NETLIST_EXPORTER_KICAD::WriteNetlist( const wxString& aOutFileName, unsigne
         Format( &formatter, GNL_ALL );
     }
 
-    catch( const IO_ERROR& ioe )
+    catch( const IO_ERROR& )
     {
-        DisplayError( NULL, ioe.What() );
+        // Reported by the caller: this exporter is also used without any GUI
         return false;
     }
 
@@ -57,10 +57,33 @@ bool NETLIST_EXPORTER_KICAD::WriteNetlist( const wxString& aOutFileName, unsigne
 void NETLIST_EXPORTER_KICAD::Format( OUTPUTFORMATTER* aOut, int aCtl )
 {
     // Prepare list of nets generation
-    for( unsigned ii = 0; ii < m_masterList->size(); ii++ )
-        m_masterList->GetItem( ii )->m_Flag = 0;
+    if( m_masterList )
+    {
+        for( unsigned ii = 0; ii < m_masterList->size(); ii++ )
+            m_masterList->GetItem( ii )->m_Flag = 0;
+    }
+
+    // Write the document of makeRoot() one element at a time, producing the same text
+    // XNODE::Format() would for the complete tree but without holding all of it in memory.
+    aOut->Print( 0, "(export (version %s)", aOut->Quotew( "D" ).c_str() );
+
+    visitRoot( aCtl,
+            [&]( const wxString& aSection )
+            {
+                aOut->Print( 0, "\n" );
+                aOut->Print( 1, "(%s", TO_UTF8( aSection ) );
+            },
+            [&]( XNODE* aElement )
+            {
+                std::unique_ptr<XNODE> element( aElement );
 
-    std::unique_ptr<XNODE> xroot( makeRoot( aCtl ) );
+                aOut->Print( 0, "\n" );
+                element->Format( aOut, 2 );
+            },
+            [&]()
+            {
+                aOut->Print( 0, ")" );
+            } );
 
-    xroot->Format( aOut, 0 );
+    aOut->Print( 0, ")" );
 }
@@ -47,37 +47,39 @@
 
 #include <invoke_sch_dialog.h>
 
-bool SCH_EDIT_FRAME::WriteNetListFile( NETLIST_OBJECT_LIST* aConnectedItemsList,
-                                       int aFormat, const wxString& aFullFileName,
+bool SCH_EDIT_FRAME::WriteNetListFile( int aFormat, const wxString& aFullFileName,
                                        unsigned aNetlistOptions, REPORTER* aReporter )
 {
-    if( aConnectedItemsList == nullptr )    // Schematic netlist not available.
-        return false;
-
     bool res = true;
     bool executeCommandLine = false;
+    bool graphExporter = true;
 
     wxString    fileName = aFullFileName;
 
     NETLIST_EXPORTER *helper;
 
+    // The kicad and generic exporters stream the nets from the connection graph, only the
+    // other formats need the flat NETLIST_OBJECT_LIST built by BuildNetListBase()
     switch( aFormat )
     {
     case NET_TYPE_PCBNEW:
-        helper = new NETLIST_EXPORTER_KICAD( this, aConnectedItemsList,
-                                             g_ConnectionGraph );
+        RecalculateConnections( NO_CLEANUP );
+        helper = new NETLIST_EXPORTER_KICAD( this, nullptr, g_ConnectionGraph );
         break;
 
     case NET_TYPE_ORCADPCB2:
-        helper = new NETLIST_EXPORTER_ORCADPCB2( aConnectedItemsList );
+        helper = new NETLIST_EXPORTER_ORCADPCB2( BuildNetListBase() );
+        graphExporter = false;
         break;
 
     case NET_TYPE_CADSTAR:
-        helper = new NETLIST_EXPORTER_CADSTAR( aConnectedItemsList );
+        helper = new NETLIST_EXPORTER_CADSTAR( BuildNetListBase() );
+        graphExporter = false;
         break;
 
     case NET_TYPE_SPICE:
-        helper = new NETLIST_EXPORTER_PSPICE( aConnectedItemsList );
+        helper = new NETLIST_EXPORTER_PSPICE( BuildNetListBase() );
+        graphExporter = false;
         break;
 
     default:
@@ -86,8 +88,8 @@ bool SCH_EDIT_FRAME::WriteNetListFile( NETLIST_OBJECT_LIST* aConnectedItemsList,
             tmpFile.SetExt( GENERIC_INTERMEDIATE_NETLIST_EXT );
             fileName = tmpFile.GetFullPath();
 
-            helper = new NETLIST_EXPORTER_GENERIC( this, aConnectedItemsList,
-                                                   g_ConnectionGraph );
+            RecalculateConnections( NO_CLEANUP );
+            helper = new NETLIST_EXPORTER_GENERIC( this, nullptr, g_ConnectionGraph );
             executeCommandLine = true;
         }
         break;
@@ -96,6 +98,17 @@ bool SCH_EDIT_FRAME::WriteNetListFile( NETLIST_OBJECT_LIST* aConnectedItemsList,
     res = helper->WriteNetlist( fileName, aNetlistOptions );
     delete helper;
 
+    // The graph based exporters leave the error reporting to their caller
+    if( !res && graphExporter )
+    {
+        wxString msg = wxString::Format( _( "Failed to create file \"%s\"" ), fileName );
+
+        if( aReporter )
+            aReporter->Report( msg, RPT_SEVERITY_ERROR );
+        else
+            DisplayError( this, msg );
+    }
+
     // If user provided a plugin command line, execute it.
     if( executeCommandLine && res && !m_netListerCommand.IsEmpty() )
     {
@@ -196,8 +209,11 @@ bool SCH_EDIT_FRAME::prepareForNetlist()
 
 void SCH_EDIT_FRAME::sendNetlistToCvpcb()
 {
-    NETLIST_OBJECT_LIST*   net_atoms = BuildNetListBase();
-    NETLIST_EXPORTER_KICAD exporter( this, net_atoms, g_ConnectionGraph );
+    // The kicad exporter works from the connection graph alone, so there is no need to
+    // build the flat NETLIST_OBJECT_LIST of BuildNetListBase() here.
+    RecalculateConnections( NO_CLEANUP );
+
+    NETLIST_EXPORTER_KICAD exporter( this, nullptr, g_ConnectionGraph );
     STRING_FORMATTER       formatter;
 
     // @todo : trim GNL_ALL down to minimum for CVPCB
@@ -208,13 +224,12 @@ void SCH_EDIT_FRAME::sendNetlistToCvpcb()
 }
 
 
-NETLIST_OBJECT_LIST* SCH_EDIT_FRAME::CreateNetlist( bool aSilent,
-                                                    bool aSilentAnnotate )
+bool SCH_EDIT_FRAME::ReadyToNetlist( bool aSilent, bool aSilentAnnotate )
 {
     if( !aSilent ) // checks for errors and invokes annotation dialog as neccessary
     {
         if( !prepareForNetlist() )
-            return nullptr;
+            return false;
     }
     else // performs similar function as prepareForNetlist but without a dialog.
     {
@@ -228,10 +243,7 @@ NETLIST_OBJECT_LIST* SCH_EDIT_FRAME::CreateNetlist( bool aSilent,
                                 NULL_REPORTER::GetInstance() );
     }
 
-    // TODO(JE) This is really going to turn into "PrepareForNetlist"
-    // when the old netlister (BuildNetListBase) is removed
-
-    return BuildNetListBase();
+    return true;
 }
 
 
@@ -87,27 +87,32 @@ std::string toUTFTildaText( const wxString& txt )
  * ENDDRAW
  * ENDDEF
  */
-static LIB_PART* dummy()
+static LIB_PART* makeDummy()
 {
-    static LIB_PART* part;
+    LIB_PART* part = new LIB_PART( wxEmptyString );
 
-    if( !part )
-    {
-        part = new LIB_PART( wxEmptyString );
+    LIB_RECTANGLE* square = new LIB_RECTANGLE( part );
 
-        LIB_RECTANGLE* square = new LIB_RECTANGLE( part );
+    square->MoveTo( wxPoint( Mils2iu( -200 ), Mils2iu( 200 ) ) );
+    square->SetEndPosition( wxPoint( Mils2iu( 200 ), Mils2iu( -200 ) ) );
 
-        square->MoveTo( wxPoint( Mils2iu( -200 ), Mils2iu( 200 ) ) );
-        square->SetEndPosition( wxPoint( Mils2iu( 200 ), Mils2iu( -200 ) ) );
+    LIB_TEXT* text = new LIB_TEXT( part );
 
-        LIB_TEXT* text = new LIB_TEXT( part );
+    text->SetTextSize( wxSize( Mils2iu( 150 ), Mils2iu( 150 ) ) );
+    text->SetText( wxString( wxT( "??" ) ) );
 
-        text->SetTextSize( wxSize( Mils2iu( 150 ), Mils2iu( 150 ) ) );
-        text->SetText( wxString( wxT( "??" ) ) );
+    part->AddDrawItem( square );
+    part->AddDrawItem( text );
+
+    return part;
+}
 
-        part->AddDrawItem( square );
-        part->AddDrawItem( text );
-    }
+
+static LIB_PART* dummy()
+{
+    // Components are added to their screen, and so measured, by the threads loading the
+    // sheets of a hierarchy.  The initialization of a local static is thread safe.
+    static LIB_PART* part = makeDummy();
 
     return part;
 }
@@ -134,7 +139,7 @@ SCH_COMPONENT::SCH_COMPONENT( LIB_PART& aPart, LIB_ID aLibId, SCH_SHEET_PATH* sh
 
     part = aPart.Flatten();
     part->SetParent();
-    m_part.reset( part.release() );
+    m_part = std::move( part );
 
     // Copy fields from the library component
     UpdateFields( true, true );
@@ -174,8 +179,8 @@ SCH_COMPONENT::SCH_COMPONENT( const SCH_COMPONENT& aComponent ) :
     m_lib_id      = aComponent.m_lib_id;
     m_isInNetlist = aComponent.m_isInNetlist;
 
-    if( aComponent.m_part )
-        m_part.reset( new LIB_PART( *aComponent.m_part.get() ) );
+    // The library symbol is never modified in place so it can be shared with the original.
+    m_part        = aComponent.m_part;
 
     const_cast<KIID&>( m_Uuid ) = aComponent.m_Uuid;
 
@@ -290,7 +295,7 @@ void SCH_COMPONENT::SetLibId( const LIB_ID& aLibId, SYMBOL_LIB_TABLE* aSymLibTab
         }
     }
 
-    m_part.reset( symbol.release() );
+    m_part = std::move( symbol );
     UpdatePins();
 }
 
@@ -325,7 +330,7 @@ bool SCH_COMPONENT::Resolve( PART_LIBS* aLibs )
     {
         std::unique_ptr< LIB_PART > flattenedPart = part->Flatten();
         flattenedPart->SetParent();
-        m_part.reset( flattenedPart.release() );
+        m_part = std::move( flattenedPart );
         UpdatePins();
         return true;
     }
@@ -379,7 +384,7 @@ bool SCH_COMPONENT::Resolve( SYMBOL_LIB_TABLE& aLibTable, PART_LIB* aCacheLib )
 
         if( part )
         {
-            m_part.reset( part.release() );
+            m_part = std::move( part );
             UpdatePins();
             return true;
         }
@@ -415,8 +420,8 @@ static bool sort_by_libid( const SCH_COMPONENT* ref, SCH_COMPONENT* cmp )
 }
 
 
-void SCH_COMPONENT::ResolveAll(
-        std::vector<SCH_COMPONENT*>& aComponents, SYMBOL_LIB_TABLE& aLibTable, PART_LIB* aCacheLib )
+void SCH_COMPONENT::ResolveAll( std::vector<SCH_COMPONENT*>& aComponents,
+        SYMBOL_LIB_TABLE& aLibTable, PART_LIB* aCacheLib, SHARED_LIB_PARTS* aResolved )
 {
     // sort it by lib part. Cmp will be grouped by same lib part.
     std::sort( aComponents.begin(), aComponents.end(), sort_by_libid );
@@ -427,10 +432,19 @@ void SCH_COMPONENT::ResolveAll(
     {
         SCH_COMPONENT* cmp = aComponents[ii];
         curr_libid = cmp->m_lib_id;
-        cmp->Resolve( aLibTable, aCacheLib );
+
+        if( aResolved && aResolved->count( curr_libid ) )
+        {
+            cmp->m_part = ( *aResolved )[ curr_libid ];
+        }
+        else if( cmp->Resolve( aLibTable, aCacheLib ) && aResolved )
+        {
+            ( *aResolved )[ curr_libid ] = cmp->m_part;
+        }
+
         cmp->UpdatePins();
 
-        // Propagate the m_part pointer to other members using the same lib_id
+        // Share the m_part pointer with other members using the same lib_id
         for( unsigned jj = ii + 1; jj < aComponents.size(); ++jj )
         {
             SCH_COMPONENT* next_cmp = aComponents[jj];
@@ -439,7 +453,7 @@ void SCH_COMPONENT::ResolveAll(
                 break;
 
             if( cmp->m_part )
-                next_cmp->m_part.reset( new LIB_PART( *cmp->m_part.get() ) );
+                next_cmp->m_part = cmp->m_part;
 
             next_cmp->UpdatePins();
 
@@ -449,6 +463,20 @@ void SCH_COMPONENT::ResolveAll(
 }
 
 
+LIB_PART* SCH_COMPONENT::GetPartForEdit()
+{
+    if( m_part && m_part.use_count() > 1 )
+    {
+        m_part = std::make_shared<LIB_PART>( *m_part );
+
+        // The pin caches refer to the pins of the shared library symbol.
+        UpdatePins();
+    }
+
+    return m_part.get();
+}
+
+
 void SCH_COMPONENT::UpdatePins()
 {
     m_pins.clear();
@@ -904,10 +932,8 @@ void SCH_COMPONENT::SwapData( SCH_ITEM* aItem )
 
     std::swap( m_lib_id, component->m_lib_id );
 
-    LIB_PART* part = component->m_part.release();
-    component->m_part.reset( m_part.release() );
+    std::swap( m_part, component->m_part );
     component->UpdatePins();
-    m_part.reset( part );
     UpdatePins();
 
     std::swap( m_Pos, component->m_Pos );
@@ -1737,9 +1763,7 @@ SCH_COMPONENT& SCH_COMPONENT::operator=( const SCH_ITEM& aItem )
 
         m_lib_id    = c->m_lib_id;
 
-        LIB_PART* libSymbol = c->m_part ? new LIB_PART( *c->m_part.get() ) : nullptr;
-
-        m_part.reset( libSymbol );
+        m_part      = c->m_part;
         m_Pos       = c->m_Pos;
         m_unit      = c->m_unit;
         m_convert   = c->m_convert;
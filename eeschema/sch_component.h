@@ -119,7 +119,9 @@ private:
     SCH_FIELDS  m_Fields;       ///< Variable length list of fields.
 
     ///< A flattened copy of a LIB_PART found in the PROJECT's libraries to for this component.
-    std::unique_ptr< LIB_PART > m_part;
+    ///< It is shared with every other component placed from the same library symbol so it
+    ///< must never be modified in place.  Use GetPartForEdit() to get a private copy.
+    std::shared_ptr< LIB_PART > m_part;
 
     SCH_PINS    m_pins;         ///< a SCH_PIN for every LIB_PIN (across all units)
     SCH_PIN_MAP m_pinMap;       ///< the component's pins mapped by LIB_PIN*
@@ -204,7 +206,17 @@ public:
 
     const LIB_ID& GetLibId() const        { return m_lib_id; }
 
-    std::unique_ptr< LIB_PART >& GetPartRef() { return m_part; }
+    std::shared_ptr< LIB_PART >& GetPartRef() { return m_part; }
+
+    /**
+     * Return the library symbol of this component for modification.
+     *
+     * The library symbol is shared with the other components placed from the same symbol,
+     * so it is copied before being returned if anyone else holds a reference to it.
+     *
+     * @return the library symbol owned only by this component or NULL if it was not resolved.
+     */
+    LIB_PART* GetPartForEdit();
 
     /**
      * Return information about the aliased parts
@@ -225,8 +237,21 @@ public:
 
     bool Resolve( SYMBOL_LIB_TABLE& aLibTable, PART_LIB* aCacheLib = NULL );
 
+    /**
+     * Resolve the library symbol of each component in \a aComponents.
+     *
+     * Components placed from the same library symbol share a single flattened copy of it.
+     *
+     * @param aComponents are the components to resolve.
+     * @param aLibTable is the symbol library table to load the library symbols from.
+     * @param aCacheLib is the fall back cache library.
+     * @param aResolved is an optional map of the library symbols already resolved.  When
+     *                  provided, symbols found in it are reused rather than loaded again and
+     *                  newly resolved symbols are added to it so they can be shared across
+     *                  several calls.
+     */
     static void ResolveAll( std::vector<SCH_COMPONENT*>& aComponents, SYMBOL_LIB_TABLE& aLibTable,
-            PART_LIB* aCacheLib = NULL );
+            PART_LIB* aCacheLib = NULL, SHARED_LIB_PARTS* aResolved = nullptr );
 
     int GetUnit() const { return m_unit; }
 
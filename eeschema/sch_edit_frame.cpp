@@ -609,7 +609,7 @@ void SCH_EDIT_FRAME::OnModify()
     GetScreen()->SetSave();
 
     if( ADVANCED_CFG::GetCfg().m_realTimeConnectivity && CONNECTION_GRAPH::m_allowRealTime )
-        RecalculateConnections( NO_CLEANUP );
+        RecalculateConnections( NO_CLEANUP, true );
 
     GetCanvas()->Refresh();
 }
@@ -1088,7 +1088,7 @@ int SCH_EDIT_FRAME::GetSeverity( int aErrorCode ) const
 }
 
 
-void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags )
+void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags, bool aIncremental )
 {
     SCH_SHEET_LIST list( g_RootSheet );
     PROF_COUNTER   timer;
@@ -1107,7 +1107,7 @@ void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags )
     timer.Stop();
     wxLogTrace( "CONN_PROFILE", "SchematicCleanUp() %0.4f ms", timer.msecs() );
 
-    g_ConnectionGraph->Recalculate( list, true );
+    g_ConnectionGraph->Recalculate( list, !aIncremental || aCleanupFlags != NO_CLEANUP );
 }
 
 
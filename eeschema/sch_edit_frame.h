@@ -405,23 +405,23 @@ public:
     NETLIST_OBJECT_LIST* BuildNetListBase( bool updateStatusText = true );
 
     /**
-     * Create a netlist for the current schematic.
+     * Check if we are ready to write a netlist file for the current schematic.
      *
      * - Test for some issues (missing or duplicate references and sheet names)
-     * - Build netlist info
-     * - Create the netlist file (different formats)
+     * - Update the symbol library links and the power symbol references
      *
      * @param aSilent is true if annotation error dialog should be skipped
      * @param aSilentAnnotate is true if components should be reannotated silently
-     * @returns a unique_ptr to the netlist
+     * @return true if the netlist can be written
      */
-    NETLIST_OBJECT_LIST* CreateNetlist( bool aSilent = false,
-                                        bool aSilentAnnotate = false );
+    bool ReadyToNetlist( bool aSilent = false, bool aSilentAnnotate = false );
 
     /**
      * Create a netlist file.
      *
-     * @param aConnectedItemsList = the initialized list of connected items, take ownership.
+     * The connectivity is recalculated first.  The flat list of connected items is only
+     * built for the formats that need it (OrcadPCB2, Cadstar and Spice).
+     *
      * @param aFormat = netlist format (NET_TYPE_PCBNEW ...)
      * @param aFullFileName = full netlist file name
      * @param aNetlistOptions = netlist options using OR'ed bits.
@@ -435,8 +435,7 @@ public:
      *          mainly if a command line must be run (can be NULL
      * @return true if success.
      */
-    bool WriteNetListFile( NETLIST_OBJECT_LIST* aConnectedItemsList,
-                           int             aFormat,
+    bool WriteNetListFile( int             aFormat,
                            const wxString& aFullFileName,
                            unsigned        aNetlistOptions,
                            REPORTER*       aReporter = NULL );
@@ -992,8 +991,13 @@ public:
 
     /**
      * Generates the connection data for the entire schematic hierarchy.
+     *
+     * @param aCleanupFlags tells which sheets have to be cleaned up first.
+     * @param aIncremental only rebuilds the item connectivity of the sheets that have
+     *                     changed (used for real-time connectivity).  Ignored when cleaning up,
+     *                     since the clean up may change items behind the back of the graph.
      */
-    void RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags );
+    void RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags, bool aIncremental = false );
 
     /**
      * Allows Eeschema to install its preferences panels into the preferences dialog.
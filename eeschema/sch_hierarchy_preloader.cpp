@@ -0,0 +1,199 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <wx/filename.h>
+
+#include <sch_hierarchy_preloader.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <template_fieldnames.h>
+
+
+SCH_HIERARCHY_PRELOADER::SCH_HIERARCHY_PRELOADER( KIWAY* aKiway, SCH_SHEET* aRootSheet,
+                                                  LOADER aLoader,
+                                                  const wxString& aSheetFileExt ) :
+        m_kiway( aKiway ),
+        m_rootSheet( aRootSheet ),
+        m_loader( aLoader ),
+        m_sheetFileExt( aSheetFileExt )
+{
+}
+
+
+SCH_HIERARCHY_PRELOADER::~SCH_HIERARCHY_PRELOADER()
+{
+    // Defined here, where SCH_SCREEN is complete, to delete the screens which were not taken
+}
+
+
+wxString SCH_HIERARCHY_PRELOADER::GetSheetFileName( const SCH_SHEET* aSheet,
+                                                    const wxString& aPath ) const
+{
+    wxFileName fileName = aSheet->GetFileName();
+
+    if( !m_sheetFileExt.IsEmpty() )
+        fileName.SetExt( m_sheetFileExt );
+
+    if( !fileName.IsAbsolute() )
+        fileName.MakeAbsolute( aPath );
+
+    return fileName.GetFullPath();
+}
+
+
+std::vector<wxString> SCH_HIERARCHY_PRELOADER::loadFile( const wxString& aFileName,
+                                                         LOADED_FILE& aFile )
+{
+    std::vector<wxString> sheetFiles;
+
+    try
+    {
+        aFile.m_screen.reset( new SCH_SCREEN( m_kiway ) );
+        aFile.m_screen->SetFileName( aFileName );
+
+        m_loader( aFileName, aFile.m_screen.get() );
+    }
+    catch( ... )
+    {
+        // Reported when the screen is attached to its sheet, like when loading sequentially
+        aFile.m_error = std::current_exception();
+    }
+
+    // Sheets are resolved from the path of the file which contains them
+    if( aFile.m_screen )
+    {
+        wxString path = wxFileName( aFileName ).GetPath();
+
+        for( SCH_ITEM* item : aFile.m_screen->Items().OfType( SCH_SHEET_T ) )
+            sheetFiles.push_back( GetSheetFileName( static_cast<SCH_SHEET*>( item ), path ) );
+    }
+
+    return sheetFiles;
+}
+
+
+void SCH_HIERARCHY_PRELOADER::Load( SCH_SHEET* aSheet, const wxString& aPath )
+{
+    if( aSheet->GetScreen() )
+        return;
+
+    // The default field names are cached on their first use, which must not happen
+    // concurrently
+    TEMPLATE_FIELDNAME::GetDefaultFieldName( 0 );
+    SCH_SHEET::GetDefaultFieldName( 0 );
+
+    std::mutex              lock;
+    std::condition_variable changed;
+    std::deque<wxString>    queue;
+    int                     loading = 0;
+
+    // Files already in the hierarchy are shared rather than loaded again.  The hierarchy is
+    // not modified until the screens are taken, so it can be searched from all the threads.
+    auto isLoaded =
+            [&]( const wxString& aFileName )
+            {
+                SCH_SCREEN* screen = nullptr;
+
+                return m_files.count( aFileName )
+                        || m_rootSheet->SearchHierarchy( aFileName, &screen );
+            };
+
+    wxString rootFile = GetSheetFileName( aSheet, aPath );
+
+    if( isLoaded( rootFile ) )
+        return;
+
+    m_files[ rootFile ];
+    queue.push_back( rootFile );
+
+    auto loadFiles =
+            [&]()
+            {
+                std::unique_lock<std::mutex> guard( lock );
+
+                while( true )
+                {
+                    changed.wait( guard, [&]() { return !queue.empty() || loading == 0; } );
+
+                    // Nothing left to load, and no file being loaded could add one
+                    if( queue.empty() )
+                        return;
+
+                    wxString fileName = queue.front();
+                    queue.pop_front();
+
+                    // std::map nodes are not moved when files are added by other threads
+                    LOADED_FILE& file = m_files[ fileName ];
+                    loading++;
+
+                    guard.unlock();
+                    std::vector<wxString> sheetFiles = loadFile( fileName, file );
+                    guard.lock();
+
+                    loading--;
+
+                    for( const wxString& sheetFile : sheetFiles )
+                    {
+                        if( !isLoaded( sheetFile ) )
+                        {
+                            m_files[ sheetFile ];
+                            queue.push_back( sheetFile );
+                        }
+                    }
+
+                    changed.notify_all();
+                }
+            };
+
+    size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+    std::vector<std::future<void>> returns( parallelThreadCount );
+
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        returns[ii] = std::async( std::launch::async, loadFiles );
+
+    for( auto& retval : returns )
+        retval.wait();
+}
+
+
+SCH_SCREEN* SCH_HIERARCHY_PRELOADER::TakeScreen( const wxString& aFileName )
+{
+    LOADED_FILE& file = m_files[ aFileName ];
+
+    if( !file.m_screen )
+        loadFile( aFileName, file );
+
+    return file.m_screen.release();
+}
+
+
+void SCH_HIERARCHY_PRELOADER::ThrowLoadError( const wxString& aFileName ) const
+{
+    auto it = m_files.find( aFileName );
+
+    if( it != m_files.end() && it->second.m_error )
+        std::rethrow_exception( it->second.m_error );
+}
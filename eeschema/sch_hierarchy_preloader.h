@@ -0,0 +1,111 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCH_HIERARCHY_PRELOADER_H
+#define SCH_HIERARCHY_PRELOADER_H
+
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <wx/string.h>
+
+
+class KIWAY;
+class SCH_SCREEN;
+class SCH_SHEET;
+
+
+/**
+ * Loads the files of a schematic hierarchy concurrently for the schematic plugins.
+ *
+ * Each file is parsed into its own SCH_SCREEN, and the sheet files it references are queued
+ * as soon as it is parsed, so a hierarchy takes about as long as its slowest branch to load
+ * rather than the sum of its files.  The plugin then walks the hierarchy as before and
+ * attaches the screens to the sheets with TakeScreen(), which is where the screens shared by
+ * several sheets are resolved.
+ */
+class SCH_HIERARCHY_PRELOADER
+{
+public:
+    /**
+     * Parses a file into a screen.  It is called from several threads at once, and throws
+     * IO_ERROR if the file cannot be loaded.
+     */
+    typedef std::function<void( const wxString& aFileName, SCH_SCREEN* aScreen )> LOADER;
+
+    /**
+     * @param aKiway is the KIWAY of the screens.
+     * @param aRootSheet is the root of the hierarchy being loaded.  Files already loaded in
+     *                   its hierarchy are not loaded again.
+     * @param aLoader parses a file.
+     * @param aSheetFileExt is the extension forced on the sheet file names, or empty to use
+     *                      the file names as they are.
+     */
+    SCH_HIERARCHY_PRELOADER( KIWAY* aKiway, SCH_SHEET* aRootSheet, LOADER aLoader,
+                             const wxString& aSheetFileExt = wxEmptyString );
+
+    ~SCH_HIERARCHY_PRELOADER();
+
+    /**
+     * Load the file of \a aSheet, if it has no screen yet, and all the sheet files below it.
+     *
+     * @param aPath is the path relative sheet file names are resolved from.
+     */
+    void Load( SCH_SHEET* aSheet, const wxString& aPath );
+
+    /**
+     * Return the full file name of the file of \a aSheet, resolved from \a aPath.
+     */
+    wxString GetSheetFileName( const SCH_SHEET* aSheet, const wxString& aPath ) const;
+
+    /**
+     * Return the screen loaded from \a aFileName, with the file name set.  The caller takes
+     * the ownership of the screen.  If the file was not loaded by Load(), it is loaded now.
+     * If the file could not be loaded, the screen contains what could be loaded and
+     * ThrowLoadError() throws the error.
+     */
+    SCH_SCREEN* TakeScreen( const wxString& aFileName );
+
+    /**
+     * Throw the error which occurred loading \a aFileName, if any.
+     */
+    void ThrowLoadError( const wxString& aFileName ) const;
+
+private:
+    struct LOADED_FILE
+    {
+        std::unique_ptr<SCH_SCREEN> m_screen;
+        std::exception_ptr          m_error;
+    };
+
+    /// Load aFileName into aFile, and return the full file names of its sheets
+    std::vector<wxString> loadFile( const wxString& aFileName, LOADED_FILE& aFile );
+
+    KIWAY*                          m_kiway;
+    SCH_SHEET*                      m_rootSheet;
+    LOADER                          m_loader;
+    wxString                        m_sheetFileExt;
+
+    std::map<wxString, LOADED_FILE> m_files;       ///< The files loaded, by full file name
+};
+
+#endif  // SCH_HIERARCHY_PRELOADER_H
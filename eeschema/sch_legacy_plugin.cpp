@@ -21,6 +21,7 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <boost/algorithm/string/join.hpp>
 #include <cctype>
 #include <set>
@@ -51,6 +52,7 @@
 #include <sch_bitmap.h>
 #include <bus_alias.h>
 #include <sch_legacy_plugin.h>
+#include <sch_hierarchy_preloader.h>
 #include <template_fieldnames.h>
 #include <sch_screen.h>
 #include <class_libentry.h>
@@ -579,10 +581,12 @@ void SCH_LEGACY_PLUGIN::init( KIWAY* aKiway, const PROPERTIES* aProperties )
 {
     m_version = 0;
     m_rootSheet = NULL;
+    m_rootModified = false;
     m_props = aProperties;
     m_kiway = aKiway;
     m_cache = NULL;
     m_out = NULL;
+    m_preloader = NULL;
 }
 
 
@@ -633,7 +637,7 @@ SCH_SHEET* SCH_LEGACY_PLUGIN::Load( const wxString& aFileName, KIWAY* aKiway,
         std::unique_ptr< SCH_SHEET > newSheet( new SCH_SHEET );
         newSheet->SetFileName( aFileName );
         m_rootSheet = newSheet.get();
-        loadHierarchy( newSheet.get() );
+        loadRootHierarchy( newSheet.get() );
 
         // If we got here, the schematic loaded successfully.
         sheet = newSheet.release();
@@ -643,7 +647,7 @@ SCH_SHEET* SCH_LEGACY_PLUGIN::Load( const wxString& aFileName, KIWAY* aKiway,
         m_rootSheet = aAppendToMe->GetRootSheet();
         wxASSERT( m_rootSheet );
         sheet = aAppendToMe;
-        loadHierarchy( sheet );
+        loadRootHierarchy( sheet );
     }
 
     wxASSERT( m_currentPath.size() == 1 );  // only the project path should remain
@@ -652,6 +656,59 @@ SCH_SHEET* SCH_LEGACY_PLUGIN::Load( const wxString& aFileName, KIWAY* aKiway,
 }
 
 
+void SCH_LEGACY_PLUGIN::loadRootHierarchy( SCH_SHEET* aSheet )
+{
+    std::atomic<bool> rootModified( false );
+
+    // Parse all the files of the hierarchy concurrently, then attach them to their sheets.
+    // Each file is parsed by its own plugin, which holds the version of the file.
+    SCH_HIERARCHY_PRELOADER preloader( m_kiway, m_rootSheet,
+            [&]( const wxString& aFileName, SCH_SCREEN* aScreen )
+            {
+                SCH_LEGACY_PLUGIN fileLoader;
+
+                fileLoader.init( m_kiway, m_props );
+                fileLoader.m_rootSheet = m_rootSheet;
+
+                try
+                {
+                    fileLoader.loadFile( aFileName, aScreen );
+                }
+                catch( ... )
+                {
+                    if( fileLoader.m_rootModified )
+                        rootModified = true;
+
+                    throw;
+                }
+
+                if( fileLoader.m_rootModified )
+                    rootModified = true;
+            },
+            wxT( "sch" ) );
+
+    preloader.Load( aSheet, m_currentPath.top() );
+
+    m_preloader = &preloader;
+
+    try
+    {
+        loadHierarchy( aSheet );
+    }
+    catch( ... )
+    {
+        m_preloader = NULL;
+        throw;
+    }
+
+    m_preloader = NULL;
+
+    // Set the file as modified so the user can be warned of the fixes made while loading.
+    if( rootModified && m_rootSheet->GetScreen() )
+        m_rootSheet->GetScreen()->SetModify();
+}
+
+
 // Everything below this comment is recursive.  Modify with care.
 
 void SCH_LEGACY_PLUGIN::loadHierarchy( SCH_SHEET* aSheet )
@@ -687,12 +744,12 @@ void SCH_LEGACY_PLUGIN::loadHierarchy( SCH_SHEET* aSheet )
         }
         else
         {
-            aSheet->SetScreen( new SCH_SCREEN( m_kiway ) );
-            aSheet->GetScreen()->SetFileName( fileName.GetFullPath() );
+            // The file was already parsed by the preloader
+            aSheet->SetScreen( m_preloader->TakeScreen( fileName.GetFullPath() ) );
 
             try
             {
-                loadFile( fileName.GetFullPath(), aSheet->GetScreen() );
+                m_preloader->ThrowLoadError( fileName.GetFullPath() );
             }
             catch( const IO_ERROR& ioe )
             {
@@ -736,7 +793,7 @@ void SCH_LEGACY_PLUGIN::loadFile( const wxString& aFileName, SCH_SCREEN* aScreen
 
     loadHeader( reader, aScreen );
 
-    LoadContent( reader, aScreen, m_version );
+    loadContent( reader, aScreen );
 
     // Unfortunately schematic files prior to version 2 are not terminated with $EndSCHEMATC
     // so checking for it's existance will fail so just exit here and take our chances. :(
@@ -762,6 +819,18 @@ void SCH_LEGACY_PLUGIN::LoadContent( LINE_READER& aReader, SCH_SCREEN* aScreen,
     if( m_rootSheet == nullptr )
         m_rootSheet = g_RootSheet;
 
+    m_rootModified = false;
+
+    loadContent( aReader, aScreen );
+
+    // Set the file as modified so the user can be warned.
+    if( m_rootModified && m_rootSheet->GetScreen() )
+        m_rootSheet->GetScreen()->SetModify();
+}
+
+
+void SCH_LEGACY_PLUGIN::loadContent( LINE_READER& aReader, SCH_SCREEN* aScreen )
+{
     while( aReader.ReadLine() )
     {
         char* line = aReader.Line();
@@ -1548,8 +1617,7 @@ SCH_COMPONENT* SCH_LEGACY_PLUGIN::loadComponent( LINE_READER& aReader )
                 unit = 1;
 
                 // Set the file as modified so the user can be warned.
-                if( m_rootSheet->GetScreen() )
-                    m_rootSheet->GetScreen()->SetModify();
+                m_rootModified = true;
             }
 
             component->SetUnit( unit );
@@ -1562,8 +1630,7 @@ SCH_COMPONENT* SCH_LEGACY_PLUGIN::loadComponent( LINE_READER& aReader )
                 convert = 1;
 
                 // Set the file as modified so the user can be warned.
-                if( m_rootSheet->GetScreen() )
-                    m_rootSheet->GetScreen()->SetModify();
+                m_rootModified = true;
             }
 
             component->SetConvert( convert );
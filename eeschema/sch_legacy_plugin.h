@@ -33,6 +33,7 @@ class KIWAY;
 class LINE_READER;
 class SCH_SCREEN;
 class SCH_SHEET;
+class SCH_HIERARCHY_PRELOADER;
 class SCH_BITMAP;
 class SCH_JUNCTION;
 class SCH_NO_CONNECT;
@@ -139,10 +140,12 @@ public:
     static void FormatPart( LIB_PART* aPart, OUTPUTFORMATTER& aFormatter );
 
 private:
+    void loadRootHierarchy( SCH_SHEET* aSheet );
     void loadHierarchy( SCH_SHEET* aSheet );
     void loadHeader( LINE_READER& aReader, SCH_SCREEN* aScreen );
     void loadPageSettings( LINE_READER& aReader, SCH_SCREEN* aScreen );
     void loadFile( const wxString& aFileName, SCH_SCREEN* aScreen );
+    void loadContent( LINE_READER& aReader, SCH_SCREEN* aScreen );
     SCH_SHEET* loadSheet( LINE_READER& aReader );
     SCH_BITMAP* loadBitmap( LINE_READER& aReader );
     SCH_JUNCTION* loadJunction( LINE_READER& aReader );
@@ -179,9 +182,13 @@ protected:
     const PROPERTIES*    m_props;      ///< Passed via Save() or Load(), no ownership, may be nullptr.
     KIWAY*               m_kiway;      ///< Required for path to legacy component libraries.
     SCH_SHEET*           m_rootSheet;  ///< The root sheet of the schematic being loaded..
+    bool                 m_rootModified; ///< Set when the loaded file had to be fixed.
     OUTPUTFORMATTER*     m_out;        ///< The output formatter for saving SCH_SCREEN objects.
     SCH_LEGACY_PLUGIN_CACHE* m_cache;
 
+    /// The files of the hierarchy loaded by Load(), no ownership, only valid during Load().
+    SCH_HIERARCHY_PRELOADER* m_preloader;
+
     /// initialize PLUGIN like a constructor would.
     void init( KIWAY* aKiway, const PROPERTIES* aProperties = nullptr );
 };
@@ -372,6 +372,12 @@ float SCH_PAINTER::getTextThickness( const LIB_TEXT* aItem, bool aDrawingShadows
 
 void SCH_PAINTER::strokeText( const wxString& aText, const VECTOR2D& aPosition, double aAngle )
 {
+    const VECTOR2D& glyphSize = m_gal->GetGlyphSize();
+
+    // Rough extent of the text: a glyph cell for every character
+    if( isCulled( std::max( glyphSize.y, glyphSize.x * aText.Length() ) ) )
+        return;
+
     m_gal->StrokeText( aText, aPosition, aAngle );
 }
 
@@ -422,16 +422,6 @@ public:
         sort( flatList.begin(), flatList.end(), sortByReferenceOnly );
     }
 
-    /**
-     * searches the sorted list of components for a another component with the same
-     * reference and a given part unit.  Use this method to manage components with
-     * multiple parts per package.
-     * @param aIndex = index in aComponentsList for of given SCH_REFERENCE item to test.
-     * @param aUnit = the given unit number to search
-     * @return index in aComponentsList if found or -1 if not found
-     */
-    int FindUnit( size_t aIndex, int aUnit );
-
     /**
      * @brief Searches unit with designated path
      * @param aPath path to search
@@ -439,16 +429,6 @@ public:
      */
     int FindRefByPath( const wxString& aPath ) const;
 
-    /**
-     * Function GetRefsInUse
-     * adds all the reference designator numbers greater than \a aMinRefId to \a aIdList
-     * skipping the reference at \a aIndex.
-     * @param aIndex = the current component index to use for reference prefix filtering.
-     * @param aIdList = the buffer to fill
-     * @param aMinRefId = the min id value to store. all values < aMinRefId are ignored
-     */
-    void GetRefsInUse( int aIndex, std::vector< int >& aIdList, int aMinRefId );
-
     /**
      * Function GetLastReference
      * returns the last used (greatest) reference number in the reference list
@@ -503,19 +483,6 @@ private:
 
     static bool sortByReferenceOnly( const SCH_REFERENCE& item1, const SCH_REFERENCE& item2 );
 
-    /**
-     * Function CreateFirstFreeRefId
-     * searches for the first free reference number in \a aListId of reference numbers in use.
-     * This function just searches for a hole in a list of incremented numbers, this list must
-     * be sorted by increasing values and each value can be stored only once.  The new value
-     * is added to the list.
-     * @see BuildRefIdInUseList to prepare this list
-     * @param aIdList The buffer that contains the reference numbers in use.
-     * @param aFirstValue The first expected free value
-     * @return The first free (not yet used) value.
-     */
-    int CreateFirstFreeRefId( std::vector<int>& aIdList, int aFirstValue );
-
     // Used for sorting static sortByTimeStamp function
     friend class BACK_ANNOTATE;
 };
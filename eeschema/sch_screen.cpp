@@ -481,7 +481,7 @@ bool SCH_SCREEN::IsTerminalPoint( const wxPoint& aPosition, int aLayer )
 }
 
 
-void SCH_SCREEN::UpdateSymbolLinks( bool aForce )
+void SCH_SCREEN::UpdateSymbolLinks( bool aForce, SHARED_LIB_PARTS* aResolved )
 {
     // Initialize or reinitialize the pointer to the LIB_PART for each component
     // found in m_drawList, but only if needed (change in lib or schematic)
@@ -501,7 +501,8 @@ void SCH_SCREEN::UpdateSymbolLinks( bool aForce )
         // Must we resolve?
         if( (m_modification_sync != mod_hash) || aForce )
         {
-            SCH_COMPONENT::ResolveAll( cmps, *libs, Prj().SchLibs()->GetCacheLibrary() );
+            SCH_COMPONENT::ResolveAll( cmps, *libs, Prj().SchLibs()->GetCacheLibrary(),
+                                       aResolved );
 
             m_modification_sync = mod_hash;     // note the last mod_hash
         }
@@ -769,18 +770,107 @@ void SCH_SCREEN::GetHierarchicalItems( EDA_ITEMS& aItems )
 }
 
 
-bool SCH_SCREEN::TestDanglingEnds( const SCH_SHEET_PATH* aPath )
+bool SCH_SCREEN::TestDanglingEnds( const SCH_SHEET_PATH* aPath,
+                                   std::function<void( SCH_ITEM* )> aChangedHandler )
 {
-    std::vector< DANGLING_END_ITEM > endPoints;
-    bool hasStateChanged = false;
+    std::vector<SCH_ITEM*>          items;
+    std::vector<DANGLING_END_ITEM>  endPoints;
+    std::vector<size_t>             firstEndPoint;  // index of the first end point of each item
+    bool                            hasStateChanged = false;
 
     for( SCH_ITEM* item : Items() )
+    {
+        items.push_back( item );
+        firstEndPoint.push_back( endPoints.size() );
         item->GetEndPoints( endPoints );
+    }
 
-    for( SCH_ITEM* item : Items() )
+    firstEndPoint.push_back( endPoints.size() );
+
+    // Labels and bus entries connect anywhere along wires and buses, so segments are bucketed
+    // in a coarse grid, as start/end pairs (UpdateDanglingState() expects them that way).
+    // Any other end point can only connect to the end points at the same position.
+    const int cellSize = Mils2iu( 1000 );
+
+    auto cellOf = [cellSize]( int aCoord ) -> int
     {
-        if( item->UpdateDanglingState( endPoints, aPath ) )
+        return ( aCoord >= 0 ? aCoord : aCoord - cellSize + 1 ) / cellSize;
+    };
+
+    std::unordered_map<wxPoint, std::vector<size_t>> pointIndex;
+    std::unordered_map<wxPoint, std::vector<size_t>> segmentIndex;
+
+    for( size_t ii = 0; ii < endPoints.size(); ++ii )
+    {
+        DANGLING_END_T type = endPoints[ii].GetType();
+
+        if( ( type == WIRE_START_END || type == BUS_START_END ) && ii + 1 < endPoints.size() )
+        {
+            const wxPoint& start = endPoints[ii].GetPosition();
+            const wxPoint& end = endPoints[ii + 1].GetPosition();
+
+            // Labels are hit tested on segments with an accuracy of 1
+            int xmin = cellOf( std::min( start.x, end.x ) - 1 );
+            int xmax = cellOf( std::max( start.x, end.x ) + 1 );
+            int ymin = cellOf( std::min( start.y, end.y ) - 1 );
+            int ymax = cellOf( std::max( start.y, end.y ) + 1 );
+
+            for( int x = xmin; x <= xmax; ++x )
+            {
+                for( int y = ymin; y <= ymax; ++y )
+                    segmentIndex[ wxPoint( x, y ) ].push_back( ii );
+            }
+
+            ++ii;   // the end point of the segment
+        }
+        else
+        {
+            pointIndex[ endPoints[ii].GetPosition() ].push_back( ii );
+        }
+    }
+
+    std::vector<size_t>            candidates;
+    std::vector<DANGLING_END_ITEM> itemEndPoints;
+
+    for( size_t ii = 0; ii < items.size(); ++ii )
+    {
+        candidates.clear();
+        itemEndPoints.clear();
+
+        for( size_t jj = firstEndPoint[ii]; jj < firstEndPoint[ii + 1]; ++jj )
+        {
+            const wxPoint& pos = endPoints[jj].GetPosition();
+            auto points = pointIndex.find( pos );
+
+            if( points != pointIndex.end() )
+                candidates.insert( candidates.end(), points->second.begin(), points->second.end() );
+
+            auto segments = segmentIndex.find( wxPoint( cellOf( pos.x ), cellOf( pos.y ) ) );
+
+            if( segments != segmentIndex.end() )
+            {
+                for( size_t segment : segments->second )
+                {
+                    candidates.push_back( segment );
+                    candidates.push_back( segment + 1 );
+                }
+            }
+        }
+
+        // Keep the order of the screen, the end points of a segment stay next to each other
+        std::sort( candidates.begin(), candidates.end() );
+        candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+
+        for( size_t candidate : candidates )
+            itemEndPoints.push_back( endPoints[candidate] );
+
+        if( items[ii]->UpdateDanglingState( itemEndPoints, aPath ) )
+        {
+            if( aChangedHandler )
+                aChangedHandler( items[ii] );
+
             hasStateChanged = true;
+        }
     }
 
     return hasStateChanged;
@@ -1145,13 +1235,15 @@ void SCH_SCREENS::DeleteAllMarkers( enum MARKER_BASE::TYPEMARKER aMarkerType )
 
 void SCH_SCREENS::UpdateSymbolLinks( bool aForce )
 {
+    // Components placed from the same library symbol share it across all of the sheets.
+    SHARED_LIB_PARTS resolved;
+
     for( SCH_SCREEN* screen = GetFirst(); screen; screen = GetNext() )
-        screen->UpdateSymbolLinks( aForce );
+        screen->UpdateSymbolLinks( aForce, &resolved );
 
     SCH_SHEET_LIST sheets( g_RootSheet );
 
-    // All of the library symbols have been replaced with copies so the connection graph
-    // pointer are stale.
+    // All of the library symbols have been replaced so the connection graph pointer are stale.
     if( g_ConnectionGraph )
         g_ConnectionGraph->Recalculate( sheets, true );
 }
@@ -25,6 +25,8 @@
 #ifndef SCREEN_H
 #define SCREEN_H
 
+#include <functional>
+#include <map>
 #include <memory>
 #include <stddef.h>
 #include <unordered_set>
@@ -51,6 +53,7 @@
 
 class BUS_ALIAS;
 
+class LIB_PART;
 class LIB_PIN;
 class SCH_COMPONENT;
 class SCH_LINE;
@@ -69,6 +72,9 @@ enum SCH_LINE_TEST_T
 /// Max number of sheets in a hierarchy project
 #define NB_MAX_SHEET    500
 
+/// Flattened library symbols shared by the components placed from them, keyed by library id.
+typedef std::map<LIB_ID, std::shared_ptr<LIB_PART>> SHARED_LIB_PARTS;
+
 struct COMPONENT_SELECTION
 {
     LIB_ID LibId;
@@ -232,8 +238,10 @@ public:
      * - whenever the symbol library table is modified.
      *
      * @param aForce true forces a refresh even if the library modification has hasn't changed.
+     * @param aResolved is an optional map of library symbols already resolved, used to share
+     *                  the library symbols between several screens.
      */
-    void UpdateSymbolLinks( bool aForce = false );
+    void UpdateSymbolLinks( bool aForce = false, SHARED_LIB_PARTS* aResolved = nullptr );
 
     /**
      * Print all the items in the screen to \a aDC.
@@ -283,10 +291,16 @@ public:
 
     /**
      * Test all of the connectable objects in the schematic for unused connection points.
+     *
+     * End points are bucketed by position, so each item is only tested against the end
+     * points it can actually be connected to.
+     *
      * @param aPath is a sheet path to pass to UpdateDanglingState if desired
+     * @param aChangedHandler is called for each item whose dangling state has changed
      * @return True if any connection state changes were made.
      */
-    bool TestDanglingEnds( const SCH_SHEET_PATH* aPath = nullptr );
+    bool TestDanglingEnds( const SCH_SHEET_PATH* aPath = nullptr,
+                           std::function<void( SCH_ITEM* )> aChangedHandler = nullptr );
 
     /**
      * Return all wires and junctions connected to \a aSegment which are not connected any
@@ -56,6 +56,7 @@
 #include <sch_bitmap.h>
 #include <bus_alias.h>
 #include <sch_sexpr_plugin.h>
+#include <sch_hierarchy_preloader.h>
 #include <template_fieldnames.h>
 #include <sch_screen.h>
 #include <class_libentry.h>
@@ -415,6 +416,7 @@ void SCH_SEXPR_PLUGIN::init( KIWAY* aKiway, const PROPERTIES* aProperties )
     m_kiway = aKiway;
     m_cache = NULL;
     m_out = NULL;
+    m_preloader = NULL;
 }
 
 
@@ -465,7 +467,7 @@ SCH_SHEET* SCH_SEXPR_PLUGIN::Load( const wxString& aFileName, KIWAY* aKiway,
         std::unique_ptr< SCH_SHEET > newSheet( new SCH_SHEET );
         newSheet->SetFileName( aFileName );
         m_rootSheet = newSheet.get();
-        loadHierarchy( newSheet.get() );
+        loadRootHierarchy( newSheet.get() );
 
         // If we got here, the schematic loaded successfully.
         sheet = newSheet.release();
@@ -475,7 +477,7 @@ SCH_SHEET* SCH_SEXPR_PLUGIN::Load( const wxString& aFileName, KIWAY* aKiway,
         m_rootSheet = aAppendToMe->GetRootSheet();
         wxASSERT( m_rootSheet != NULL );
         sheet = aAppendToMe;
-        loadHierarchy( sheet );
+        loadRootHierarchy( sheet );
     }
 
     wxASSERT( m_currentPath.size() == 1 );  // only the project path should remain
@@ -484,6 +486,33 @@ SCH_SHEET* SCH_SEXPR_PLUGIN::Load( const wxString& aFileName, KIWAY* aKiway,
 }
 
 
+void SCH_SEXPR_PLUGIN::loadRootHierarchy( SCH_SHEET* aSheet )
+{
+    // Parse all the files of the hierarchy concurrently, then attach them to their sheets.
+    SCH_HIERARCHY_PRELOADER preloader( m_kiway, m_rootSheet,
+            [this]( const wxString& aFileName, SCH_SCREEN* aScreen )
+            {
+                loadFile( aFileName, aScreen );
+            } );
+
+    preloader.Load( aSheet, m_currentPath.top() );
+
+    m_preloader = &preloader;
+
+    try
+    {
+        loadHierarchy( aSheet );
+    }
+    catch( ... )
+    {
+        m_preloader = NULL;
+        throw;
+    }
+
+    m_preloader = NULL;
+}
+
+
 // Everything below this comment is recursive.  Modify with care.
 
 void SCH_SEXPR_PLUGIN::loadHierarchy( SCH_SHEET* aSheet )
@@ -518,12 +547,12 @@ void SCH_SEXPR_PLUGIN::loadHierarchy( SCH_SHEET* aSheet )
         }
         else
         {
-            aSheet->SetScreen( new SCH_SCREEN( m_kiway ) );
-            aSheet->GetScreen()->SetFileName( fileName.GetFullPath() );
+            // The file was already parsed by the preloader
+            aSheet->SetScreen( m_preloader->TakeScreen( fileName.GetFullPath() ) );
 
             try
             {
-                loadFile( fileName.GetFullPath(), aSheet->GetScreen() );
+                m_preloader->ThrowLoadError( fileName.GetFullPath() );
 
                 for( auto aItem : aSheet->GetScreen()->Items().OfType( SCH_SHEET_T ) )
                 {
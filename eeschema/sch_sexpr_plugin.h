@@ -31,6 +31,7 @@ class KIWAY;
 class LINE_READER;
 class SCH_SCREEN;
 class SCH_SHEET;
+class SCH_HIERARCHY_PRELOADER;
 class SCH_BITMAP;
 class SCH_JUNCTION;
 class SCH_NO_CONNECT;
@@ -125,6 +126,7 @@ public:
     static void FormatPart( LIB_PART* aPart, OUTPUTFORMATTER& aFormatter );
 
 private:
+    void loadRootHierarchy( SCH_SHEET* aSheet );
     void loadHierarchy( SCH_SHEET* aSheet );
     void loadFile( const wxString& aFileName, SCH_SCREEN* aScreen );
 
@@ -156,6 +158,9 @@ protected:
     OUTPUTFORMATTER*     m_out;        ///< The output formatter for saving SCH_SCREEN objects.
     SCH_SEXPR_PLUGIN_CACHE* m_cache;
 
+    /// The files of the hierarchy loaded by Load(), no ownership, only valid during Load().
+    SCH_HIERARCHY_PRELOADER* m_preloader;
+
     /// initialize PLUGIN like a constructor would.
     void init( KIWAY* aKiway, const PROPERTIES* aProperties = nullptr );
 };
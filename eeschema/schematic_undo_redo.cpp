@@ -343,6 +343,9 @@ void SCH_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
                 break;
             }
 
+            // Connectivity may change
+            item->SetConnectivityDirty();
+
             AddToScreen( item );
         }
     }
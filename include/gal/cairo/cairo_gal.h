@@ -31,6 +31,7 @@
 
 #include <map>
 #include <iterator>
+#include <vector>
 
 #include <cairo.h>
 
@@ -253,6 +254,9 @@ protected:
     /// Maximum number of arguments for one command
     static const int MAX_CAIRO_ARGUMENTS = 4;
 
+    /// Size of the tiles rasterized in parallel, in pixels
+    static const int TILE_SIZE = 256;
+
     /// Definitions for the command recorder
     enum GRAPHICS_COMMAND
     {
@@ -312,6 +316,87 @@ protected:
     void flushPath();
     void storePath();                           ///< Store the actual path
 
+    /// Types of the deferred drawing operations
+    enum DRAW_OP_TYPE
+    {
+        OP_FILL,                                    ///< Fill a path
+        OP_STROKE,                                  ///< Stroke a path
+        OP_PAINT                                    ///< Paint an image surface
+    };
+
+    /// A deferred drawing operation, with all the Cairo state needed to replay it
+    struct DRAW_OP
+    {
+        DRAW_OP_TYPE        type;
+        cairo_path_t*       path;                   ///< Path to fill or stroke (user space)
+        cairo_surface_t*    image;                  ///< Image to paint (OP_PAINT only)
+        cairo_matrix_t      matrix;                 ///< User to device transformation
+        cairo_operator_t    op;
+        double              color[4];               ///< Solid source color (RGBA)
+        double              lineWidth;
+        double              miterLimit;
+        cairo_line_cap_t    lineCap;
+        cairo_line_join_t   lineJoin;
+        int                 x0, y0, x1, y1;         ///< Device space bounding box
+    };
+
+    bool                    isRecording;        ///< Are drawing operations deferred ?
+    std::vector<DRAW_OP>    drawList;           ///< Deferred drawing operations
+
+    /**
+     * Function fillPath()
+     * fills the current path of currentContext, or records the fill in the draw list
+     * if the drawing operations are deferred.
+     *
+     * @param aPreserve keeps the current path after filling.
+     */
+    void fillPath( bool aPreserve = false );
+
+    /**
+     * Function strokePath()
+     * strokes the current path of currentContext, or records the stroke in the draw list
+     * if the drawing operations are deferred.
+     *
+     * @param aPreserve keeps the current path after stroking.
+     */
+    void strokePath( bool aPreserve = false );
+
+    /**
+     * Function paintSurface()
+     * paints an image at the user space origin of currentContext, or records it in the
+     * draw list if the drawing operations are deferred.
+     */
+    void paintSurface( cairo_surface_t* aImage, int aWidth, int aHeight );
+
+    /// Store the current state of currentContext in a new draw list entry
+    DRAW_OP& recordOp( DRAW_OP_TYPE aType );
+
+    /// Compute the device space bounding box of a draw list entry
+    void updateOpExtents( DRAW_OP& aOp, double aX0, double aY0, double aX1, double aY1,
+                          double aMargin );
+
+    /**
+     * Function replayDrawList()
+     * rasterizes the draw list to the image surface of aContext. The surface is split
+     * into tiles that are rendered by separate threads, each with its own Cairo context
+     * drawing directly to its part of the pixel storage.
+     */
+    void replayDrawList( cairo_t* aContext );
+
+    /// Release the draw list entries
+    void clearDrawList();
+
+    /**
+     * Function updateRecording()
+     * updates the deferring of drawing operations for a new render target.  The operations
+     * drawn to the main buffer stay deferred while the target switches between the layers of
+     * the main buffer, and are rasterized when the target leaves it for the overlay.
+     *
+     * @param aTarget is the new render target.
+     * @param aRecord tells if the operations drawn to the main buffer are deferred.
+     */
+    void updateRecording( RENDER_TARGET aTarget, bool aRecord );
+
     /**
      * @brief Blits cursor into the current screen.
      */
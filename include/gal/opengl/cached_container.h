@@ -28,6 +28,7 @@
 #include <gal/opengl/vertex_container.h>
 #include <map>
 #include <set>
+#include <vector>
 
 namespace KIGFX
 {
@@ -83,15 +84,20 @@ public:
     virtual void Unmap() override = 0;
 
 protected:
-    ///> Maps size of free memory chunks to their offsets
-    typedef std::pair<unsigned int, unsigned int> CHUNK;
-    typedef std::multimap<unsigned int, unsigned int> FREE_CHUNK_MAP;
+    ///> Released space, as offset -> size of each region.  Adjacent released chunks are
+    ///> merged into a single region.
+    typedef std::map<unsigned int, unsigned int> FREE_REGIONS;
+
+    ///> The same regions, ordered by (size, offset) for best fit lookups
+    typedef std::set<std::pair<unsigned int, unsigned int>> FREE_REGIONS_BY_SIZE;
 
     /// List of all the stored items
     typedef std::set<VERTEX_ITEM*> ITEMS;
 
-    ///> Stores size & offset of free chunks.
-    FREE_CHUNK_MAP  m_freeChunks;
+    ///> Released regions below m_maxIndex.  A region never touches m_maxIndex: released space
+    ///> at the top of the occupied range goes back to the never used space.
+    FREE_REGIONS         m_freeRegions;
+    FREE_REGIONS_BY_SIZE m_freeRegionsBySize;
 
     ///> Stored VERTEX_ITEMs
     ITEMS m_items;
@@ -103,9 +109,13 @@ protected:
     unsigned int m_chunkSize;
     unsigned int m_chunkOffset;
 
-    ///> Maximal vertex index number stored in the container
+    ///> Maximal vertex index number stored in the container.  Space above it has never been
+    ///> handed out (or was given back by the topmost chunk).
     unsigned int m_maxIndex;
 
+    ///> Number of vertices in the released regions
+    unsigned int m_recycledSpace;
+
     /**
      * Resizes the chunk that stores the current item to the given size. The current item has
      * its offset adjusted after the call, and the new chunk parameters are stored
@@ -117,51 +127,53 @@ protected:
     bool reallocate( unsigned int aSize );
 
     /**
-     * Removes empty spaces between chunks and optionally resizes the container.
-     * After the operation there is continous space for storing vertices at the end of the container.
+     * Moves the stored data to a buffer of a different size.  Offsets of the stored items
+     * are preserved, so the vertices below m_maxIndex are copied as a single block.
      *
      * @param aNewSize is the new size of container, expressed in number of vertices
      * @return false in case of failure (e.g. memory shortage)
      */
-    virtual bool defragmentResize( unsigned int aNewSize ) = 0;
+    virtual bool resize( unsigned int aNewSize ) = 0;
 
     /**
-     * Transfers all stored data to a new buffer, removing empty spaces between the data chunks
-     * in the container.
-     * @param aTarget is the destination for the defragmented data.
+     * Returns the size class of a chunk able to store a number of vertices.  Chunks up to
+     * 16 vertices have their own classes, larger ones are rounded up to a quarter of a power
+     * of two, so at most 1/4 of a chunk is wasted.
      */
-    void defragment( VERTEX* aTarget );
+    static unsigned int sizeClass( unsigned int aSize );
 
     /**
-     * Looks for consecutive free memory chunks and merges them, decreasing fragmentation of
-     * memory.
+     * Returns the number of vertices a chunk of a given size class can store.
      */
-    void mergeFreeChunks();
+    static unsigned int classSize( unsigned int aClass );
 
     /**
-     * Returns the size of a chunk.
-     *
-     * @param aChunk is the chunk.
+     * Returns the size of the chunk holding an item of a given size.
      */
-    inline int getChunkSize( const CHUNK& aChunk ) const
+    static unsigned int chunkSize( unsigned int aSize )
     {
-        return aChunk.first;
+        return classSize( sizeClass( aSize ) );
     }
 
     /**
-     * Returns the offset of a chunk.
+     * Marks a chunk as free space, merging it with the adjacent released regions.
+     */
+    void addFreeChunk( unsigned int aOffset, unsigned int aSize );
+
+    /**
+     * Takes a chunk from the smallest released region able to hold it.  The rest of the
+     * region stays released.
      *
-     * @param aChunk is the chunk.
+     * @param aSize is the chunk size.
+     * @param aOffset is set to the offset of the chunk.
+     * @return false if no released region is large enough.
      */
-    inline unsigned int getChunkOffset( const CHUNK& aChunk ) const
-    {
-        return aChunk.second;
-    }
+    bool takeFreeChunk( unsigned int aSize, unsigned int& aOffset );
 
     /**
-     * Adds a chunk marked as a free space.
+     * Removes a region from the released regions.
      */
-    void addFreeChunk( unsigned int aOffset, unsigned int aSize );
+    void removeFreeRegion( FREE_REGIONS::iterator aRegion );
 
 private:
     /// Debug & test functions
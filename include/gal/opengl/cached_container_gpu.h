@@ -67,15 +67,14 @@ protected:
     bool m_useCopyBuffer;
 
     /**
-     * Function defragmentResize()
-     * removes empty spaces between chunks and optionally resizes the container.
-     * After the operation there is continous space for storing vertices at the end of the container.
+     * Function resize()
+     * moves the stored data to a new vertex buffer of a different size.
      *
      * @param aNewSize is the new size of container, expressed in number of vertices
      * @return false in case of failure (e.g. memory shortage)
      */
-    bool defragmentResize( unsigned int aNewSize ) override;
-    bool defragmentResizeMemcpy( unsigned int aNewSize );
+    bool resize( unsigned int aNewSize ) override;
+    bool resizeMemcpy( unsigned int aNewSize );
 };
 } // namespace KIGFX
 
@@ -70,11 +70,11 @@ protected:
     GLuint  m_verticesBuffer;
 
     /**
-     * Defragments the currently stored data and resizes the buffer.
+     * Resizes the buffer, keeping the currently stored data.
      * @param aNewSize is the new buffer vertex buffer size, expressed as the number of vertices.
      * @return true on success.
      */
-    bool defragmentResize( unsigned int aNewSize ) override;
+    bool resize( unsigned int aNewSize ) override;
 };
 } // namespace KIGFX
 
@@ -31,6 +31,7 @@
 
 #include <deque>
 #include <algorithm>
+#include <memory>
 
 #include <utf8.h>
 
@@ -76,6 +77,17 @@ public:
      */
     void Draw( const UTF8& aText, const VECTOR2D& aPosition, double aRotationAngle );
 
+    /**
+     * @brief Lay out a text in advance, so drawing it later only replays cached strokes.
+     *
+     * The GAL is not used, so this can be called from several threads at once.
+     *
+     * @param aText is the text to be laid out.
+     * @param aAttributes gives the size, justification and style the text will be drawn with.
+     * @param aLineWidth is the line width the text will be drawn with.
+     */
+    void Precache( const UTF8& aText, const EDA_TEXT& aAttributes, float aLineWidth ) const;
+
     /**
      * Function SetGAL
      * Changes Graphics Abstraction Layer used for drawing items for a new one.
@@ -143,6 +155,27 @@ private:
      */
     BOX2D computeBoundingBox( const GLYPH* aGlyph, double aGlyphWidth ) const;
 
+    /// Strokes of a single line of text, positioned relative to the line origin
+    struct LINE_GEOMETRY
+    {
+        std::vector<std::pair<VECTOR2D, VECTOR2D>> m_Overbars;
+        std::vector<VECTOR2D>                      m_Points;      ///< all the stroke points
+        std::vector<int>                           m_StrokeSizes; ///< point count of each stroke
+    };
+
+    /// Laid out lines shared by all the STROKE_FONT instances (see getLineGeometry())
+    class LINE_CACHE;
+
+    /// Text attributes the layout of a single line of text depends on
+    struct LINE_ATTRIBUTES
+    {
+        VECTOR2D            m_GlyphSize;
+        double              m_LineWidth;
+        EDA_TEXT_HJUSTIFY_T m_HJustify;
+        bool                m_Mirrored;
+        bool                m_Italic;
+    };
+
     /**
      * @brief Draws a single line of text. Multiline texts should be split before using the
      * function.
@@ -151,6 +184,33 @@ private:
      */
     void drawSingleLineText( const UTF8& aText );
 
+    /**
+     * @brief Returns the strokes of a single line of text, laid out for the given text
+     * attributes.  Lines are cached, so repeated texts are laid out once.
+     *
+     * @param aText is the text (one line).
+     * @param aAttributes are the text attributes.
+     */
+    std::shared_ptr<const LINE_GEOMETRY> getLineGeometry(
+            const UTF8& aText, const LINE_ATTRIBUTES& aAttributes ) const;
+
+    /**
+     * @brief Lays out a single line of text for the given text attributes.
+     *
+     * @param aText is the text (one line).
+     * @param aAttributes are the text attributes.
+     * @param aLine receives the strokes of the text.
+     */
+    void buildSingleLineText( const UTF8& aText, const LINE_ATTRIBUTES& aAttributes,
+                              LINE_GEOMETRY& aLine ) const;
+
+    /**
+     * @copydoc ComputeStringBoundaryLimits()
+     * @param aItalic tells if the text is italic.
+     */
+    VECTOR2D computeStringBoundaryLimits( const UTF8& aText, const VECTOR2D& aGlyphSize,
+                                          double aGlyphThickness, bool aItalic ) const;
+
     /**
      * @brief Returns number of lines for a given text.
      *
@@ -104,13 +104,78 @@ public:
      */
     virtual bool Draw( const VIEW_ITEM* aItem, int aLayer ) = 0;
 
+    /**
+     * Function Precache
+     * Computes the item data that drawing it will need and that can be cached outside of the
+     * GAL (e.g. polygon triangulations or text layouts), without drawing.  The VIEW calls it from
+     * several threads at once, each with different items, before (re)drawing many items on
+     * the main thread, so that this part of the work is spread over all cores.
+     * @param aItem is an item which is going to be drawn.
+     */
+    virtual void Precache( const VIEW_ITEM* aItem ) {}
+
+    /// Counters of the primitives that went through the culling stage of the painter
+    struct CULLING_STATS
+    {
+        unsigned int m_culled;      ///< Primitives skipped as smaller than a pixel
+        unsigned int m_emitted;     ///< Primitives passed on to the GAL
+    };
+
+    const CULLING_STATS& GetCullingStats() const
+    {
+        return m_cullingStats;
+    }
+
+    void ResetCullingStats()
+    {
+        m_cullingStats = { 0, 0 };
+    }
+
+    /**
+     * Function IsItemCulled
+     * Checks if a whole item would be smaller than a pixel at the current scale and updates the
+     * culling counters.  Unlike isCulled(), it applies to every target: the VIEW calls it when
+     * picking the items to redraw, so it also skips the cached groups of tiny items.
+     * @param aWorldSize is the largest dimension of the item, in world units.
+     * @return true if the item should not be drawn.
+     */
+    bool IsItemCulled( double aWorldSize );
+
+    /**
+     * Function SetCachedCullingScale
+     * Enables culling of the primitives drawn to the cached target, for groups that are never
+     * drawn above a given scale.
+     * @param aWorldScale is the largest world scale the groups are drawn at, 0 disables culling.
+     */
+    void SetCachedCullingScale( double aWorldScale )
+    {
+        m_cachedCullingScale = aWorldScale;
+    }
+
 protected:
+    /**
+     * Function isCulled
+     * Checks if a primitive would be smaller than a pixel at the current scale, so there is
+     * no need to build its geometry, and updates the culling counters.  Primitives drawn to
+     * the cached target are only culled when a scale is set with SetCachedCullingScale(), as
+     * cached groups are reused at every scale.
+     * @param aWorldSize is the largest dimension of the primitive, in world units.
+     * @return true if the primitive should not be drawn.
+     */
+    bool isCulled( double aWorldSize );
+
     /// Instance of graphic abstraction layer that gives an interface to call
     /// commands used to draw (eg. DrawLine, DrawCircle, etc.)
     GAL* m_gal;
 
     /// Color of brightened item frame
     COLOR4D m_brightenedColor;
+
+    /// Culling stage counters
+    CULLING_STATS m_cullingStats;
+
+    /// World scale used to cull the primitives drawn to the cached target (0 - no culling)
+    double m_cachedCullingScale;
 };
 
 } // namespace KIGFX
@@ -25,6 +25,7 @@
 #ifndef __VIEW_H
 #define __VIEW_H
 
+#include <cstdint>
 #include <vector>
 #include <set>
 #include <unordered_map>
@@ -95,6 +96,21 @@ public:
      */
     virtual void Remove( VIEW_ITEM* aItem );
 
+    /**
+     * Function BeginBulkAdd()
+     * Starts adding a large number of items (e.g. when loading a board).  Until EndBulkAdd()
+     * is called, Add() only records the items; their layer R-trees are then built in a single
+     * pass.  The view must not be queried, updated or redrawn in between.
+     */
+    void BeginBulkAdd();
+
+    /**
+     * Function EndBulkAdd()
+     * Indexes the items added since BeginBulkAdd().  The R-trees of the different layers are
+     * bulk loaded in parallel.
+     */
+    void EndBulkAdd();
+
 
     /**
      * Function Query()
@@ -142,6 +158,17 @@ public:
     virtual void Update( VIEW_ITEM* aItem, int aUpdateFlags );
     virtual void Update( VIEW_ITEM* aItem );
 
+    /**
+     * Function UpdateInBackground()
+     * Like Update(), but the item is refreshed progressively by the following UpdateItems()
+     * calls, the ones in the viewport first. Until then, the item keeps being drawn with its
+     * current cached geometry. Meant for display option changes that touch many items.
+     *
+     * @param aItem: the item to update.
+     * @param aUpdateFlags: how much the object has changed.
+     */
+    void UpdateInBackground( VIEW_ITEM* aItem, int aUpdateFlags );
+
     /**
      * Function SetRequired()
      * Marks the aRequiredId layer as required for the aLayerId layer. In order to display the
@@ -405,6 +432,9 @@ public:
             // Target has to be redrawn after changing its visibility
             MarkTargetDirty( m_layers[aLayer].target );
             m_layers[aLayer].visible = aVisible;
+
+            // Item LODs often depend on the visibility of other layers
+            m_lodVisibilityChanged = true;
         }
     }
 
@@ -626,6 +656,15 @@ public:
      */
     void UpdateItems();
 
+    /**
+     * Function GetLastUpdatedItemsCount()
+     * Returns the number of items refreshed by the last UpdateItems() call (for profiling).
+     */
+    size_t GetLastUpdatedItemsCount() const
+    {
+        return m_lastUpdatedItemsCount;
+    }
+
     /**
      * Updates all items in the view according to the given flags
      * @param aUpdateFlags is is according to KIGFX::VIEW_UPDATE_FLAGS
@@ -640,6 +679,27 @@ public:
     void UpdateAllItemsConditionally( int aUpdateFlags,
                                       std::function<bool( VIEW_ITEM* )> aCondition );
 
+    /**
+     * Function UpdateAllItemsInBackground()
+     * Same as UpdateAllItemsConditionally(), but the items are refreshed progressively
+     * (see UpdateInBackground()).
+     * @param aUpdateFlags is is according to KIGFX::VIEW_UPDATE_FLAGS
+     * @param aCondition is a function returning true if the item should be updated
+     */
+    void UpdateAllItemsInBackground( int aUpdateFlags,
+                                     std::function<bool( VIEW_ITEM* )> aCondition = nullptr );
+
+    /**
+     * Function HasPendingUpdates()
+     * @return true if some items are still waiting for an update, i.e. the view has to be
+     * redrawn again to complete it.  This happens with background updates and with items
+     * whose cached geometry is only built once they are drawn (see draw()).
+     */
+    bool HasPendingUpdates() const
+    {
+        return !m_backgroundItems.empty() || !m_dirtyItems.empty();
+    }
+
     /**
      * Function IsUsingDrawPriority()
      * @return true if draw priority is being respected while redrawing.
@@ -677,6 +737,19 @@ public:
         m_reverseDrawOrder = aFlag;
     }
 
+    /**
+     * Function SetLODScale()
+     * Enables drawing the cached layers from merged geometry when the view is zoomed out below
+     * aScale.  The items of such a layer are grouped in square tiles, by the center of their
+     * bounding box, and every tile is drawn with a single GAL group instead of one group per
+     * item.  Items whose visibility depends on the scale (nonzero ViewGetLOD()) are still drawn
+     * separately.  The tile groups leave out anything smaller than a pixel at aScale, and they
+     * are freed when the view is zoomed in again.
+     * @param aScale is the scale below which the tiles are used, 0 disables them.
+     * @param aTileSize is the edge length of a tile, in world units.
+     */
+    void SetLODScale( double aScale, int aTileSize );
+
     std::shared_ptr<VIEW_OVERLAY> MakeOverlay();
 
     /**
@@ -712,6 +785,27 @@ protected:
         std::set<int>           requiredLayers;  ///< layers that have to be enabled to show the layer
     };
 
+    /// Part of a cached layer that is drawn with a single group when zoomed out
+    struct LOD_TILE
+    {
+        LOD_TILE() : group( -1 ), dirty( true ) {}
+
+        VECTOR2I                cell;            ///< position of the tile, in tile size units
+        int                     group;           ///< GAL group with the merged items (or -1)
+        bool                    dirty;           ///< the group has to be rebuilt
+        BOX2I                   bbox;            ///< bounds of the items in the tile
+        std::vector<VIEW_ITEM*> mergedItems;     ///< items drawn in the group
+        std::vector<VIEW_ITEM*> looseItems;      ///< items with a nonzero LOD, drawn separately
+    };
+
+    struct LOD_LAYER
+    {
+        LOD_LAYER() : valid( false ) {}
+
+        bool                                  valid;    ///< no tile is dirty
+        std::unordered_map<int64_t, LOD_TILE> tiles;    ///< tiles by lodTileKey()
+    };
+
     // Convenience typedefs
     typedef std::unordered_map<int, VIEW_LAYER>     LAYER_MAP;
     typedef LAYER_MAP::iterator                     LAYER_MAP_ITER;
@@ -749,6 +843,10 @@ protected:
      */
     void draw( VIEW_ITEM* aItem, int aLayer, bool aImmediate = false );
 
+    /// Returns true if an item is not drawn on a layer, because the layer is hidden or the
+    /// item hides itself (see VIEW_ITEM::ViewGetLOD())
+    bool isHiddenOnLayer( VIEW_ITEM* aItem, int aLayer );
+
     /**
      * Function draw()
      * Draws an item on all layers that the item uses.
@@ -796,6 +894,55 @@ protected:
     /// Updates set of layers that an item occupies
     void updateLayers( VIEW_ITEM* aItem );
 
+    /// Lets the painter prepare, on all cores, the items which are going to be redrawn
+    void precacheItems( const std::vector<VIEW_ITEM*>& aItems );
+
+    /// Refreshes items queued by UpdateInBackground(), the visible ones first, within
+    /// the given time budget
+    void updateBackgroundItems( double aBudgetMs );
+
+    /// Returns true if the cached layers should be drawn from the LOD tiles
+    bool isLODActive() const
+    {
+        return m_lodScale > 0.0 && m_scale < m_lodScale && !m_useDrawPriority;
+    }
+
+    /// Returns the coordinates of the LOD tile containing aPoint
+    VECTOR2I lodTileCell( const VECTOR2I& aPoint ) const;
+
+    /// Returns the key of a LOD tile in LOD_LAYER::tiles
+    static int64_t lodTileKey( const VECTOR2I& aCell )
+    {
+        return (int64_t) ( ( (uint64_t) (uint32_t) aCell.x << 32 ) | (uint32_t) aCell.y );
+    }
+
+    /// Marks the LOD tiles holding an item as dirty (before it is changed or removed)
+    void dirtyLODTiles( VIEW_ITEM* aItem );
+
+    /// Assigns an item to the LOD tiles matching its current position and marks them dirty
+    void trackLODItem( VIEW_ITEM* aItem );
+
+    /// Builds the LOD tiles of the visible cached layers and rebuilds the dirty ones
+    void updateLODTiles();
+
+    /// Marks all LOD tiles of a layer as dirty
+    void dirtyLODLayer( int aLayer );
+
+    /// Marks the LOD tiles whose items changed their LOD as dirty
+    void checkLODTiles();
+
+    /// Drops the LOD tiles of a layer and frees their GAL groups
+    void clearLODLayer( int aLayer );
+
+    /// Redraws the merged group of a LOD tile
+    void rebuildLODTile( const VIEW_LAYER& aLayer, LOD_TILE& aTile );
+
+    /// Draws a layer using its LOD tiles, returns false if the tiles are not up to date
+    bool drawLODTiles( const VIEW_LAYER& aLayer, const BOX2I& aRect );
+
+    /// Drops all LOD tiles, optionally freeing their GAL groups
+    void clearLODTiles( bool aDeleteGroups );
+
     /// Determines rendering order of layers. Used in display order sorting function.
     static bool compareRenderingOrder( VIEW_LAYER* aI, VIEW_LAYER* aJ )
     {
@@ -814,6 +961,23 @@ protected:
     /// Flat list of all items
     std::shared_ptr<std::vector<VIEW_ITEM*>> m_allItems;
 
+    /// Items waiting for UpdateItems(), each listed once (see MarkForUpdate()).  The position
+    /// of an item is stored in its VIEW_ITEM_DATA, so it can be removed in constant time.
+    std::vector<VIEW_ITEM*> m_dirtyItems;
+
+    /// Items waiting for a background update (see UpdateInBackground()), the ones to be
+    /// refreshed first are at the back
+    std::vector<VIEW_ITEM*> m_backgroundItems;
+
+    /// Viewport used to order m_backgroundItems
+    BOX2D m_backgroundViewport;
+
+    /// True between BeginBulkAdd() and EndBulkAdd()
+    bool m_bulkAdd;
+
+    /// Items added since BeginBulkAdd(), by layer, not yet in the layer R-trees
+    std::unordered_map<int, std::vector<VIEW_ITEM*>> m_bulkAddItems;
+
     /// Sorted list of pointers to members of m_layers
     LAYER_ORDER m_orderedLayers;
 
@@ -867,6 +1031,24 @@ protected:
     /// Flag to reverse the draw order when using draw priority
     bool m_reverseDrawOrder;
 
+    /// Number of items refreshed by the last UpdateItems() call
+    size_t m_lastUpdatedItemsCount;
+
+    /// Scale below which the cached layers are drawn from the LOD tiles (0 - never)
+    double m_lodScale;
+
+    /// Edge length of a LOD tile, in world units
+    int m_lodTileSize;
+
+    /// The LOD tiles have to be dropped before they are used again
+    bool m_lodReset;
+
+    /// Layer visibility has changed, so the LOD of the items in the tiles has to be checked
+    bool m_lodVisibilityChanged;
+
+    /// LOD tiles of the cached layers, by layer id
+    std::unordered_map<int, LOD_LAYER> m_lodLayers;
+
     /// A control for printing: m_printMode <= 0 means no printing mode (normal draw mode
     /// m_printMode > 0 is a printing mode (currently means "we are in printing mode")
     int m_printMode;
@@ -55,6 +55,24 @@ public:
         VIEW_RTREE_BASE::Insert( mmin, mmax, aItem );
     }
 
+    /**
+     * Function ItemBounds()
+     * Returns the tree bounds of an item, taken via its ViewBBox() method.  Used to prepare
+     * the entries given to BulkInsert().
+     */
+    static Rect ItemBounds( VIEW_ITEM* aItem )
+    {
+        const BOX2I&    bbox = aItem->ViewBBox();
+        Rect            rect;
+
+        rect.m_min[0] = bbox.GetX();
+        rect.m_min[1] = bbox.GetY();
+        rect.m_max[0] = bbox.GetRight();
+        rect.m_max[1] = bbox.GetBottom();
+
+        return rect;
+    }
+
     /**
      * Function Remove()
      * Removes an item from the tree. Removal is done by comparing pointers, attepmting to remove a copy
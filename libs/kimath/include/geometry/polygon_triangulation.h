@@ -47,8 +47,9 @@
 #define __POLYGON_TRIANGULATION_H
 
 #include <algorithm>
-#include <deque>
 #include <cmath>
+#include <cstdint>
+#include <vector>
 
 #include <clipper.hpp>
 #include <geometry/shape_line_chain.h>
@@ -56,207 +57,373 @@
 #include <math/box2.h>
 #include <math/vector2d.h>
 
+/**
+ * Ear-clipping triangulator for simple polygons.
+ *
+ * Vertices live in a contiguous pool and are linked by index rather than by pointer.  The
+ * pool is a set of parallel arrays (one per field), so following a link is a single indexed
+ * load, and it keeps its capacity between calls: reusing one PolygonTriangulation object for
+ * many polygons does not allocate once the pool has grown.  The z-order (Morton) sort used to
+ * speed up the ear test is done once per polygon; splitting a polygon only distributes the
+ * sorted list between the two halves.
+ */
 class PolygonTriangulation
 {
 
 public:
 
     PolygonTriangulation( SHAPE_POLY_SET::TRIANGULATED_POLYGON& aResult ) :
-        m_result( aResult )
+        m_result( &aResult )
+    {};
+
+    /**
+     * Creates a triangulator without a target.  The output polygon must then be given
+     * to each TesselatePolygon() call.
+     */
+    PolygonTriangulation() :
+        m_result( nullptr )
     {};
 
 private:
-    struct Vertex
+    /// Index of a vertex in the pool
+    typedef uint32_t VERTEX_ID;
+
+    /// "No vertex"
+    enum : VERTEX_ID { NIL = UINT32_MAX };
+
+    /**
+     * Structure-of-arrays storage for the vertices.
+     */
+    struct VERTEX_POOL
     {
-        Vertex( size_t aIndex, double aX, double aY, PolygonTriangulation* aParent ) :
-                i( aIndex ), x( aX ), y( aY ), parent( aParent )
+        std::vector<double>    x;
+        std::vector<double>    y;
+        std::vector<int32_t>   z;       ///< z-order curve value
+        std::vector<int32_t>   i;       ///< index of the vertex in the triangulated polygon
+
+        // previous and next vertices nodes in a polygon ring
+        std::vector<VERTEX_ID> prev;
+        std::vector<VERTEX_ID> next;
+
+        // previous and next nodes in z-order
+        std::vector<VERTEX_ID> prevZ;
+        std::vector<VERTEX_ID> nextZ;
+
+        size_t size() const { return x.size(); }
+
+        void clear()
         {
+            x.clear();
+            y.clear();
+            z.clear();
+            i.clear();
+            prev.clear();
+            next.clear();
+            prevZ.clear();
+            nextZ.clear();
         }
-        Vertex& operator=( const Vertex& ) = delete;
-        Vertex& operator=( Vertex&& ) = delete;
 
-        bool operator==( const Vertex& rhs ) const
+        void reserve( size_t aSize )
         {
-            return this->x == rhs.x && this->y == rhs.y;
+            x.reserve( aSize );
+            y.reserve( aSize );
+            z.reserve( aSize );
+            i.reserve( aSize );
+            prev.reserve( aSize );
+            next.reserve( aSize );
+            prevZ.reserve( aSize );
+            nextZ.reserve( aSize );
         }
-        bool operator!=( const Vertex& rhs ) const { return !( *this == rhs ); }
-
 
         /**
-         * Function split
-         * Splits the referenced polygon between the reference point and
-         * vertex b, assuming they are in the same polygon.  Notes that while we
-         * create a new vertex pointer for the linked list, we maintain the same
-         * vertex index value from the original polygon.  In this way, we have
-         * two polygons that both share the same vertices.
-         *
-         * Returns the pointer to the newly created vertex in the polygon that
-         * does not include the reference vertex.
+         * Appends an unlinked vertex and returns its index
          */
-        Vertex* split( Vertex* b )
+        VERTEX_ID add( int32_t aIndex, double aX, double aY, int32_t aZ )
         {
-            parent->m_vertices.emplace_back( i, x, y, parent );
-            Vertex* a2 = &parent->m_vertices.back();
-            parent->m_vertices.emplace_back( b->i, b->x, b->y, parent );
-            Vertex* b2 = &parent->m_vertices.back();
-            Vertex* an = next;
-            Vertex* bp = b->prev;
-
-            next = b;
-            b->prev = this;
-
-            a2->next = an;
-            an->prev = a2;
-
-            b2->next = a2;
-            a2->prev = b2;
-
-            bp->next = b2;
-            b2->prev = bp;
-
-            return b2;
+            x.push_back( aX );
+            y.push_back( aY );
+            z.push_back( aZ );
+            i.push_back( aIndex );
+            prev.push_back( NIL );
+            next.push_back( NIL );
+            prevZ.push_back( NIL );
+            nextZ.push_back( NIL );
+
+            return static_cast<VERTEX_ID>( x.size() - 1 );
         }
 
         /**
-         * Function remove
-         * Removes the node from the linked list and z-ordered linked list.
+         * Copies vertex aSrc of aOther to the end of this pool, links included.
          */
-        void remove()
+        void copyFrom( const VERTEX_POOL& aOther, VERTEX_ID aSrc )
         {
-            next->prev = prev;
-            prev->next = next;
-
-            if( prevZ )
-                prevZ->nextZ = nextZ;
-            if( nextZ )
-                nextZ->prevZ = prevZ;
-            next = NULL;
-            prev = NULL;
-            nextZ = NULL;
-            prevZ = NULL;
+            x.push_back( aOther.x[aSrc] );
+            y.push_back( aOther.y[aSrc] );
+            z.push_back( aOther.z[aSrc] );
+            i.push_back( aOther.i[aSrc] );
+            prev.push_back( aOther.prev[aSrc] );
+            next.push_back( aOther.next[aSrc] );
+            prevZ.push_back( aOther.prevZ[aSrc] );
+            nextZ.push_back( aOther.nextZ[aSrc] );
         }
 
-
-        void updateOrder()
+        void swap( VERTEX_POOL& aOther )
         {
-            if( !z )
-                z = parent->zOrder( x, y );
+            x.swap( aOther.x );
+            y.swap( aOther.y );
+            z.swap( aOther.z );
+            i.swap( aOther.i );
+            prev.swap( aOther.prev );
+            next.swap( aOther.next );
+            prevZ.swap( aOther.prevZ );
+            nextZ.swap( aOther.nextZ );
         }
+    };
 
-        /**
-         * Function updateList
-         * After inserting or changing nodes, this function should be called to
-         * remove duplicate vertices and ensure z-ordering is correct
-         */
-        void updateList()
-        {
-            Vertex* p = next;
+    BOX2I m_bbox;
+    double m_zScaleX = 0.0;     ///< 32767 / bbox width, so zOrder() needs no division
+    double m_zScaleY = 0.0;     ///< 32767 / bbox height
 
-            while( p != this )
-            {
-                /**
-                 * Remove duplicates
-                 */
-                if( *p == *p->next )
-                {
-                    p = p->prev;
-                    p->next->remove();
+    VERTEX_POOL m_v;
 
-                    if( p == p->next )
-                        break;
-                }
+    // Scratch storage, kept between calls to avoid reallocations
+    VERTEX_POOL            m_sorted;
+    std::vector<VERTEX_ID> m_sortBuffer;
+    std::vector<VERTEX_ID> m_remap;
+    std::vector<char>      m_inSecondPoly;
 
-                p->updateOrder();
-                p = p->next;
-            };
+    SHAPE_POLY_SET::TRIANGULATED_POLYGON* m_result;
 
-            updateOrder();
-            zSort();
-        }
+    /**
+     * Calculate the Morton code of the Vertex
+     * http://www.graphics.stanford.edu/~seander/bithacks.html#InterleaveBMN
+     *
+     */
+    int32_t zOrder( const double aX, const double aY ) const
+    {
+        int32_t x = static_cast<int32_t>( ( aX - m_bbox.GetX() ) * m_zScaleX );
+        int32_t y = static_cast<int32_t>( ( aY - m_bbox.GetY() ) * m_zScaleY );
 
-        /**
-         * Sort all vertices in this vertex's list by their Morton code
-         */
-        void zSort()
-        {
-            std::deque<Vertex*> queue;
+        x = ( x | ( x << 8 ) ) & 0x00FF00FF;
+        x = ( x | ( x << 4 ) ) & 0x0F0F0F0F;
+        x = ( x | ( x << 2 ) ) & 0x33333333;
+        x = ( x | ( x << 1 ) ) & 0x55555555;
 
-            queue.push_back( this );
+        y = ( y | ( y << 8 ) ) & 0x00FF00FF;
+        y = ( y | ( y << 4 ) ) & 0x0F0F0F0F;
+        y = ( y | ( y << 2 ) ) & 0x33333333;
+        y = ( y | ( y << 1 ) ) & 0x55555555;
 
-            for( auto p = next; p && p != this; p = p->next )
-                queue.push_back( p );
+        return x | ( y << 1 );
+    }
 
-            std::sort( queue.begin(), queue.end(), []( const Vertex* a, const Vertex* b)
-            {
-                return a->z < b->z;
-            } );
+    /**
+     * Returns true if vertices a and b are at the same location
+     */
+    bool samePoint( VERTEX_ID a, VERTEX_ID b ) const
+    {
+        return m_v.x[a] == m_v.x[b] && m_v.y[a] == m_v.y[b];
+    }
+
+    /**
+     * Check to see if triangle a, b, c surrounds vertex p
+     */
+    bool inTriangle( VERTEX_ID p, VERTEX_ID a, VERTEX_ID b, VERTEX_ID c ) const
+    {
+        const double x = m_v.x[p];
+        const double y = m_v.y[p];
+        const double ax = m_v.x[a], ay = m_v.y[a];
+        const double bx = m_v.x[b], by = m_v.y[b];
+        const double cx = m_v.x[c], cy = m_v.y[c];
+
+        return     ( cx - x ) * ( ay - y ) - ( ax - x ) * ( cy - y ) >= 0
+                && ( ax - x ) * ( by - y ) - ( bx - x ) * ( ay - y ) >= 0
+                && ( bx - x ) * ( cy - y ) - ( cx - x ) * ( by - y ) >= 0;
+    }
+
+    /**
+     * Function removeVertex
+     * Removes the node from the linked list and z-ordered linked list.
+     */
+    void removeVertex( VERTEX_ID p )
+    {
+        const VERTEX_ID prev = m_v.prev[p];
+        const VERTEX_ID next = m_v.next[p];
+        const VERTEX_ID prevZ = m_v.prevZ[p];
+        const VERTEX_ID nextZ = m_v.nextZ[p];
+
+        m_v.prev[next] = prev;
+        m_v.next[prev] = next;
+
+        if( prevZ != NIL )
+            m_v.nextZ[prevZ] = nextZ;
+        if( nextZ != NIL )
+            m_v.prevZ[nextZ] = prevZ;
+
+        m_v.next[p] = NIL;
+        m_v.prev[p] = NIL;
+        m_v.nextZ[p] = NIL;
+        m_v.prevZ[p] = NIL;
+    }
+
+    /**
+     * Function split
+     * Splits the referenced polygon between vertex a and vertex b, assuming they are in
+     * the same polygon.  Notes that while we create new vertices for the linked list, we
+     * maintain the same vertex index value from the original polygon.  In this way, we have
+     * two polygons that both share the same vertices.
+     *
+     * Returns the newly created copy of b, in the polygon that does not include vertex a.
+     */
+    VERTEX_ID split( VERTEX_ID a, VERTEX_ID b )
+    {
+        VERTEX_ID a2 = m_v.add( m_v.i[a], m_v.x[a], m_v.y[a], m_v.z[a] );
+        VERTEX_ID b2 = m_v.add( m_v.i[b], m_v.x[b], m_v.y[b], m_v.z[b] );
+        VERTEX_ID an = m_v.next[a];
+        VERTEX_ID bp = m_v.prev[b];
+
+        m_v.next[a] = b;
+        m_v.prev[b] = a;
+
+        m_v.next[a2] = an;
+        m_v.prev[an] = a2;
 
-            Vertex* prev_elem = nullptr;
-            for( auto elem : queue )
+        m_v.next[b2] = a2;
+        m_v.prev[a2] = b2;
+
+        m_v.next[bp] = b2;
+        m_v.prev[b2] = bp;
+
+        return b2;
+    }
+
+    /**
+     * Function removeDuplicates
+     * After inserting or changing nodes, this function should be called to
+     * remove consecutive duplicate vertices from the list starting at aStart.
+     * aStart itself is never removed.
+     */
+    void removeDuplicates( VERTEX_ID aStart )
+    {
+        VERTEX_ID p = m_v.next[aStart];
+
+        while( p != aStart )
+        {
+            if( samePoint( p, m_v.next[p] ) )
             {
-                if( prev_elem )
-                    prev_elem->nextZ = elem;
+                p = m_v.prev[p];
+                removeVertex( m_v.next[p] );
 
-                elem->prevZ = prev_elem;
-                prev_elem = elem;
+                if( p == m_v.next[p] )
+                    break;
             }
 
-            prev_elem->nextZ = nullptr;
+            p = m_v.next[p];
         }
+    }
 
+    /**
+     * Function zSort
+     * Sort all vertices in aStart's list by their Morton code and link them into the
+     * z-ordered list.  This is done once per polygon.  The pool itself is rebuilt in
+     * z-order as well, so the walks in isEar() read neighbouring memory.
+     *
+     * Returns the new index of aStart.
+     */
+    VERTEX_ID zSort( VERTEX_ID aStart )
+    {
+        m_sortBuffer.clear();
 
-        /**
-         * Check to see if triangle surrounds our current vertex
-         */
-        bool inTriangle( const Vertex& a, const Vertex& b, const Vertex& c )
+        VERTEX_ID p = aStart;
+
+        do
         {
-            return     ( c.x - x ) * ( a.y - y ) - ( a.x - x ) * ( c.y - y ) >= 0
-                    && ( a.x - x ) * ( b.y - y ) - ( b.x - x ) * ( a.y - y ) >= 0
-                    && ( b.x - x ) * ( c.y - y ) - ( c.x - x ) * ( b.y - y ) >= 0;
-        }
+            m_sortBuffer.push_back( p );
+            p = m_v.next[p];
+        } while( p != aStart );
 
-        const size_t i;
-        const double x;
-        const double y;
-        PolygonTriangulation* parent;
+        std::sort( m_sortBuffer.begin(), m_sortBuffer.end(),
+                [this]( VERTEX_ID a, VERTEX_ID b )
+                {
+                    return m_v.z[a] < m_v.z[b];
+                } );
 
-        // previous and next vertices nodes in a polygon ring
-        Vertex* prev = nullptr;
-        Vertex* next = nullptr;
+        // Vertices removed before sorting are simply dropped from the pool
+        m_remap.assign( m_v.size(), NIL );
 
-        // z-order curve value
-        int32_t z = 0;
+        for( size_t ii = 0; ii < m_sortBuffer.size(); ++ii )
+            m_remap[m_sortBuffer[ii]] = static_cast<VERTEX_ID>( ii );
 
-        // previous and next nodes in z-order
-        Vertex* prevZ = nullptr;
-        Vertex* nextZ = nullptr;
-    };
+        m_sorted.clear();
+        m_sorted.reserve( m_v.size() );
 
-    BOX2I m_bbox;
-    std::deque<Vertex> m_vertices;
-    SHAPE_POLY_SET::TRIANGULATED_POLYGON& m_result;
+        for( size_t ii = 0; ii < m_sortBuffer.size(); ++ii )
+        {
+            m_sorted.copyFrom( m_v, m_sortBuffer[ii] );
+            m_sorted.prev[ii] = m_remap[m_sorted.prev[ii]];
+            m_sorted.next[ii] = m_remap[m_sorted.next[ii]];
+            m_sorted.prevZ[ii] = ii ? static_cast<VERTEX_ID>( ii - 1 ) : NIL;
+            m_sorted.nextZ[ii] = static_cast<VERTEX_ID>( ii + 1 );
+        }
+
+        m_sorted.nextZ.back() = NIL;
+        m_v.swap( m_sorted );
+
+        return m_remap[aStart];
+    }
 
     /**
-     * Calculate the Morton code of the Vertex
-     * http://www.graphics.stanford.edu/~seander/bithacks.html#InterleaveBMN
-     *
+     * Function splitZOrder
+     * After split( a, b ) has returned b2, distributes the z-ordered list that
+     * used to cover the whole polygon between the two resulting polygons.  The
+     * new copies of a and b take the z-order position of their originals, so
+     * the order is preserved without sorting again.
      */
-    int32_t zOrder( const double aX, const double aY ) const
+    void splitZOrder( VERTEX_ID a, VERTEX_ID b, VERTEX_ID b2 )
     {
-        int32_t x = static_cast<int32_t>( 32767.0 * ( aX - m_bbox.GetX() ) / m_bbox.GetWidth() );
-        int32_t y = static_cast<int32_t>( 32767.0 * ( aY - m_bbox.GetY() ) / m_bbox.GetHeight() );
+        const VERTEX_ID a2 = m_v.next[b2];
+        VERTEX_ID       p = b2;
 
-        x = ( x | ( x << 8 ) ) & 0x00FF00FF;
-        x = ( x | ( x << 4 ) ) & 0x0F0F0F0F;
-        x = ( x | ( x << 2 ) ) & 0x33333333;
-        x = ( x | ( x << 1 ) ) & 0x55555555;
+        m_inSecondPoly.assign( m_v.size(), 0 );
 
-        y = ( y | ( y << 8 ) ) & 0x00FF00FF;
-        y = ( y | ( y << 4 ) ) & 0x0F0F0F0F;
-        y = ( y | ( y << 2 ) ) & 0x33333333;
-        y = ( y | ( y << 1 ) ) & 0x55555555;
+        do
+        {
+            m_inSecondPoly[p] = 1;
+            p = m_v.next[p];
+        } while( p != b2 );
 
-        return x | ( y << 1 );
+        VERTEX_ID head = a;
+
+        while( m_v.prevZ[head] != NIL )
+            head = m_v.prevZ[head];
+
+        VERTEX_ID tailA = NIL;
+        VERTEX_ID tailB = NIL;
+
+        auto append = [this]( VERTEX_ID& aTail, VERTEX_ID aIdx )
+        {
+            m_v.prevZ[aIdx] = aTail;
+            m_v.nextZ[aIdx] = NIL;
+
+            if( aTail != NIL )
+                m_v.nextZ[aTail] = aIdx;
+
+            aTail = aIdx;
+        };
+
+        for( p = head; p != NIL; )
+        {
+            VERTEX_ID nextZ = m_v.nextZ[p];
+
+            append( m_inSecondPoly[p] ? tailB : tailA, p );
+
+            if( p == a )
+                append( tailB, a2 );
+            else if( p == b )
+                append( tailB, b2 );
+
+            p = nextZ;
+        }
     }
 
     /**
@@ -266,31 +433,31 @@ private:
      * as the NULL triangles are inserted as Steiner points to improve the
      * triangulation regularity of polygons
      */
-    Vertex* removeNullTriangles( Vertex* aStart )
+    VERTEX_ID removeNullTriangles( VERTEX_ID aStart )
     {
-        Vertex* retval = nullptr;
-        Vertex* p = aStart->next;
+        VERTEX_ID retval = NIL;
+        VERTEX_ID p = m_v.next[aStart];
 
         while( p != aStart )
         {
-            if( area( p->prev, p, p->next ) == 0.0 )
+            if( area( m_v.prev[p], p, m_v.next[p] ) == 0.0 )
             {
-                p = p->prev;
-                p->next->remove();
+                p = m_v.prev[p];
+                removeVertex( m_v.next[p] );
                 retval = aStart;
 
-                if( p == p->next )
+                if( p == m_v.next[p] )
                     break;
             }
-            p = p->next;
+            p = m_v.next[p];
         };
 
         // We needed an end point above that wouldn't be removed, so
         // here we do the final check for this as a Steiner point
-        if( area( aStart->prev, aStart, aStart->next ) == 0.0 )
+        if( area( m_v.prev[aStart], aStart, m_v.next[aStart] ) == 0.0 )
         {
-            retval = p->next;
-            p->remove();
+            retval = m_v.next[p];
+            removeVertex( p );
         }
 
         return retval;
@@ -301,9 +468,9 @@ private:
      * Takes a Clipper path and converts it into a circular, doubly-linked
      * list for triangulation
      */
-    Vertex* createList( const ClipperLib::Path& aPath )
+    VERTEX_ID createList( const ClipperLib::Path& aPath )
     {
-        Vertex* tail = nullptr;
+        VERTEX_ID tail = NIL;
         double sum = 0.0;
         auto len = aPath.size();
 
@@ -330,9 +497,9 @@ private:
             }
         }
 
-        if( tail && ( *tail == *tail->next ) )
+        if( tail != NIL && samePoint( tail, m_v.next[tail] ) )
         {
-            tail->next->remove();
+            removeVertex( m_v.next[tail] );
         }
 
         return tail;
@@ -344,9 +511,9 @@ private:
      * Takes the SHAPE_LINE_CHAIN and links each point into a
      * circular, doubly-linked list
      */
-    Vertex* createList( const SHAPE_LINE_CHAIN& points )
+    VERTEX_ID createList( const SHAPE_LINE_CHAIN& points )
     {
-        Vertex* tail = nullptr;
+        VERTEX_ID tail = NIL;
         double sum = 0.0;
 
         // Check for winding order
@@ -365,9 +532,9 @@ private:
             for( int i = 0; i < points.PointCount(); i++ )
                 tail = insertVertex( points.CPoint( i ), tail );
 
-        if( tail && ( *tail == *tail->next ) )
+        if( tail != NIL && samePoint( tail, m_v.next[tail] ) )
         {
-            tail->next->remove();
+            removeVertex( m_v.next[tail] );
         }
 
         return tail;
@@ -384,43 +551,43 @@ private:
      * there is an intersection (not technically allowed by KiCad, but could exist in an edited file),
      * we create a single triangle and remove both vertices before attempting to
      */
-    bool earcutList( Vertex* aPoint, int pass = 0 )
+    bool earcutList( VERTEX_ID aPoint, int pass = 0 )
     {
-        if( !aPoint )
+        if( aPoint == NIL )
             return true;
 
-        Vertex* stop = aPoint;
-        Vertex* prev;
-        Vertex* next;
+        VERTEX_ID stop = aPoint;
+        VERTEX_ID prev;
+        VERTEX_ID next;
 
-        while( aPoint->prev != aPoint->next )
+        while( m_v.prev[aPoint] != m_v.next[aPoint] )
         {
-            prev = aPoint->prev;
-            next = aPoint->next;
+            prev = m_v.prev[aPoint];
+            next = m_v.next[aPoint];
 
             if( isEar( aPoint ) )
             {
-                m_result.AddTriangle( prev->i, aPoint->i, next->i );
-                aPoint->remove();
+                m_result->AddTriangle( m_v.i[prev], m_v.i[aPoint], m_v.i[next] );
+                removeVertex( aPoint );
 
                 // Skip one vertex as the triangle will account for the prev node
-                aPoint = next->next;
-                stop = next->next;
+                aPoint = m_v.next[next];
+                stop = m_v.next[next];
 
                 continue;
             }
 
-            Vertex* nextNext = next->next;
+            VERTEX_ID nextNext = m_v.next[next];
 
-            if( *prev != *nextNext && intersects( prev, aPoint, next, nextNext ) &&
+            if( !samePoint( prev, nextNext ) && intersects( prev, aPoint, next, nextNext ) &&
                     locallyInside( prev, nextNext ) &&
                     locallyInside( nextNext, prev ) )
             {
-                m_result.AddTriangle( prev->i, aPoint->i, nextNext->i );
+                m_result->AddTriangle( m_v.i[prev], m_v.i[aPoint], m_v.i[nextNext] );
 
                 // remove two nodes involved
-                next->remove();
-                aPoint->remove();
+                removeVertex( next );
+                removeVertex( aPoint );
 
                 aPoint = nextNext;
                 stop = nextNext;
@@ -438,7 +605,9 @@ private:
             {
                 // First, try to remove the remaining steiner points
                 // If aPoint is a steiner, we need to re-assign both the start and stop points
-                if( auto newPoint = removeNullTriangles( aPoint ) )
+                VERTEX_ID newPoint = removeNullTriangles( aPoint );
+
+                if( newPoint != NIL )
                 {
                     aPoint = newPoint;
                     stop = newPoint;
@@ -454,7 +623,7 @@ private:
         /**
          * At this point, our polygon should be fully tesselated.
          */
-        return( aPoint->prev == aPoint->next );
+        return( m_v.prev[aPoint] == m_v.next[aPoint] );
     }
 
     /**
@@ -466,11 +635,11 @@ private:
      *
      * Returns true if aEar is the apex point of a ear in the polygon
      */
-    bool isEar( Vertex* aEar ) const
+    bool isEar( VERTEX_ID aEar ) const
     {
-        const Vertex* a = aEar->prev;
-        const Vertex* b = aEar;
-        const Vertex* c = aEar->next;
+        const VERTEX_ID a = m_v.prev[aEar];
+        const VERTEX_ID b = aEar;
+        const VERTEX_ID c = m_v.next[aEar];
 
         // If the area >=0, then the three points for a concave sequence
         // with b as the reflex point
@@ -478,37 +647,37 @@ private:
             return false;
 
         // triangle bbox
-        const double minTX = std::min( a->x, std::min( b->x, c->x ) );
-        const double minTY = std::min( a->y, std::min( b->y, c->y ) );
-        const double maxTX = std::max( a->x, std::max( b->x, c->x ) );
-        const double maxTY = std::max( a->y, std::max( b->y, c->y ) );
+        const double minTX = std::min( m_v.x[a], std::min( m_v.x[b], m_v.x[c] ) );
+        const double minTY = std::min( m_v.y[a], std::min( m_v.y[b], m_v.y[c] ) );
+        const double maxTX = std::max( m_v.x[a], std::max( m_v.x[b], m_v.x[c] ) );
+        const double maxTY = std::max( m_v.y[a], std::max( m_v.y[b], m_v.y[c] ) );
 
         // z-order range for the current triangle bounding box
         const int32_t minZ = zOrder( minTX, minTY );
         const int32_t maxZ = zOrder( maxTX, maxTY );
 
         // first look for points inside the triangle in increasing z-order
-        Vertex* p = aEar->nextZ;
+        VERTEX_ID p = m_v.nextZ[aEar];
 
-        while( p && p->z <= maxZ )
+        while( p != NIL && m_v.z[p] <= maxZ )
         {
             if( p != a && p != c
-                    && p->inTriangle( *a, *b, *c )
-                    && area( p->prev, p, p->next ) >= 0 )
+                    && inTriangle( p, a, b, c )
+                    && area( m_v.prev[p], p, m_v.next[p] ) >= 0 )
                 return false;
-            p = p->nextZ;
+            p = m_v.nextZ[p];
         }
 
         // then look for points in decreasing z-order
-        p = aEar->prevZ;
+        p = m_v.prevZ[aEar];
 
-        while( p && p->z >= minZ )
+        while( p != NIL && m_v.z[p] >= minZ )
         {
             if( p != a && p != c
-                    && p->inTriangle( *a, *b, *c )
-                    && area( p->prev, p, p->next ) >= 0 )
+                    && inTriangle( p, a, b, c )
+                    && area( m_v.prev[p], p, m_v.next[p] ) >= 0 )
                 return false;
-            p = p->prevZ;
+            p = m_v.prevZ[p];
         }
 
         return true;
@@ -521,29 +690,30 @@ private:
      * independently.  This is assured to generate at least one new ear if the
      * split is successful
      */
-    void splitPolygon( Vertex* start )
+    void splitPolygon( VERTEX_ID start )
     {
-        Vertex* origPoly = start;
+        VERTEX_ID origPoly = start;
         do
         {
-            Vertex* marker = origPoly->next->next;
-            while( marker != origPoly->prev )
+            VERTEX_ID marker = m_v.next[m_v.next[origPoly]];
+            while( marker != m_v.prev[origPoly] )
             {
                 // Find a diagonal line that is wholly enclosed by the polygon interior
-                if( origPoly->i != marker->i && goodSplit( origPoly, marker ) )
+                if( m_v.i[origPoly] != m_v.i[marker] && goodSplit( origPoly, marker ) )
                 {
-                    Vertex* newPoly = origPoly->split( marker );
+                    VERTEX_ID newPoly = split( origPoly, marker );
 
-                    origPoly->updateList();
-                    newPoly->updateList();
+                    splitZOrder( origPoly, marker, newPoly );
+                    removeDuplicates( origPoly );
+                    removeDuplicates( newPoly );
 
                     earcutList( origPoly );
                     earcutList( newPoly );
                     return;
                 }
-                marker = marker->next;
+                marker = m_v.next[marker];
             }
-            origPoly = origPoly->next;
+            origPoly = m_v.next[origPoly];
         } while( origPoly != start );
     }
 
@@ -555,10 +725,10 @@ private:
      * the segment is enclosed by the local triangles, we distinguish between
      * these two cases and no further checks are needed.
      */
-    bool goodSplit( const Vertex* a, const Vertex* b ) const
+    bool goodSplit( VERTEX_ID a, VERTEX_ID b ) const
     {
-        return a->next->i != b->i &&
-               a->prev->i != b->i &&
+        return m_v.i[m_v.next[a]] != m_v.i[b] &&
+               m_v.i[m_v.prev[a]] != m_v.i[b] &&
                !intersectsPolygon( a, b ) &&
                locallyInside( a, b );
     }
@@ -568,9 +738,10 @@ private:
      * Returns the twice the signed area of the triangle formed by vertices
      * p, q, r.
      */
-    double area( const Vertex* p, const Vertex* q, const Vertex* r ) const
+    double area( VERTEX_ID p, VERTEX_ID q, VERTEX_ID r ) const
     {
-        return ( q->y - p->y ) * ( r->x - q->x ) - ( q->x - p->x ) * ( r->y - q->y );
+        return ( m_v.y[q] - m_v.y[p] ) * ( m_v.x[r] - m_v.x[q] )
+               - ( m_v.x[q] - m_v.x[p] ) * ( m_v.y[r] - m_v.y[q] );
     }
 
     /**
@@ -578,9 +749,10 @@ private:
      * Checks for intersection between two segments, end points included.
      * Returns true if p1-p2 intersects q1-q2
      */
-    bool intersects( const Vertex* p1, const Vertex* q1, const Vertex* p2, const Vertex* q2 ) const
+    bool intersects( VERTEX_ID p1, VERTEX_ID q1, VERTEX_ID p2, VERTEX_ID q2 ) const
     {
-        if( ( *p1 == *q1 && *p2 == *q2 ) || ( *p1 == *q2 && *p2 == *q1 ) )
+        if( ( samePoint( p1, q1 ) && samePoint( p2, q2 ) )
+                || ( samePoint( p1, q2 ) && samePoint( p2, q1 ) ) )
             return true;
 
         return ( area( p1, q1, p2 ) > 0 ) != ( area( p1, q1, q2 ) > 0 )
@@ -593,18 +765,20 @@ private:
      * of the polygon of which vertex a is a member.
      * Return true if the segment intersects the edge of the polygon
      */
-    bool intersectsPolygon( const Vertex* a, const Vertex* b ) const
+    bool intersectsPolygon( VERTEX_ID a, VERTEX_ID b ) const
     {
-        const Vertex* p = a->next;
+        VERTEX_ID p = m_v.next[a];
         do
         {
-            if( p->i != a->i &&
-                p->next->i != a->i &&
-                p->i != b->i &&
-                p->next->i != b->i && intersects( p, p->next, a, b ) )
+            VERTEX_ID pn = m_v.next[p];
+
+            if( m_v.i[p] != m_v.i[a] &&
+                m_v.i[pn] != m_v.i[a] &&
+                m_v.i[p] != m_v.i[b] &&
+                m_v.i[pn] != m_v.i[b] && intersects( p, pn, a, b ) )
                 return true;
 
-            p = p->next;
+            p = pn;
         } while( p != a );
 
         return false;
@@ -618,37 +792,43 @@ private:
      * immediately adjacent to vertex a.
      * Returns true if the segment from a->b is inside a's polygon next to vertex a
      */
-    bool locallyInside( const Vertex* a, const Vertex* b ) const
+    bool locallyInside( VERTEX_ID a, VERTEX_ID b ) const
     {
-        if( area( a->prev, a, a->next ) < 0 )
-            return area( a, b, a->next ) >= 0 && area( a, a->prev, b ) >= 0;
+        const VERTEX_ID ap = m_v.prev[a];
+        const VERTEX_ID an = m_v.next[a];
+
+        if( area( ap, a, an ) < 0 )
+            return area( a, b, an ) >= 0 && area( a, ap, b ) >= 0;
         else
-            return area( a, b, a->prev ) < 0 || area( a, a->next, b ) < 0;
+            return area( a, b, ap ) < 0 || area( a, an, b ) < 0;
     }
 
     /**
      * Function insertVertex
      * Creates an entry in the vertices lookup and optionally inserts the newly
      * created vertex into an existing linked list.
-     * Returns a pointer to the newly created vertex
+     * Returns the index of the newly created vertex
      */
-    Vertex* insertVertex( const VECTOR2I& pt, Vertex* last )
+    VERTEX_ID insertVertex( const VECTOR2I& pt, VERTEX_ID last )
     {
-        m_result.AddVertex( pt );
-        m_vertices.emplace_back( m_result.GetVertexCount() - 1, pt.x, pt.y, this );
+        m_result->AddVertex( pt );
 
-        Vertex* p = &m_vertices.back();
-        if( !last )
+        VERTEX_ID p = m_v.add( static_cast<int32_t>( m_result->GetVertexCount() - 1 ),
+                               pt.x, pt.y, zOrder( pt.x, pt.y ) );
+
+        if( last == NIL )
         {
-            p->prev = p;
-            p->next = p;
+            m_v.prev[p] = p;
+            m_v.next[p] = p;
         }
         else
         {
-            p->next = last->next;
-            p->prev = last;
-            last->next->prev = p;
-            last->next = p;
+            VERTEX_ID lastNext = m_v.next[last];
+
+            m_v.next[p] = lastNext;
+            m_v.prev[p] = last;
+            m_v.prev[lastNext] = p;
+            m_v.next[last] = p;
         }
         return p;
     }
@@ -658,25 +838,46 @@ public:
 
     bool TesselatePolygon( const SHAPE_LINE_CHAIN& aPoly )
     {
+        wxASSERT( m_result );
+
         m_bbox = aPoly.BBox();
-        m_result.Clear();
+        m_result->Clear();
 
         if( !m_bbox.GetWidth() || !m_bbox.GetHeight() )
             return false;
 
+        m_zScaleX = 32767.0 / m_bbox.GetWidth();
+        m_zScaleY = 32767.0 / m_bbox.GetHeight();
+
+        // The pool keeps its capacity between calls; only its contents are discarded
+        m_v.clear();
+        m_v.reserve( aPoly.PointCount() );
+
         /// Place the polygon Vertices into a circular linked list
         /// and check for lists that have only 0, 1 or 2 elements and
         /// therefore cannot be polygons
-        Vertex* firstVertex = createList( aPoly );
-        if( !firstVertex || firstVertex->prev == firstVertex->next )
+        VERTEX_ID firstVertex = createList( aPoly );
+
+        if( firstVertex == NIL || m_v.prev[firstVertex] == m_v.next[firstVertex] )
             return false;
 
-        firstVertex->updateList();
+        removeDuplicates( firstVertex );
+        firstVertex = zSort( firstVertex );
 
         auto retval = earcutList( firstVertex );
-        m_vertices.clear();
+        m_v.clear();
         return retval;
     }
+
+    /**
+     * Triangulates aPoly into aResult, reusing the vertex storage of previous calls.
+     */
+    bool TesselatePolygon( const SHAPE_LINE_CHAIN& aPoly,
+                           SHAPE_POLY_SET::TRIANGULATED_POLYGON& aResult )
+    {
+        m_result = &aResult;
+        return TesselatePolygon( aPoly );
+    }
 };
 
 #endif //__POLYGON_TRIANGULATION_H
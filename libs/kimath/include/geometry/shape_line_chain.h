@@ -28,6 +28,7 @@
 
 
 #include <algorithm>                    // for max
+#include <atomic>
 #include <sstream>
 #include <vector>
 #include <wx/gdicmn.h>                  // for wxPoint
@@ -166,10 +167,9 @@ public:
             m_points.emplace_back( point.X, point.Y );
     }
 
-    virtual ~SHAPE_LINE_CHAIN()
-    {}
+    virtual ~SHAPE_LINE_CHAIN();
 
-    SHAPE_LINE_CHAIN& operator=(const SHAPE_LINE_CHAIN&) = default;
+    SHAPE_LINE_CHAIN& operator=( const SHAPE_LINE_CHAIN& aOther );
 
     SHAPE* Clone() const override;
 
@@ -183,6 +183,7 @@ public:
         m_arcs.clear();
         m_shapes.clear();
         m_closed = false;
+        invalidateSegmentIndex();
     }
 
     /**
@@ -195,6 +196,7 @@ public:
     void SetClosed( bool aClosed )
     {
         m_closed = aClosed;
+        invalidateSegmentIndex();
     }
 
     /**
@@ -304,6 +306,7 @@ public:
             aIndex -= PointCount();
 
         m_points[aIndex] = aPos;
+        invalidateSegmentIndex();
 
         if( m_shapes[aIndex] != SHAPE_IS_PT )
             convertArc( m_shapes[aIndex] );
@@ -356,16 +359,7 @@ public:
     }
 
     /// @copydoc SHAPE::BBox()
-    const BOX2I BBox( int aClearance = 0 ) const override
-    {
-        BOX2I bbox;
-        bbox.Compute( m_points );
-
-        if( aClearance != 0 || m_width != 0 )
-            bbox.Inflate( aClearance + m_width );
-
-        return bbox;
-    }
+    const BOX2I BBox( int aClearance = 0 ) const override;
 
     void GenerateBBoxCache()
     {
@@ -455,6 +449,7 @@ public:
             m_points.push_back( aP );
             m_shapes.push_back( ssize_t( SHAPE_IS_PT ) );
             m_bbox.Merge( aP );
+            invalidateSegmentIndex();
         }
     }
 
@@ -726,6 +721,8 @@ public:
 
         for( auto& arc : m_arcs )
             arc.Move( aVector );
+
+        invalidateSegmentIndex();
     }
 
     /**
@@ -778,6 +775,28 @@ public:
 
 private:
 
+    class SEGMENT_INDEX;
+
+    /**
+     * Returns the bounding volume hierarchy over our segments, building it on demand.
+     * Returns nullptr for short chains and for chains that have not been queried often enough
+     * since their last modification to amortize the cost of building it; callers then fall
+     * back to a linear scan.
+     */
+    const SEGMENT_INDEX* segmentIndex() const;
+
+    /**
+     * Drops the segment index.  Must be called by every method that moves, adds or removes
+     * points, or opens/closes the chain.
+     */
+    void invalidateSegmentIndex()
+    {
+        if( m_indexQueries.load( std::memory_order_relaxed ) )
+            releaseSegmentIndex();
+    }
+
+    void releaseSegmentIndex();
+
     constexpr static ssize_t SHAPE_IS_PT = -1;
 
     /// array of vertices
@@ -803,6 +822,12 @@ private:
 
     /// cached bounding box
     BOX2I m_bbox;
+
+    /// number of queries since the last modification (see segmentIndex())
+    mutable std::atomic<int> m_indexQueries{ 0 };
+
+    /// lazily built segment index, owned by this chain and never shared with copies
+    mutable std::atomic<const SEGMENT_INDEX*> m_segmentIndex{ nullptr };
 };
 
 
@@ -38,10 +38,114 @@
 #include <trigo.h>
 
 
+/**
+ * A rotation by a fixed angle (in 0.1 degrees), giving exactly the same results as
+ * RotatePoint() without recomputing the sine and cosine for every point.
+ */
+class FIXED_ROTATION
+{
+public:
+    FIXED_ROTATION() : m_cos( 1.0 ), m_sin( 0.0 )
+    {}
+
+    FIXED_ROTATION( double aAngle )
+    {
+        NORMALIZE_ANGLE_POS( aAngle );
+
+        // Same exact values as the shortcuts in RotatePoint()
+        if( aAngle == 0 )
+        {
+            m_cos = 1.0;
+            m_sin = 0.0;
+        }
+        else if( aAngle == 900 )
+        {
+            m_cos = 0.0;
+            m_sin = 1.0;
+        }
+        else if( aAngle == 1800 )
+        {
+            m_cos = -1.0;
+            m_sin = 0.0;
+        }
+        else if( aAngle == 2700 )
+        {
+            m_cos = 0.0;
+            m_sin = -1.0;
+        }
+        else
+        {
+            double fangle = DECIDEG2RAD( aAngle );
+            m_sin = sin( fangle );
+            m_cos = cos( fangle );
+        }
+    }
+
+    void Rotate( wxPoint& aPoint ) const
+    {
+        double fpx = ( aPoint.y * m_sin ) + ( aPoint.x * m_cos );
+        double fpy = ( aPoint.y * m_cos ) - ( aPoint.x * m_sin );
+        aPoint.x = KiROUND( fpx );
+        aPoint.y = KiROUND( fpy );
+    }
+
+private:
+    double m_cos;
+    double m_sin;
+};
+
+
+/**
+ * Rotations for all the angles multiple of 0.05 degree in 0 .. 360 degrees.
+ *
+ * Arc approximations only rotate by multiples of ( 3600 / segment count ) decidegrees,
+ * sometimes offset by half a step, so this single table serves every segment count and
+ * replaces nearly all the trig calls made when building clearance polygons.  It is built
+ * once, on first use.
+ */
+class UNIT_CIRCLE_TABLE
+{
+public:
+    UNIT_CIRCLE_TABLE()
+    {
+        for( int ii = 0; ii < STEPS; ii++ )
+            m_rotations[ii] = FIXED_ROTATION( ii / 2.0 );
+    }
+
+    /**
+     * Rotates aPoint by aAngle (in 0.1 degrees) with the same result as RotatePoint().
+     */
+    void Rotate( wxPoint& aPoint, double aAngle ) const
+    {
+        NORMALIZE_ANGLE_POS( aAngle );
+
+        double step = aAngle * 2;
+
+        if( step == (int) step && step < STEPS )
+            m_rotations[(int) step].Rotate( aPoint );
+        else
+            RotatePoint( &aPoint, aAngle );
+    }
+
+    static const UNIT_CIRCLE_TABLE& Get()
+    {
+        static const UNIT_CIRCLE_TABLE table;
+        return table;
+    }
+
+private:
+    static const int STEPS = 7200;
+
+    FIXED_ROTATION m_rotations[STEPS];
+};
+
+
 void TransformCircleToPolygon( SHAPE_LINE_CHAIN& aBuffer,
                                wxPoint aCenter, int aRadius,
                                int aError )
 {
+    const UNIT_CIRCLE_TABLE& unitCircle = UNIT_CIRCLE_TABLE::Get();
+
     wxPoint corner_position;
     int     numSegs = std::max( GetArcToSegmentCount( aRadius, aError, 360.0 ), 6 );
     int     delta = 3600 / numSegs;   // rotate angle in 0.1 degree
@@ -54,7 +158,7 @@ void TransformCircleToPolygon( SHAPE_LINE_CHAIN& aBuffer,
         corner_position.x   = radius;
         corner_position.y   = 0;
         double angle = (ii * delta) + halfstep;
-        RotatePoint( &corner_position, angle );
+        unitCircle.Rotate( corner_position, angle );
         corner_position += aCenter;
         aBuffer.Append( corner_position.x, corner_position.y );
     }
@@ -66,24 +170,11 @@ void TransformCircleToPolygon( SHAPE_LINE_CHAIN& aBuffer,
 void TransformCircleToPolygon( SHAPE_POLY_SET& aCornerBuffer, wxPoint aCenter, int aRadius,
                                int aError )
 {
-    wxPoint corner_position;
-    int     numSegs = std::max( GetArcToSegmentCount( aRadius, aError, 360.0 ), 6 );
-    int     delta = 3600 / numSegs;   // rotate angle in 0.1 degree
-    double  correction = GetCircletoPolyCorrectionFactor( numSegs );
-    int     radius = aRadius * correction;    // make segments outside the circles
-    double  halfstep = delta/2.0;    // the starting value for rot angles
-
-    aCornerBuffer.NewOutline();
+    // Fill the new outline directly rather than through aCornerBuffer.Append(), which looks
+    // the outline up again for every point
+    SHAPE_LINE_CHAIN& outline = aCornerBuffer.Outline( aCornerBuffer.NewOutline() );
 
-    for( int ii = 0; ii < numSegs; ii++ )
-    {
-        corner_position.x   = radius;
-        corner_position.y   = 0;
-        double angle = (ii * delta) + halfstep;
-        RotatePoint( &corner_position, angle );
-        corner_position += aCenter;
-        aCornerBuffer.Append( corner_position.x, corner_position.y );
-    }
+    TransformCircleToPolygon( outline, aCenter, aRadius, aError );
 }
 
 
@@ -133,11 +224,13 @@ void TransformOvalToPolygon( SHAPE_POLY_SET& aCornerBuffer, wxPoint aStart, wxPo
     // Note: the polygonal shape is built from the equivalent horizontal
     // segment starting ar 0,0, and ending at seg_len,0
 
+    const UNIT_CIRCLE_TABLE& unitCircle = UNIT_CIRCLE_TABLE::Get();
+
     // add right rounded end:
     for( int ii = 0; ii < numSegs / 2; ii++ )
     {
         corner = wxPoint( 0, radius );
-        RotatePoint( &corner, delta * ii );
+        unitCircle.Rotate( corner, delta * ii );
         corner.x += seg_len;
         polyshape.Append( corner.x, corner.y );
     }
@@ -150,7 +243,7 @@ void TransformOvalToPolygon( SHAPE_POLY_SET& aCornerBuffer, wxPoint aStart, wxPo
     for( int ii = 0; ii < numSegs / 2; ii++ )
     {
         corner = wxPoint( 0, -radius );
-        RotatePoint( &corner, delta * ii );
+        unitCircle.Rotate( corner, delta * ii );
         polyshape.Append( corner.x, corner.y );
     }
 
@@ -336,7 +429,8 @@ void TransformSegmentToPolygon( SHAPE_POLY_SET& aCornerBuffer,
     int      delta = 3600 / numSegs;   // rotate angle in 0.1 degree
 
     radius = KiROUND( radius * correction );
-    aCornerBuffer.NewOutline();
+
+    SHAPE_LINE_CHAIN& outline = aCornerBuffer.Outline( aCornerBuffer.NewOutline() );
 
     // normalize the position in order to have endp.x >= 0;
     if( endp.x < 0 )
@@ -348,47 +442,52 @@ void TransformSegmentToPolygon( SHAPE_POLY_SET& aCornerBuffer,
     double delta_angle = ArcTangente( endp.y, endp.x ); // delta_angle is in 0.1 degrees
     int seg_len        = KiROUND( EuclideanNorm( endp ) );
 
+    // The end caps use angles from the unit circle table; the rotation of the whole shape
+    // is the same for every point, so its sine and cosine are computed only once.
+    const UNIT_CIRCLE_TABLE& unitCircle = UNIT_CIRCLE_TABLE::Get();
+    const FIXED_ROTATION     segRotation( -delta_angle );
+
     // Compute the outlines of the segment, and creates a polygon
     // add right rounded end:
     for( int ii = 0; ii < 1800; ii += delta )
     {
         corner = wxPoint( 0, radius );
-        RotatePoint( &corner, ii );
+        unitCircle.Rotate( corner, ii );
         corner.x += seg_len;
-        RotatePoint( &corner, -delta_angle );
+        segRotation.Rotate( corner );
         corner += startp;
         polypoint.x = corner.x;
         polypoint.y = corner.y;
-        aCornerBuffer.Append( polypoint.x, polypoint.y );
+        outline.Append( polypoint.x, polypoint.y );
     }
 
     // Finish arc:
     corner = wxPoint( seg_len, -radius );
-    RotatePoint( &corner, -delta_angle );
+    segRotation.Rotate( corner );
     corner += startp;
     polypoint.x = corner.x;
     polypoint.y = corner.y;
-    aCornerBuffer.Append( polypoint.x, polypoint.y );
+    outline.Append( polypoint.x, polypoint.y );
 
     // add left rounded end:
     for( int ii = 0; ii < 1800; ii += delta )
     {
         corner = wxPoint( 0, -radius );
-        RotatePoint( &corner, ii );
-        RotatePoint( &corner, -delta_angle );
+        unitCircle.Rotate( corner, ii );
+        segRotation.Rotate( corner );
         corner += startp;
         polypoint.x = corner.x;
         polypoint.y = corner.y;
-        aCornerBuffer.Append( polypoint.x, polypoint.y );
+        outline.Append( polypoint.x, polypoint.y );
     }
 
     // Finish arc:
     corner = wxPoint( 0, radius );
-    RotatePoint( &corner, -delta_angle );
+    segRotation.Rotate( corner );
     corner += startp;
     polypoint.x = corner.x;
     polypoint.y = corner.y;
-    aCornerBuffer.Append( polypoint.x, polypoint.y );
+    outline.Append( polypoint.x, polypoint.y );
 }
 
 
@@ -45,6 +45,280 @@ SHAPE_LINE_CHAIN::SHAPE_LINE_CHAIN( const std::vector<int>& aV)
     }
 }
 
+
+/// Chains with fewer segments than this are always scanned linearly
+static const int SEGMENT_INDEX_MIN_SEGMENTS = 64;
+
+/// Number of queries a chain must receive after a modification before it gets indexed
+static const int SEGMENT_INDEX_MIN_QUERIES = 4;
+
+
+/**
+ * SEGMENT_INDEX
+ *
+ * A static bounding volume hierarchy over the segments of a line chain.  Consecutive segments
+ * of a chain are close to each other, so the tree is simply built over runs of consecutive
+ * segment indices: this takes linear time and lets queries visit segments in index order.
+ *
+ * The tree is stored as a flat array of nodes in depth-first order: the left child of an inner
+ * node immediately follows its parent and the right child is referenced by index.  All boxes
+ * use the exact integer coordinates of the segment end points, so a query pruned by node boxes
+ * gives the same answer as a full scan.
+ */
+class SHAPE_LINE_CHAIN::SEGMENT_INDEX
+{
+public:
+    SEGMENT_INDEX( const SHAPE_LINE_CHAIN& aChain );
+
+    const BOX2I& BBox() const
+    {
+        return m_nodes[0].m_box;
+    }
+
+    /**
+     * Visits, in increasing index order, the segments in all leaves whose box is not
+     * rejected by aPrune.
+     * @param aPrune called with a node box, returns true to skip the node.
+     * @param aVisit called with a segment index, returns true to stop the query.
+     * @return true if the query was stopped by aVisit.
+     */
+    template <class PRUNE, class VISIT>
+    bool Query( PRUNE aPrune, VISIT aVisit ) const
+    {
+        int stack[64];
+        int top = 0;
+
+        stack[top++] = 0;
+
+        while( top )
+        {
+            int         self = stack[--top];
+            const NODE& node = m_nodes[self];
+
+            if( aPrune( node.m_box ) )
+                continue;
+
+            if( node.m_right )
+            {
+                stack[top++] = node.m_right;
+                stack[top++] = self + 1;
+            }
+            else
+            {
+                for( int i = node.m_first; i < node.m_first + node.m_count; i++ )
+                {
+                    if( aVisit( i ) )
+                        return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Returns the same value as the minimum of Distance( aP ) over all segments of aChain,
+     * descending into the nearer child first and skipping nodes that cannot improve on the
+     * best distance found so far.
+     */
+    int Distance( const SHAPE_LINE_CHAIN& aChain, const VECTOR2I& aP ) const;
+
+private:
+    ///> Maximum number of segments in a leaf
+    static const int LEAF_SIZE = 8;
+
+    struct NODE
+    {
+        BOX2I m_box;
+        int   m_first;      ///> first segment covered by the node
+        int   m_count;      ///> number of segments covered by the node
+        int   m_right;      ///> index of the right child, 0 for leaves
+    };
+
+    int build( const SHAPE_LINE_CHAIN& aChain, int aFirst, int aCount );
+
+    std::vector<NODE> m_nodes;
+};
+
+
+SHAPE_LINE_CHAIN::SEGMENT_INDEX::SEGMENT_INDEX( const SHAPE_LINE_CHAIN& aChain )
+{
+    int count = aChain.SegmentCount();
+
+    m_nodes.reserve( 2 * ( count / LEAF_SIZE ) + 1 );
+    build( aChain, 0, count );
+}
+
+
+int SHAPE_LINE_CHAIN::SEGMENT_INDEX::build( const SHAPE_LINE_CHAIN& aChain, int aFirst,
+                                            int aCount )
+{
+    int index = m_nodes.size();
+
+    m_nodes.push_back( { BOX2I(), aFirst, aCount, 0 } );
+
+    if( aCount <= LEAF_SIZE )
+    {
+        const SEG s = aChain.CSegment( aFirst );
+        BOX2I     box( s.A, s.B - s.A );
+
+        box.Normalize();
+
+        for( int i = aFirst + 1; i < aFirst + aCount; i++ )
+            box.Merge( aChain.CSegment( i ).B );
+
+        m_nodes[index].m_box = box;
+    }
+    else
+    {
+        int half = aCount / 2;
+
+        build( aChain, aFirst, half );
+        int right = build( aChain, aFirst + half, aCount - half );
+
+        BOX2I box = m_nodes[index + 1].m_box;
+        box.Merge( m_nodes[right].m_box );
+
+        m_nodes[index].m_box = box;
+        m_nodes[index].m_right = right;
+    }
+
+    return index;
+}
+
+
+int SHAPE_LINE_CHAIN::SEGMENT_INDEX::Distance( const SHAPE_LINE_CHAIN& aChain,
+                                               const VECTOR2I& aP ) const
+{
+    int best = INT_MAX;
+    int stack[64];
+    int top = 0;
+
+    stack[top++] = 0;
+
+    // A segment's nearest point to aP lies inside the segment's box, so the box distance is a
+    // lower bound of its (truncated) Distance().  A node can only improve on the current best
+    // when its box is closer than best + 1.
+    auto beats = [&]( const BOX2I& aBox )
+    {
+        ecoord limit = (ecoord) best + 1;
+        return best == INT_MAX || aBox.SquaredDistance( aP ) < limit * limit;
+    };
+
+    while( top )
+    {
+        const NODE& node = m_nodes[stack[--top]];
+
+        if( !beats( node.m_box ) )
+            continue;
+
+        if( !node.m_right )
+        {
+            for( int i = node.m_first; i < node.m_first + node.m_count; i++ )
+                best = std::min( best, aChain.CSegment( i ).Distance( aP ) );
+        }
+        else
+        {
+            int left = &node - &m_nodes[0] + 1;
+            int right = node.m_right;
+
+            // push the farther child first so that the nearer one is visited first
+            if( m_nodes[left].m_box.SquaredDistance( aP )
+                    < m_nodes[right].m_box.SquaredDistance( aP ) )
+                std::swap( left, right );
+
+            stack[top++] = left;
+            stack[top++] = right;
+        }
+    }
+
+    return best;
+}
+
+
+SHAPE_LINE_CHAIN::~SHAPE_LINE_CHAIN()
+{
+    delete m_segmentIndex.load( std::memory_order_relaxed );
+}
+
+
+SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::operator=( const SHAPE_LINE_CHAIN& aOther )
+{
+    if( this == &aOther )
+        return *this;
+
+    invalidateSegmentIndex();
+
+    m_points = aOther.m_points;
+    m_shapes = aOther.m_shapes;
+    m_arcs = aOther.m_arcs;
+    m_closed = aOther.m_closed;
+    m_width = aOther.m_width;
+    m_bbox = aOther.m_bbox;
+
+    return *this;
+}
+
+
+const SHAPE_LINE_CHAIN::SEGMENT_INDEX* SHAPE_LINE_CHAIN::segmentIndex() const
+{
+    if( SegmentCount() < SEGMENT_INDEX_MIN_SEGMENTS )
+        return nullptr;
+
+    // Building the index costs a few linear scans, so don't bother for chains that are
+    // queried once and then thrown away or modified.
+    if( m_indexQueries.load( std::memory_order_relaxed ) < SEGMENT_INDEX_MIN_QUERIES )
+    {
+        m_indexQueries.fetch_add( 1, std::memory_order_relaxed );
+        return nullptr;
+    }
+
+    const SEGMENT_INDEX* index = m_segmentIndex.load( std::memory_order_acquire );
+
+    if( !index )
+    {
+        // Concurrent const queries may race to build the index; the first one to finish wins.
+        SEGMENT_INDEX*       built = new SEGMENT_INDEX( *this );
+        const SEGMENT_INDEX* expected = nullptr;
+
+        if( m_segmentIndex.compare_exchange_strong( expected, built, std::memory_order_acq_rel ) )
+        {
+            index = built;
+        }
+        else
+        {
+            delete built;
+            index = expected;
+        }
+    }
+
+    return index;
+}
+
+
+void SHAPE_LINE_CHAIN::releaseSegmentIndex()
+{
+    delete m_segmentIndex.exchange( nullptr, std::memory_order_relaxed );
+    m_indexQueries.store( 0, std::memory_order_relaxed );
+}
+
+
+const BOX2I SHAPE_LINE_CHAIN::BBox( int aClearance ) const
+{
+    BOX2I bbox;
+
+    if( const SEGMENT_INDEX* index = m_segmentIndex.load( std::memory_order_acquire ) )
+        bbox = index->BBox();
+    else
+        bbox.Compute( m_points );
+
+    if( aClearance != 0 || m_width != 0 )
+        bbox.Inflate( aClearance + m_width );
+
+    return bbox;
+}
+
+
 ClipperLib::Path SHAPE_LINE_CHAIN::convertToClipper( bool aRequiredOrientation ) const
 {
     ClipperLib::Path c_path;
@@ -95,6 +369,8 @@ bool SHAPE_LINE_CHAIN::Collide( const VECTOR2I& aP, int aClearance ) const
 
 void SHAPE_LINE_CHAIN::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
+    invalidateSegmentIndex();
+
     for( auto& pt : m_points )
     {
         pt -= aCenter;
@@ -112,18 +388,35 @@ bool SHAPE_LINE_CHAIN::Collide( const SEG& aSeg, int aClearance ) const
     BOX2I box_a( aSeg.A, aSeg.B - aSeg.A );
     BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
 
-    for( int i = 0; i < SegmentCount(); i++ )
+    // The box distances below are only valid for boxes with a positive size
+    box_a.Normalize();
+
+    auto collides = [&]( int aIndex )
     {
-        const SEG& s = CSegment( i );
+        const SEG& s = CSegment( aIndex );
         BOX2I box_b( s.A, s.B - s.A );
+        box_b.Normalize();
 
         BOX2I::ecoord_type d = box_a.SquaredDistance( box_b );
 
-        if( d < dist_sq )
-        {
-            if( s.Collide( aSeg, aClearance ) )
-                return true;
-        }
+        return d < dist_sq && s.Collide( aSeg, aClearance );
+    };
+
+    if( const SEGMENT_INDEX* index = segmentIndex() )
+    {
+        // A node box contains the boxes of all its segments, so it is never farther away
+        return index->Query(
+                [&]( const BOX2I& aBox )
+                {
+                    return box_a.SquaredDistance( aBox ) >= dist_sq;
+                },
+                collides );
+    }
+
+    for( int i = 0; i < SegmentCount(); i++ )
+    {
+        if( collides( i ) )
+            return true;
     }
 
     return false;
@@ -164,6 +457,8 @@ long long int SHAPE_LINE_CHAIN::Length() const
 
 void SHAPE_LINE_CHAIN::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 {
+    invalidateSegmentIndex();
+
     for( auto& pt : m_points )
     {
         if( aX )
@@ -180,6 +475,8 @@ void SHAPE_LINE_CHAIN::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 
 void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I& aP )
 {
+    invalidateSegmentIndex();
+
     if( aEndIndex < 0 )
         aEndIndex += PointCount();
 
@@ -211,6 +508,8 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
 
 void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE_CHAIN& aLine )
 {
+    invalidateSegmentIndex();
+
     if( aEndIndex < 0 )
         aEndIndex += PointCount();
 
@@ -236,6 +535,8 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE
 
 void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
 {
+    invalidateSegmentIndex();
+
     assert( m_shapes.size() == m_points.size() );
     if( aEndIndex < 0 )
         aEndIndex += PointCount();
@@ -272,6 +573,9 @@ int SHAPE_LINE_CHAIN::Distance( const VECTOR2I& aP, bool aOutlineOnly ) const
     if( IsClosed() && PointInside( aP ) && !aOutlineOnly )
         return 0;
 
+    if( const SEGMENT_INDEX* index = segmentIndex() )
+        return index->Distance( *this, aP );
+
     for( int s = 0; s < SegmentCount(); s++ )
         d = std::min( d, CSegment( s ).Distance( aP ) );
 
@@ -281,6 +585,8 @@ int SHAPE_LINE_CHAIN::Distance( const VECTOR2I& aP, bool aOutlineOnly ) const
 
 int SHAPE_LINE_CHAIN::Split( const VECTOR2I& aP )
 {
+    invalidateSegmentIndex();
+
     int ii = -1;
     int min_dist = 2;
 
@@ -357,6 +663,8 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Slice( int aStartIndex, int aEndIndex )
 
 void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
 {
+    invalidateSegmentIndex();
+
     assert( m_shapes.size() == m_points.size() );
 
     if( aOtherLine.PointCount() == 0 )
@@ -394,6 +702,8 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
 
 void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
 {
+    invalidateSegmentIndex();
+
     auto& chain = aArc.ConvertToPolyline();
 
     for( auto& pt : chain.CPoints() )
@@ -410,6 +720,8 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
 
 void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const VECTOR2I& aP )
 {
+    invalidateSegmentIndex();
+
     if( m_shapes[aVertex] != SHAPE_IS_PT )
         convertArc( aVertex );
 
@@ -422,6 +734,8 @@ void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const VECTOR2I& aP )
 
 void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const SHAPE_ARC& aArc )
 {
+    invalidateSegmentIndex();
+
     if( m_shapes[aVertex] != SHAPE_IS_PT )
         convertArc( aVertex );
 
@@ -602,10 +916,10 @@ bool SHAPE_LINE_CHAIN::PointInside( const VECTOR2I& aPt, int aAccuracy, bool aUs
     const std::vector<VECTOR2I>& points = CPoints();
     int pointCount = points.size();
 
-    for( int i = 0; i < pointCount; )
+    auto crossEdge = [&]( int aIndex )
     {
-        const auto p1 = points[ i++ ];
-        const auto p2 = points[ i == pointCount ? 0 : i ];
+        const auto p1 = points[ aIndex ];
+        const auto p2 = points[ aIndex + 1 == pointCount ? 0 : aIndex + 1 ];
         const auto diff = p2 - p1;
 
         if( diff.y != 0 )
@@ -615,6 +929,25 @@ bool SHAPE_LINE_CHAIN::PointInside( const VECTOR2I& aPt, int aAccuracy, bool aUs
             if( ( ( p1.y > aPt.y ) != ( p2.y > aPt.y ) ) && ( aPt.x - p1.x < d ) )
                 inside = !inside;
         }
+
+        return false;
+    };
+
+    if( const SEGMENT_INDEX* index = segmentIndex() )
+    {
+        // An edge can only cross the ray if it spans aPt.y and reaches beyond aPt.x
+        index->Query(
+                [&]( const BOX2I& aBox )
+                {
+                    return aPt.y < aBox.GetTop() || aPt.y > aBox.GetBottom()
+                           || aPt.x >= aBox.GetRight();
+                },
+                crossEdge );
+    }
+    else
+    {
+        for( int i = 0; i < pointCount; i++ )
+            crossEdge( i );
     }
 
     // If accuracy is 0 then we need to make sure the point isn't actually on the edge.
@@ -646,14 +979,41 @@ int SHAPE_LINE_CHAIN::EdgeContainingPoint( const VECTOR2I& aPt, int aAccuracy )
 	    return ( hypot( dist.x, dist.y ) <= aAccuracy + 1 ) ? 0 : -1;
     }
 
-    for( int i = 0; i < SegmentCount(); i++ )
+    auto containsPoint = [&]( int aIndex )
     {
-        const SEG s = CSegment( i );
+        const SEG s = CSegment( aIndex );
 
-        if( s.A == aPt || s.B == aPt )
-            return i;
+        return s.A == aPt || s.B == aPt || s.Distance( aPt ) <= aAccuracy + 1;
+    };
 
-        if( s.Distance( aPt ) <= aAccuracy + 1 )
+    if( const SEGMENT_INDEX* index = segmentIndex() )
+    {
+        // Distance() truncates, so a segment matches only if its squared distance is below
+        // ( aAccuracy + 2 )^2.  Segments are visited in index order, so the first match is
+        // the one the linear scan would return.
+        ecoord limit = std::max( aAccuracy + 2, 1 );
+        int    edge = -1;
+
+        index->Query(
+                [&]( const BOX2I& aBox )
+                {
+                    return aBox.SquaredDistance( aPt ) >= limit * limit;
+                },
+                [&]( int aIndex )
+                {
+                    if( !containsPoint( aIndex ) )
+                        return false;
+
+                    edge = aIndex;
+                    return true;
+                } );
+
+        return edge;
+    }
+
+    for( int i = 0; i < SegmentCount(); i++ )
+    {
+        if( containsPoint( i ) )
             return i;
     }
 
@@ -734,6 +1094,8 @@ const OPT<SHAPE_LINE_CHAIN::INTERSECTION> SHAPE_LINE_CHAIN::SelfIntersecting() c
 
 SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
 {
+    invalidateSegmentIndex();
+
     std::vector<VECTOR2I> pts_unique;
     std::vector<ssize_t> shapes_unique;
 
@@ -923,6 +1285,8 @@ SHAPE* SHAPE_LINE_CHAIN::Clone() const
 
 bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
 {
+    invalidateSegmentIndex();
+
     size_t n_pts;
     size_t n_arcs;
 
@@ -1204,21 +1204,32 @@ bool SHAPE_POLY_SET::PointOnEdge( const VECTOR2I& aP ) const
 
 bool SHAPE_POLY_SET::Collide( const SEG& aSeg, int aClearance ) const
 {
-
-    SHAPE_POLY_SET polySet = SHAPE_POLY_SET( *this );
-
-    // Inflate the polygon if necessary.
     if( aClearance > 0 )
     {
-        // fixme: the number of arc segments should not be hardcoded
-        polySet.Inflate( aClearance, 8 );
+        // The segment collides if it starts inside the set (edges included, as they are well
+        // inside the clearance area) or if it passes closer than aClearance to any contour.
+        // The contours answer this from their segment index rather than by inflating a copy
+        // of the whole set for every query.
+        if( Contains( aSeg.A, -1, 1 ) )
+            return true;
+
+        for( const POLYGON& poly : m_polys )
+        {
+            for( const SHAPE_LINE_CHAIN& path : poly )
+            {
+                if( path.Collide( aSeg, aClearance ) )
+                    return true;
+            }
+        }
+
+        return false;
     }
 
     // We are going to check to see if the segment crosses an external
     // boundary.  However, if the full segment is inside the polyset, this
     // will not be true.  So we first test to see if one of the points is
     // inside.  If true, then we collide
-    if( polySet.Contains( aSeg.A ) )
+    if( Contains( aSeg.A ) )
         return true;
 
     for( SEGMENT_ITERATOR it = ( (SHAPE_POLY_SET*) this )->IterateSegmentsWithHoles(); it; it++ )
@@ -1235,17 +1246,25 @@ bool SHAPE_POLY_SET::Collide( const SEG& aSeg, int aClearance ) const
 
 bool SHAPE_POLY_SET::Collide( const VECTOR2I& aP, int aClearance ) const
 {
-    SHAPE_POLY_SET polySet = SHAPE_POLY_SET( *this );
+    // Without clearance there is a collision if and only if the point is inside of the polygon.
+    if( aClearance <= 0 )
+        return Contains( aP );
 
-    // Inflate the polygon if necessary.
-    if( aClearance > 0 )
+    // Otherwise the point collides if it is inside (or on an edge), or closer than aClearance
+    // to any contour.
+    if( Contains( aP, -1, 1 ) )
+        return true;
+
+    for( const POLYGON& poly : m_polys )
     {
-        // fixme: the number of arc segments should not be hardcoded
-        polySet.Inflate( aClearance, 8 );
+        for( const SHAPE_LINE_CHAIN& path : poly )
+        {
+            if( path.Collide( aP, aClearance ) )
+                return true;
+        }
     }
 
-    // There is a collision if and only if the point is inside of the polygon.
-    return polySet.Contains( aP );
+    return false;
 }
 
 
@@ -1566,19 +1585,15 @@ int SHAPE_POLY_SET::DistanceToPolygon( VECTOR2I aPoint, int aPolygonIndex )
     if( containsSingle( aPoint, aPolygonIndex, 1 ) )
         return 0;
 
-    SEGMENT_ITERATOR iterator = IterateSegmentsWithHoles( aPolygonIndex );
-
-    SEG polygonEdge = *iterator;
-    int minDistance = polygonEdge.Distance( aPoint );
+    // Each contour uses its own segment index for long, repeatedly queried outlines
+    int minDistance = std::numeric_limits<int>::max();
 
-    for( iterator++; iterator && minDistance > 0; iterator++ )
+    for( const SHAPE_LINE_CHAIN& path : m_polys[aPolygonIndex] )
     {
-        polygonEdge = *iterator;
-
-        int currentDistance = polygonEdge.Distance( aPoint );
+        minDistance = std::min( minDistance, path.Distance( aPoint, true ) );
 
-        if( currentDistance < minDistance )
-            minDistance = currentDistance;
+        if( minDistance == 0 )
+            break;
     }
 
     return minDistance;
@@ -1923,15 +1938,17 @@ void SHAPE_POLY_SET::CacheTriangulation()
     m_triangulatedPolys.clear();
     m_triangulationValid = true;
 
+    // A single triangulator is shared by all outlines so its vertex pool is only grown once
+    PolygonTriangulation tess;
+
     while( tmpSet.OutlineCount() > 0 )
     {
         m_triangulatedPolys.push_back( std::make_unique<TRIANGULATED_POLYGON>() );
-        PolygonTriangulation tess( *m_triangulatedPolys.back() );
 
         // If the tesselation fails, we re-fracture the polygon, which will
         // first simplify the system before fracturing and removing the holes
         // This may result in multiple, disjoint polygons.
-        if( !tess.TesselatePolygon( tmpSet.Polygon( 0 ).front() ) )
+        if( !tess.TesselatePolygon( tmpSet.Polygon( 0 ).front(), *m_triangulatedPolys.back() ) )
         {
             tmpSet.Fracture( PM_FAST );
             m_triangulationValid = false;
@@ -99,7 +99,8 @@ bool PANEL_PCBNEW_DISPLAY_OPTIONS::TransferDataFromWindow()
     settings->LoadDisplayOptions( displ_opts, m_frame->ShowPageLimits() );
     m_frame->SetElementVisibility( LAYER_RATSNEST, displ_opts.m_ShowGlobalRatsnest );
 
-    view->RecacheAllItems();
+    // Large boards take a while to be redrawn with the new options, so do it progressively
+    view->UpdateAllItemsInBackground( KIGFX::REPAINT );
     view->MarkTargetDirty( KIGFX::TARGET_NONCACHED );
 
     return true;
@@ -120,6 +120,9 @@ PCB_DRAW_PANEL_GAL::PCB_DRAW_PANEL_GAL( wxWindow* aParentWindow, wxWindowID aWin
     setDefaultLayerOrder();
     setDefaultLayerDeps();
 
+    // When the whole board is in sight, draw the cached layers from merged 10 mm tiles
+    m_view->SetLODScale( 1.0, Millimeter2iu( 10 ) );
+
     // View controls is the first in the event handler chain, so the Tool Framework operates
     // on updated viewport data.
     m_viewControls = new KIGFX::WX_VIEW_CONTROLS( m_view, this );
@@ -166,6 +169,9 @@ void PCB_DRAW_PANEL_GAL::DisplayBoard( BOARD* aBoard )
     if( m_worksheet )
         m_worksheet->SetFileName( TO_UTF8( aBoard->GetFileName() ) );
 
+    // Index the board items in one pass once they are all added
+    m_view->BeginBulkAdd();
+
     // Load drawings
     for( auto drawing : const_cast<BOARD*>(aBoard)->Drawings() )
         m_view->Add( drawing );
@@ -193,6 +199,8 @@ void PCB_DRAW_PANEL_GAL::DisplayBoard( BOARD* aBoard )
     // Ratsnest
     m_ratsnest = std::make_unique<KIGFX::RATSNEST_VIEWITEM>( aBoard->GetConnectivity() );
     m_view->Add( m_ratsnest.get() );
+
+    m_view->EndBulkAdd();
 }
 
 
@@ -405,6 +405,74 @@ bool PCB_PAINTER::Draw( const VIEW_ITEM* aItem, int aLayer )
 }
 
 
+void PCB_PAINTER::Precache( const VIEW_ITEM* aItem )
+{
+    const EDA_ITEM* item = dynamic_cast<const EDA_ITEM*>( aItem );
+
+    if( !item )
+        return;
+
+    // Texts are laid out with the line widths used by the draw() functions below
+    const STROKE_FONT& font = m_gal->GetStrokeFont();
+
+    switch( item->Type() )
+    {
+    case PCB_LINE_T:
+    case PCB_MODULE_EDGE_T:
+    {
+        // Only the OpenGL GAL draws filled polygons from their cached triangulation
+        if( !m_gal->IsOpenGlEngine() )
+            break;
+
+        DRAWSEGMENT*    segment = (DRAWSEGMENT*) item;
+        SHAPE_POLY_SET& shape = segment->GetPolyShape();
+
+        if( segment->GetShape() == S_POLYGON && shape.OutlineCount()
+                && !shape.IsTriangulationUpToDate() )
+        {
+            shape.CacheTriangulation();
+        }
+
+        break;
+    }
+
+    case PCB_TEXT_T:
+    {
+        const TEXTE_PCB* text = static_cast<const TEXTE_PCB*>( item );
+        float lineWidth = m_pcbSettings.m_sketchMode[text->GetLayer()]
+                                  ? m_pcbSettings.m_outlineWidth
+                                  : getLineThickness( text->GetEffectiveTextPenWidth() );
+
+        font.Precache( text->GetShownText(), *text, lineWidth );
+        break;
+    }
+
+    case PCB_MODULE_TEXT_T:
+    {
+        const TEXTE_MODULE* text = static_cast<const TEXTE_MODULE*>( item );
+        float lineWidth = m_pcbSettings.m_sketchFpTxtfx
+                                  ? m_pcbSettings.m_outlineWidth
+                                  : getLineThickness( text->GetEffectiveTextPenWidth() );
+
+        font.Precache( text->GetShownText(), *text, lineWidth );
+        break;
+    }
+
+    case PCB_DIMENSION_T:
+    {
+        const TEXTE_PCB& text = static_cast<const DIMENSION*>( item )->Text();
+
+        font.Precache( text.GetShownText(), text,
+                       getLineThickness( text.GetEffectiveTextPenWidth() ) );
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+
 void PCB_PAINTER::draw( const TRACK* aTrack, int aLayer )
 {
     VECTOR2D start( aTrack->GetStart() );
@@ -426,6 +494,9 @@ void PCB_PAINTER::draw( const TRACK* aTrack, int aLayer )
             const wxString& netName = UnescapeString( aTrack->GetShortNetname() );
             VECTOR2D textPosition = start + line / 2.0;     // center of the track
 
+            if( isCulled( width * 0.7 * netName.Length() ) )
+                return;
+
             double textOrientation;
 
             if( end.y == start.y ) // horizontal
@@ -452,6 +523,13 @@ void PCB_PAINTER::draw( const TRACK* aTrack, int aLayer )
     }
     else if( IsCopperLayer( aLayer ) )
     {
+        constexpr int clearanceFlags = PCB_RENDER_SETTINGS::CL_EXISTING | PCB_RENDER_SETTINGS::CL_TRACKS;
+        bool drawClearance = ( m_pcbSettings.m_clearance & clearanceFlags ) == clearanceFlags;
+        int  clearance = drawClearance ? aTrack->GetClearance() : 0;
+
+        if( isCulled( ( end - start ).EuclideanNorm() + width + 2 * clearance ) )
+            return;
+
         // Draw a regular track
         const COLOR4D& color = m_pcbSettings.GetColor( aTrack, aLayer );
         bool outline_mode = m_pcbSettings.m_sketchMode[LAYER_TRACKS];
@@ -464,15 +542,13 @@ void PCB_PAINTER::draw( const TRACK* aTrack, int aLayer )
         m_gal->DrawSegment( start, end, width );
 
         // Clearance lines
-        constexpr int clearanceFlags = PCB_RENDER_SETTINGS::CL_EXISTING | PCB_RENDER_SETTINGS::CL_TRACKS;
-
-        if( ( m_pcbSettings.m_clearance & clearanceFlags ) == clearanceFlags )
+        if( drawClearance )
         {
             m_gal->SetLineWidth( m_pcbSettings.m_outlineWidth );
             m_gal->SetIsFill( false );
             m_gal->SetIsStroke( true );
             m_gal->SetStrokeColor( color );
-            m_gal->DrawSegment( start, end, width + aTrack->GetClearance() * 2 );
+            m_gal->DrawSegment( start, end, width + clearance * 2 );
         }
     }
 }
@@ -528,7 +604,7 @@ void PCB_PAINTER::draw( const VIA* aVia, int aLayer )
         VECTOR2D position( center );
 
         // Is anything that we can display enabled?
-        if( m_pcbSettings.m_netNamesOnVias )
+        if( m_pcbSettings.m_netNamesOnVias && !isCulled( aVia->GetWidth() ) )
         {
             bool displayNetname = ( !aVia->GetNetname().empty() );
             double maxSize = PCB_RENDER_SETTINGS::MAX_FONT_SIZE;
@@ -575,6 +651,14 @@ void PCB_PAINTER::draw( const VIA* aVia, int aLayer )
     else
         radius = aVia->GetWidth() / 2.0;
 
+    constexpr int clearanceFlags = PCB_RENDER_SETTINGS::CL_EXISTING | PCB_RENDER_SETTINGS::CL_VIAS;
+    bool drawClearance = ( m_pcbSettings.m_clearance & clearanceFlags ) == clearanceFlags
+                            && aLayer != LAYER_VIAS_HOLES;
+    int  clearance = drawClearance ? aVia->GetClearance() : 0;
+
+    if( isCulled( 2.0 * ( radius + clearance ) ) )
+        return;
+
     bool sketchMode = false;
     const COLOR4D& color  = m_pcbSettings.GetColor( aVia, aLayer );
 
@@ -642,16 +726,13 @@ void PCB_PAINTER::draw( const VIA* aVia, int aLayer )
     }
 
     // Clearance lines
-    constexpr int clearanceFlags = PCB_RENDER_SETTINGS::CL_EXISTING | PCB_RENDER_SETTINGS::CL_VIAS;
-
-    if( ( m_pcbSettings.m_clearance & clearanceFlags ) == clearanceFlags
-            && aLayer != LAYER_VIAS_HOLES )
+    if( drawClearance )
     {
         m_gal->SetLineWidth( m_pcbSettings.m_outlineWidth );
         m_gal->SetIsFill( false );
         m_gal->SetIsStroke( true );
         m_gal->SetStrokeColor( color );
-        m_gal->DrawCircle( center, radius + aVia->GetClearance() );
+        m_gal->DrawCircle( center, radius + clearance );
     }
 }
 
@@ -667,7 +748,8 @@ void PCB_PAINTER::draw( const D_PAD* aPad, int aLayer )
         VECTOR2D position( aPad->ShapePos() );
 
         // Is anything that we can display enabled?
-        if( m_pcbSettings.m_netNamesOnPads || m_pcbSettings.m_padNumbers )
+        if( ( m_pcbSettings.m_netNamesOnPads || m_pcbSettings.m_padNumbers )
+                && !isCulled( std::max( aPad->GetSize().x, aPad->GetSize().y ) ) )
         {
             bool displayNetname = ( m_pcbSettings.m_netNamesOnPads && !aPad->GetNetname().empty() );
             VECTOR2D padsize = VECTOR2D( aPad->GetSize() );
@@ -755,6 +837,39 @@ void PCB_PAINTER::draw( const D_PAD* aPad, int aLayer )
         return;
     }
 
+    // Mask and paste margins and clearance outlines make the pad appear bigger
+    constexpr int clearanceFlags = PCB_RENDER_SETTINGS::CL_PADS;
+    bool drawClearance = ( m_pcbSettings.m_clearance & clearanceFlags ) == clearanceFlags
+                            && ( aLayer == LAYER_PAD_FR
+                                || aLayer == LAYER_PAD_BK
+                                || aLayer == LAYER_PADS_TH );
+    double visibleSize;
+
+    if( aLayer == LAYER_PADS_PLATEDHOLES || aLayer == LAYER_NON_PLATEDHOLES )
+    {
+        visibleSize = std::max( getDrillSize( aPad ).x, getDrillSize( aPad ).y );
+    }
+    else
+    {
+        int margin = drawClearance ? aPad->GetClearance() : 0;
+
+        if( aLayer == F_Mask || aLayer == B_Mask )
+        {
+            margin += aPad->GetSolderMaskMargin();
+        }
+        else if( aLayer == F_Paste || aLayer == B_Paste )
+        {
+            wxSize pasteMargin = aPad->GetSolderPasteMargin();
+            margin += std::max( pasteMargin.x, pasteMargin.y );
+        }
+
+        visibleSize = 2.0 * ( aPad->GetBoundingRadius() + std::max( margin, 0 ) );
+    }
+
+    // Skip building the pad polygons if they would not be visible anyway
+    if( isCulled( visibleSize ) )
+        return;
+
     // Pad drawing
     COLOR4D color;
 
@@ -877,12 +992,7 @@ void PCB_PAINTER::draw( const D_PAD* aPad, int aLayer )
     }
 
     // Clearance lines
-    constexpr int clearanceFlags = PCB_RENDER_SETTINGS::CL_PADS;
-
-    if( ( m_pcbSettings.m_clearance & clearanceFlags ) == clearanceFlags
-            && ( aLayer == LAYER_PAD_FR
-                || aLayer == LAYER_PAD_BK
-                || aLayer == LAYER_PADS_TH ) )
+    if( drawClearance )
     {
         SHAPE_POLY_SET polySet;
         aPad->TransformShapeWithClearanceToPolygon( polySet, aPad->GetClearance() );
@@ -1007,6 +1117,11 @@ void PCB_PAINTER::draw( const TEXTE_PCB* aText, int aLayer )
     if( shownText.Length() == 0 )
         return;
 
+    // Rough extent of the text: a glyph cell for every character
+    if( isCulled( std::max<double>( aText->GetTextHeight(),
+                                    (double) aText->GetTextWidth() * shownText.Length() ) ) )
+        return;
+
     const COLOR4D& color = m_pcbSettings.GetColor( aText, aText->GetLayer() );
     VECTOR2D position( aText->GetTextPos().x, aText->GetTextPos().y );
 
@@ -1035,6 +1150,10 @@ void PCB_PAINTER::draw( const TEXTE_MODULE* aText, int aLayer )
     if( shownText.Length() == 0 )
         return;
 
+    if( isCulled( std::max<double>( aText->GetTextHeight(),
+                                    (double) aText->GetTextWidth() * shownText.Length() ) ) )
+        return;
+
     bool sketch = m_pcbSettings.m_sketchFpTxtfx;
 
     const COLOR4D& color = m_pcbSettings.GetColor( aText, aLayer );
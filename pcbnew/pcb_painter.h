@@ -240,6 +240,9 @@ public:
     /// @copydoc PAINTER::Draw()
     virtual bool Draw( const VIEW_ITEM* aItem, int aLayer ) override;
 
+    /// @copydoc PAINTER::Precache()
+    virtual void Precache( const VIEW_ITEM* aItem ) override;
+
 protected:
     PCB_RENDER_SETTINGS m_pcbSettings;
 
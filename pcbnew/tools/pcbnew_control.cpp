@@ -132,7 +132,7 @@ int PCBNEW_CONTROL::TrackDisplayMode( const TOOL_EVENT& aEvent )
     for( auto track : board()->Tracks() )
     {
         if( track->Type() == PCB_TRACE_T )
-            view()->Update( track, KIGFX::GEOMETRY );
+            view()->UpdateInBackground( track, KIGFX::GEOMETRY );
     }
 
     canvas()->Refresh();
@@ -180,7 +180,7 @@ int PCBNEW_CONTROL::PadDisplayMode( const TOOL_EVENT& aEvent )
     for( auto module : board()->Modules() ) // fixme: move to PCB_VIEW
     {
         for( auto pad : module->Pads() )
-            view()->Update( pad, KIGFX::GEOMETRY );
+            view()->UpdateInBackground( pad, KIGFX::GEOMETRY );
     }
 
     canvas()->Refresh();
@@ -200,7 +200,7 @@ int PCBNEW_CONTROL::ViaDisplayMode( const TOOL_EVENT& aEvent )
     for( auto track : board()->Tracks() )
     {
         if( track->Type() == PCB_TRACE_T || track->Type() == PCB_VIA_T )
-            view()->Update( track, KIGFX::GEOMETRY );
+            view()->UpdateInBackground( track, KIGFX::GEOMETRY );
     }
 
     canvas()->Refresh();
@@ -219,7 +219,7 @@ int PCBNEW_CONTROL::GraphicDisplayMode( const TOOL_EVENT& aEvent )
 
     for( auto item : board()->Drawings() )
     {
-        view()->Update( item, KIGFX::GEOMETRY );
+        view()->UpdateInBackground( item, KIGFX::GEOMETRY );
     }
 
     canvas()->Refresh();
@@ -241,7 +241,7 @@ int PCBNEW_CONTROL::ModuleEdgeOutlines( const TOOL_EVENT& aEvent )
         for( auto item : module->GraphicalItems() )
         {
             if( item->Type() == PCB_MODULE_EDGE_T )
-                view()->Update( item, KIGFX::GEOMETRY );
+                view()->UpdateInBackground( item, KIGFX::GEOMETRY );
         }
     }
 
@@ -261,13 +261,13 @@ int PCBNEW_CONTROL::ModuleTextOutlines( const TOOL_EVENT& aEvent )
 
     for( auto module : board()->Modules() )
     {
-        view()->Update( &module->Reference(), KIGFX::GEOMETRY );
-        view()->Update( &module->Value(), KIGFX::GEOMETRY );
+        view()->UpdateInBackground( &module->Reference(), KIGFX::GEOMETRY );
+        view()->UpdateInBackground( &module->Value(), KIGFX::GEOMETRY );
 
         for( auto item : module->GraphicalItems() )
         {
             if( item->Type() == PCB_MODULE_TEXT_T )
-                view()->Update( item, KIGFX::GEOMETRY );
+                view()->UpdateInBackground( item, KIGFX::GEOMETRY );
         }
     }
 
@@ -297,7 +297,7 @@ int PCBNEW_CONTROL::ZoneDisplayMode( const TOOL_EVENT& aEvent )
     view()->UpdateDisplayOptions( opts );
 
     for( int i = 0; i < board()->GetAreaCount(); ++i )
-        view()->Update( board()->GetArea( i ), KIGFX::GEOMETRY );
+        view()->UpdateInBackground( board()->GetArea( i ), KIGFX::GEOMETRY );
 
     canvas()->Refresh();
 
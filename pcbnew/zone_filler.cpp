@@ -42,6 +42,7 @@
 #include <geometry/shape_file_io.h>
 #include <geometry/convex_hull.h>
 #include <geometry/geometry_utils.h>
+#include <geometry/rtree.h>
 #include <confirm.h>
 #include <convert_to_biu.h>
 #include <math/util.h>      // for KiROUND
@@ -74,6 +75,23 @@ static const double s_RoundPadThermalSpokeAngle = 450;
 static const bool s_DumpZonesWhenFilling = false;
 
 
+/**
+ * The pads of a single net, in board order, with an R-tree over their bounding boxes.
+ * The tree stores indices into m_Pads so that query results can be put back in board
+ * order (the order in which pads are visited decides the order of the thermal spokes).
+ */
+struct ZONE_FILLER::NET_PADS
+{
+    NET_PADS() :
+        m_MaxThermalGap( 0 )
+    {}
+
+    std::vector<D_PAD*>           m_Pads;
+    RTree<size_t, int, 2, double> m_Tree;
+    int                           m_MaxThermalGap;  // largest pad-level thermal gap
+};
+
+
 ZONE_FILLER::ZONE_FILLER(  BOARD* aBoard, COMMIT* aCommit ) :
     m_board( aBoard ),
     m_brdOutlinesValid( false ),
@@ -119,6 +137,9 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
     m_boardOutline.RemoveAllContours();
     m_brdOutlinesValid = m_board->GetBoardPolygonOutlines( m_boardOutline );
 
+    // Built before the fill threads start; they only read it.
+    buildPadIndex();
+
     for( auto zone : aZones )
     {
         // Keepout zones are not filled
@@ -368,6 +389,76 @@ bool hasThermalConnection( D_PAD* pad, const ZONE_CONTAINER* aZone )
 }
 
 
+void ZONE_FILLER::buildPadIndex()
+{
+    m_padIndex.clear();
+
+    for( auto module : m_board->Modules() )
+    {
+        for( auto pad : module->Pads() )
+        {
+            // hasThermalConnection() never accepts unconnected pads
+            if( pad->GetNetCode() <= 0 )
+                continue;
+
+            std::unique_ptr<NET_PADS>& netPads = m_padIndex[ pad->GetNetCode() ];
+
+            if( !netPads )
+                netPads.reset( new NET_PADS );
+
+            EDA_RECT  bbox = pad->GetBoundingBox();
+            bbox.Normalize();
+
+            const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+            const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+            netPads->m_Tree.Insert( mmin, mmax, netPads->m_Pads.size() );
+            netPads->m_Pads.push_back( pad );
+            netPads->m_MaxThermalGap = std::max( netPads->m_MaxThermalGap, pad->GetThermalGap() );
+        }
+    }
+}
+
+
+void ZONE_FILLER::collectThermalPads( const ZONE_CONTAINER* aZone,
+                                      std::vector<D_PAD*>& aPads ) const
+{
+    auto it = m_padIndex.find( aZone->GetNetCode() );
+
+    if( it == m_padIndex.end() )
+        return;
+
+    const NET_PADS& netPads = *it->second;
+
+    // GetThermalReliefGap() falls back to the zone's gap for pads which don't define one.
+    // The extra unit keeps the query conservative w.r.t. the inclusive EDA_RECT tests.
+    int      maxGap = std::max( aZone->GetThermalReliefGap( nullptr ), netPads.m_MaxThermalGap );
+    EDA_RECT zoneBB = aZone->GetBoundingBox();
+    zoneBB.Normalize();
+    zoneBB.Inflate( maxGap + 1 );
+
+    const int mmin[2] = { zoneBB.GetX(), zoneBB.GetY() };
+    const int mmax[2] = { zoneBB.GetRight(), zoneBB.GetBottom() };
+
+    std::vector<size_t> found;
+
+    netPads.m_Tree.Search( mmin, mmax,
+            [&]( const size_t& aIndex ) -> bool
+            {
+                found.push_back( aIndex );
+                return true;
+            } );
+
+    std::sort( found.begin(), found.end() );
+
+    for( size_t idx : found )
+    {
+        if( hasThermalConnection( netPads.m_Pads[ idx ], aZone ) )
+            aPads.push_back( netPads.m_Pads[ idx ] );
+    }
+}
+
+
 /**
  * Setup aDummyPad to have the same size and shape of aPad's hole.  This allows us to create
  * thermal reliefs and clearances for holes using the pad code.
@@ -483,26 +574,23 @@ void ZONE_FILLER::knockoutThermalReliefs( const ZONE_CONTAINER* aZone, SHAPE_POL
     MODULE  dummymodule( m_board );
     D_PAD   dummypad( &dummymodule );
 
-    for( auto module : m_board->Modules() )
+    std::vector<D_PAD*> thermalPads;
+    collectThermalPads( aZone, thermalPads );
+
+    for( D_PAD* pad : thermalPads )
     {
-        for( auto pad : module->Pads() )
+        // If the pad isn't on the current layer but has a hole, knock out a thermal relief
+        // for the hole.
+        if( !pad->IsOnLayer( aZone->GetLayer() ) )
         {
-            if( !hasThermalConnection( pad, aZone ) )
+            if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
                 continue;
 
-            // If the pad isn't on the current layer but has a hole, knock out a thermal relief
-            // for the hole.
-            if( !pad->IsOnLayer( aZone->GetLayer() ) )
-            {
-                if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
-                    continue;
-
-                setupDummyPadForHole( pad, dummypad );
-                pad = &dummypad;
-            }
-
-            addKnockout( pad, aZone->GetThermalReliefGap( pad ), holes );
+            setupDummyPadForHole( pad, dummypad );
+            pad = &dummypad;
         }
+
+        addKnockout( pad, aZone->GetThermalReliefGap( pad ), holes );
     }
 
     holes.Simplify( SHAPE_POLY_SET::PM_FAST );
@@ -761,6 +849,19 @@ void ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone,
     // things up a bit.
     testAreas.BuildBBoxCaches();
 
+    // Likewise, spokes are only hit-tested against the spokes whose bounding box contains
+    // the test point (PointInside() rejects all others through its bbox cache anyway).
+    RTree<const SHAPE_LINE_CHAIN*, int, 2, double> spokeTree;
+
+    for( const SHAPE_LINE_CHAIN& spoke : thermalSpokes )
+    {
+        const BOX2I bbox = spoke.BBox();
+        const int   mmin[2] = { bbox.GetX(), bbox.GetY() };
+        const int   mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+        spokeTree.Insert( mmin, mmax, &spoke );
+    }
+
     for( const SHAPE_LINE_CHAIN& spoke : thermalSpokes )
     {
         const VECTOR2I& testPt = spoke.CPoint( 3 );
@@ -773,14 +874,22 @@ void ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone,
         }
 
         // Hit-test against other spokes
-        for( const SHAPE_LINE_CHAIN& other : thermalSpokes )
-        {
-            if( &other != &spoke && other.PointInside( testPt, 1, USE_BBOX_CACHES  ) )
-            {
-                aRawPolys.AddOutline( spoke );
-                break;
-            }
-        }
+        const int mmin[2] = { testPt.x, testPt.y };
+        bool      connected = false;
+
+        spokeTree.Search( mmin, mmin,
+                [&]( const SHAPE_LINE_CHAIN* const& aOther ) -> bool
+                {
+                    if( aOther != &spoke && aOther->PointInside( testPt, 1, USE_BBOX_CACHES ) )
+                    {
+                        connected = true;
+                    }
+
+                    return !connected;
+                } );
+
+        if( connected )
+            aRawPolys.AddOutline( spoke );
     }
 
     // Ensure previous changes (adding thermal stubs) do not add
@@ -913,106 +1022,103 @@ void ZONE_FILLER::buildThermalSpokes( const ZONE_CONTAINER* aZone,
     // us avoid the question.
     int epsilon = KiROUND( IU_PER_MM * 0.04 );  // about 1.5 mil
 
-    for( auto module : m_board->Modules() )
-    {
-        for( auto pad : module->Pads() )
-        {
-            if( !hasThermalConnection( pad, aZone ) )
-                continue;
+    std::vector<D_PAD*> thermalPads;
+    collectThermalPads( aZone, thermalPads );
 
-            // We currently only connect to pads, not pad holes
-            if( !pad->IsOnLayer( aZone->GetLayer() ) )
-                continue;
+    for( D_PAD* pad : thermalPads )
+    {
+        // We currently only connect to pads, not pad holes
+        if( !pad->IsOnLayer( aZone->GetLayer() ) )
+            continue;
 
-            int thermalReliefGap = aZone->GetThermalReliefGap( pad );
+        int thermalReliefGap = aZone->GetThermalReliefGap( pad );
 
-            // Calculate thermal bridge half width
-            int spoke_w = aZone->GetThermalReliefCopperBridge( pad );
-            // Avoid spoke_w bigger than the smaller pad size, because
-            // it is not possible to create stubs bigger than the pad.
-            // Possible refinement: have a separate size for vertical and horizontal stubs
-            spoke_w = std::min( spoke_w, pad->GetSize().x );
-            spoke_w = std::min( spoke_w, pad->GetSize().y );
+        // Calculate thermal bridge half width
+        int spoke_w = aZone->GetThermalReliefCopperBridge( pad );
+        // Avoid spoke_w bigger than the smaller pad size, because
+        // it is not possible to create stubs bigger than the pad.
+        // Possible refinement: have a separate size for vertical and horizontal stubs
+        spoke_w = std::min( spoke_w, pad->GetSize().x );
+        spoke_w = std::min( spoke_w, pad->GetSize().y );
 
-            // Cannot create stubs having a width < zone min thickness
-            if( spoke_w <= aZone->GetMinThickness() )
-                continue;
+        // Cannot create stubs having a width < zone min thickness
+        if( spoke_w <= aZone->GetMinThickness() )
+            continue;
 
-            int spoke_half_w = spoke_w / 2;
+        int spoke_half_w = spoke_w / 2;
 
-            // Quick test here to possibly save us some work
-            BOX2I itemBB = pad->GetBoundingBox();
-            itemBB.Inflate( thermalReliefGap + epsilon );
+        // Quick test here to possibly save us some work
+        BOX2I itemBB = pad->GetBoundingBox();
+        itemBB.Inflate( thermalReliefGap + epsilon );
 
-            if( !( itemBB.Intersects( zoneBB ) ) )
-                continue;
+        if( !( itemBB.Intersects( zoneBB ) ) )
+            continue;
 
-            // Thermal spokes consist of segments from the pad center to points just outside
-            // the thermal relief.
-            //
-            // We use the bounding-box to lay out the spokes, but for this to work the
-            // bounding box has to be built at the same rotation as the spokes.
+        // Thermal spokes consist of segments from the pad center to points just outside
+        // the thermal relief.
+        //
+        // We use the bounding-box to lay out the spokes, but for this to work the
+        // bounding box has to be built at the same rotation as the spokes.
 
-            wxPoint shapePos = pad->ShapePos();
-            wxPoint padPos = pad->GetPosition();
-            double padAngle = pad->GetOrientation();
-            pad->SetOrientation( 0.0 );
-            pad->SetPosition( { 0, 0 } );
-            BOX2I reliefBB = pad->GetBoundingBox();
-            pad->SetPosition( padPos );
-            pad->SetOrientation( padAngle );
+        wxPoint shapePos = pad->ShapePos();
+        wxPoint padPos = pad->GetPosition();
+        double padAngle = pad->GetOrientation();
+        pad->SetOrientation( 0.0 );
+        pad->SetPosition( { 0, 0 } );
+        BOX2I reliefBB = pad->GetBoundingBox();
+        pad->SetPosition( padPos );
+        pad->SetOrientation( padAngle );
 
-            reliefBB.Inflate( thermalReliefGap + epsilon );
+        reliefBB.Inflate( thermalReliefGap + epsilon );
 
-            // For circle pads, the thermal spoke orientation is 45 deg
-            if( pad->GetShape() == PAD_SHAPE_CIRCLE )
-                padAngle = s_RoundPadThermalSpokeAngle;
+        // For circle pads, the thermal spoke orientation is 45 deg
+        if( pad->GetShape() == PAD_SHAPE_CIRCLE )
+            padAngle = s_RoundPadThermalSpokeAngle;
 
-            for( int i = 0; i < 4; i++ )
+        for( int i = 0; i < 4; i++ )
+        {
+            SHAPE_LINE_CHAIN spoke;
+            switch( i )
             {
-                SHAPE_LINE_CHAIN spoke;
-                switch( i )
-                {
-                case 0:       // lower stub
-                    spoke.Append( +spoke_half_w,       -spoke_half_w );
-                    spoke.Append( -spoke_half_w,       -spoke_half_w );
-                    spoke.Append( -spoke_half_w,       reliefBB.GetBottom() );
-                    spoke.Append( 0,                   reliefBB.GetBottom() );  // test pt
-                    spoke.Append( +spoke_half_w,       reliefBB.GetBottom() );
-                    break;
-
-                case 1:       // upper stub
-                    spoke.Append( +spoke_half_w,       spoke_half_w );
-                    spoke.Append( -spoke_half_w,       spoke_half_w );
-                    spoke.Append( -spoke_half_w,       reliefBB.GetTop() );
-                    spoke.Append( 0,                   reliefBB.GetTop() );     // test pt
-                    spoke.Append( +spoke_half_w,       reliefBB.GetTop() );
-                    break;
-
-                case 2:       // right stub
-                    spoke.Append( -spoke_half_w,       spoke_half_w );
-                    spoke.Append( -spoke_half_w,       -spoke_half_w );
-                    spoke.Append( reliefBB.GetRight(), -spoke_half_w );
-                    spoke.Append( reliefBB.GetRight(), 0 );                     // test pt
-                    spoke.Append( reliefBB.GetRight(), spoke_half_w );
-                    break;
-
-                case 3:       // left stub
-                    spoke.Append( spoke_half_w,        spoke_half_w );
-                    spoke.Append( spoke_half_w,        -spoke_half_w );
-                    spoke.Append( reliefBB.GetLeft(),  -spoke_half_w );
-                    spoke.Append( reliefBB.GetLeft(),  0 );                     // test pt
-                    spoke.Append( reliefBB.GetLeft(),  spoke_half_w );
-                    break;
-                }
+            case 0:       // lower stub
+                spoke.Append( +spoke_half_w,       -spoke_half_w );
+                spoke.Append( -spoke_half_w,       -spoke_half_w );
+                spoke.Append( -spoke_half_w,       reliefBB.GetBottom() );
+                spoke.Append( 0,                   reliefBB.GetBottom() );  // test pt
+                spoke.Append( +spoke_half_w,       reliefBB.GetBottom() );
+                break;
 
-                spoke.Rotate( -DECIDEG2RAD( padAngle ) );
-                spoke.Move( shapePos );
+            case 1:       // upper stub
+                spoke.Append( +spoke_half_w,       spoke_half_w );
+                spoke.Append( -spoke_half_w,       spoke_half_w );
+                spoke.Append( -spoke_half_w,       reliefBB.GetTop() );
+                spoke.Append( 0,                   reliefBB.GetTop() );     // test pt
+                spoke.Append( +spoke_half_w,       reliefBB.GetTop() );
+                break;
 
-                spoke.SetClosed( true );
-                spoke.GenerateBBoxCache();
-                aSpokesList.push_back( std::move( spoke ) );
+            case 2:       // right stub
+                spoke.Append( -spoke_half_w,       spoke_half_w );
+                spoke.Append( -spoke_half_w,       -spoke_half_w );
+                spoke.Append( reliefBB.GetRight(), -spoke_half_w );
+                spoke.Append( reliefBB.GetRight(), 0 );                     // test pt
+                spoke.Append( reliefBB.GetRight(), spoke_half_w );
+                break;
+
+            case 3:       // left stub
+                spoke.Append( spoke_half_w,        spoke_half_w );
+                spoke.Append( spoke_half_w,        -spoke_half_w );
+                spoke.Append( reliefBB.GetLeft(),  -spoke_half_w );
+                spoke.Append( reliefBB.GetLeft(),  0 );                     // test pt
+                spoke.Append( reliefBB.GetLeft(),  spoke_half_w );
+                break;
             }
+
+            spoke.Rotate( -DECIDEG2RAD( padAngle ) );
+            spoke.Move( shapePos );
+
+            spoke.SetClosed( true );
+            spoke.GenerateBBoxCache();
+            aSpokesList.push_back( std::move( spoke ) );
         }
     }
 }
@@ -26,6 +26,8 @@
 #ifndef __ZONE_FILLER_H
 #define __ZONE_FILLER_H
 
+#include <map>
+#include <memory>
 #include <vector>
 #include <class_zone.h>
 
@@ -47,6 +49,21 @@ public:
 
 private:
 
+    /**
+     * Function buildPadIndex
+     * Groups the board's pads by net and indexes each group spatially, so that zones only
+     * visit the pads of their own net which lie near them.
+     */
+    void buildPadIndex();
+
+    /**
+     * Function collectThermalPads
+     * Returns (in board order) the pads which may have a thermal connection with the given
+     * zone: those of the zone's net whose bounding box, inflated by the largest thermal gap
+     * of the net, reaches the zone's bounding box.
+     */
+    void collectThermalPads( const ZONE_CONTAINER* aZone, std::vector<D_PAD*>& aPads ) const;
+
     void addKnockout( D_PAD* aPad, int aGap, SHAPE_POLY_SET& aHoles );
 
     void addKnockout( BOARD_ITEM* aItem, int aGap, bool aIgnoreLineWidth, SHAPE_POLY_SET& aHoles );
@@ -109,6 +126,11 @@ private:
                                         // false if not (not closed outlines for instance)
     COMMIT* m_commit;
     WX_PROGRESS_REPORTER* m_progressReporter;
+
+    struct NET_PADS;
+    std::map<int, std::unique_ptr<NET_PADS>> m_padIndex;    // pads by net code, see
+                                                            // buildPadIndex()
+
     std::unique_ptr<WX_PROGRESS_REPORTER> m_uniqueReporter;
 
     // m_high_def can be used to define a high definition arc to polygon approximation
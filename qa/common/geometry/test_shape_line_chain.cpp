@@ -59,4 +59,95 @@ BOOST_AUTO_TEST_CASE( ArcToPolyline )
 }
 
 
+/**
+ * Long chains build a segment index after being queried a few times.  Check that indexed
+ * queries return exactly what the linear scan of a fresh copy returns, also after the
+ * chain has been modified.
+ */
+BOOST_AUTO_TEST_CASE( IndexedQueries )
+{
+    SHAPE_LINE_CHAIN chain;
+
+    // A closed, wavy ring: plenty of segments near any test point
+    for( int i = 0; i < 720; i++ )
+    {
+        double angle = M_PI * i / 360.0;
+        double radius = 100000.0 + ( i % 2 ? 5000.0 : 0.0 ) + ( i % 7 ) * 1000.0;
+
+        chain.Append( VECTOR2I( radius * cos( angle ), radius * sin( angle ) ) );
+    }
+
+    chain.SetClosed( true );
+
+    const std::vector<VECTOR2I> points = {
+        { 0, 0 },
+        { 100000, 0 },
+        { 102000, 0 },
+        { 104000, 1000 },
+        { -99000, 500 },
+        { 150000, -150000 },
+        { 0, 120000 },
+        chain.CPoint( 17 ),
+        chain.CPoint( 17 ) + VECTOR2I( 1, 1 ),
+    };
+
+    for( int pass = 0; pass < 2; pass++ )
+    {
+        for( int repeat = 0; repeat < 3; repeat++ )
+        {
+            for( const VECTOR2I& p : points )
+            {
+                BOOST_TEST_CONTEXT( "Point " << p << ", pass " << pass )
+                {
+                    const SEG seg( p, p + VECTOR2I( 3000, -2000 ) );
+
+                    BOOST_CHECK_EQUAL( chain.PointInside( p ),
+                                       SHAPE_LINE_CHAIN( chain ).PointInside( p ) );
+                    BOOST_CHECK_EQUAL( chain.PointInside( p, 10 ),
+                                       SHAPE_LINE_CHAIN( chain ).PointInside( p, 10 ) );
+                    BOOST_CHECK_EQUAL( chain.EdgeContainingPoint( p, 2 ),
+                                       SHAPE_LINE_CHAIN( chain ).EdgeContainingPoint( p, 2 ) );
+                    BOOST_CHECK_EQUAL( chain.Distance( p, true ),
+                                       SHAPE_LINE_CHAIN( chain ).Distance( p, true ) );
+                    BOOST_CHECK_EQUAL( chain.Collide( seg, 500 ),
+                                       SHAPE_LINE_CHAIN( chain ).Collide( seg, 500 ) );
+                    BOOST_CHECK_EQUAL( chain.Collide( p, 5000 ),
+                                       SHAPE_LINE_CHAIN( chain ).Collide( p, 5000 ) );
+                    BOOST_CHECK( chain.BBox() == SHAPE_LINE_CHAIN( chain ).BBox() );
+                }
+            }
+        }
+
+        // The index must be dropped when the chain changes
+        chain.SetPoint( 0, VECTOR2I( 0, 0 ) );
+        chain.Move( VECTOR2I( 3000, 1000 ) );
+    }
+}
+
+
+/**
+ * The box pruning of Collide() and Distance() must hold for segments pointing in the
+ * negative direction and for points right of or below the segment boxes
+ */
+BOOST_AUTO_TEST_CASE( PruningDirections )
+{
+    SHAPE_LINE_CHAIN line;
+    line.Append( VECTOR2I( 0, 0 ) );
+    line.Append( VECTOR2I( 1000, 0 ) );
+
+    BOOST_CHECK( line.Collide( SEG( VECTOR2I( 500, 300 ), VECTOR2I( 400, 100 ) ), 150 ) );
+    BOOST_CHECK( !line.Collide( SEG( VECTOR2I( 500, 300 ), VECTOR2I( 400, 200 ) ), 150 ) );
+
+    BOX2I box( VECTOR2I( 0, 0 ), VECTOR2I( 10, 10 ) );
+
+    BOX2I::ecoord_type right = box.SquaredDistance( VECTOR2I( 20, 5 ) );
+    BOX2I::ecoord_type below = box.SquaredDistance( VECTOR2I( 5, 14 ) );
+    BOX2I::ecoord_type inside = box.SquaredDistance( VECTOR2I( 5, 5 ) );
+
+    BOOST_CHECK_EQUAL( right, 100 );
+    BOOST_CHECK_EQUAL( below, 16 );
+    BOOST_CHECK_EQUAL( inside, 0 );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
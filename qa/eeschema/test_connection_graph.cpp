@@ -0,0 +1,559 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the incremental updates of CONNECTION_GRAPH
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+// Code under test
+#include <connection_graph.h>
+
+#include <class_libentry.h>
+#include <general.h>
+#include <lib_pin.h>
+#include <sch_bus_entry.h>
+#include <sch_component.h>
+#include <sch_line.h>
+#include <sch_pin.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_sheet_path.h>
+#include <sch_text.h>
+
+#include <map>
+#include <memory>
+#include <set>
+
+
+/**
+ * A schematic made of a root sheet and one subsheet, with its own connection graph.  The
+ * same edits are made on two of them, one updated incrementally and the other one
+ * recalculated from scratch.
+ *
+ * All the connectable items, including the sheet and component pins, are numbered in the
+ * order they are added, so the items of the two schematics can be compared.
+ */
+class TEST_SCHEMATIC
+{
+public:
+    enum SHEET
+    {
+        ROOT = 0,
+        SUB
+    };
+
+    TEST_SCHEMATIC() : m_root( new SCH_SHEET() ), m_graph( nullptr )
+    {
+        m_root->SetScreen( new SCH_SCREEN( nullptr ) );
+        m_root->SetFileName( "root.sch" );
+
+        m_sub = new SCH_SHEET( wxPoint( 10000, 0 ) );
+        m_sub->SetSize( wxSize( 2000, 4000 ) );
+        m_sub->SetScreen( new SCH_SCREEN( nullptr ) );
+        m_sub->SetFileName( "sub.sch" );
+        m_sub->GetFields()[SHEETNAME].SetText( "Sub" );
+        m_root->GetScreen()->Append( m_sub );
+
+        m_paths[ROOT].push_back( m_root.get() );
+        m_paths[SUB] = m_paths[ROOT];
+        m_paths[SUB].push_back( m_sub );
+    }
+
+    size_t AddWire( const wxPoint& aStart, const wxPoint& aEnd, SHEET aSheet = ROOT )
+    {
+        SCH_LINE* wire = new SCH_LINE( aStart, LAYER_WIRE );
+        wire->SetEndPoint( aEnd );
+        return add( wire, aSheet );
+    }
+
+    size_t AddBus( const wxPoint& aStart, const wxPoint& aEnd, SHEET aSheet = ROOT )
+    {
+        SCH_LINE* bus = new SCH_LINE( aStart, LAYER_BUS );
+        bus->SetEndPoint( aEnd );
+        return add( bus, aSheet );
+    }
+
+    size_t AddBusEntry( const wxPoint& aPos, SHEET aSheet = ROOT )
+    {
+        return add( new SCH_BUS_WIRE_ENTRY( aPos ), aSheet );
+    }
+
+    size_t AddLabel( const wxPoint& aPos, const wxString& aText, SHEET aSheet = ROOT )
+    {
+        return add( new SCH_LABEL( aPos, aText ), aSheet );
+    }
+
+    size_t AddGlobalLabel( const wxPoint& aPos, const wxString& aText, SHEET aSheet = ROOT )
+    {
+        return add( new SCH_GLOBALLABEL( aPos, aText ), aSheet );
+    }
+
+    /// Adds a hierarchical label to the subsheet
+    size_t AddHierLabel( const wxPoint& aPos, const wxString& aText )
+    {
+        return add( new SCH_HIERLABEL( aPos, aText ), SUB );
+    }
+
+    /// Adds a pin to the subsheet, on the root sheet
+    size_t AddSheetPin( const wxPoint& aPos, const wxString& aText )
+    {
+        SCH_SHEET_PIN* pin = new SCH_SHEET_PIN( m_sub, aPos, aText );
+        m_sub->AddPin( pin );
+
+        return addItem( pin, m_sub, ROOT );
+    }
+
+    /**
+     * Adds a component of \a aPart.  Its pins are numbered right after the component.
+     *
+     * @return the index of the component
+     */
+    size_t AddComponent( LIB_PART& aPart, const wxPoint& aPos, const wxString& aRef,
+                         SHEET aSheet = ROOT )
+    {
+        SCH_COMPONENT* component = new SCH_COMPONENT( aPart, LIB_ID( "Test", aPart.GetName() ),
+                                                      &m_paths[aSheet], 1, 0, aPos );
+        component->SetRef( &m_paths[aSheet], aRef );
+
+        size_t index = add( component, aSheet );
+
+        for( SCH_PIN* pin : component->GetSchPins( &m_paths[aSheet] ) )
+            addItem( pin, component, aSheet );
+
+        return index;
+    }
+
+    /// @return the position of the item at \a aIndex, for instance to attach a wire to a pin
+    wxPoint GetPosition( size_t aIndex ) const
+    {
+        return m_items[aIndex].m_item->GetPosition();
+    }
+
+    /// @return the connection point of the item at \a aIndex opposite to its position
+    wxPoint GetEnd( size_t aIndex ) const
+    {
+        std::vector<wxPoint> points;
+        m_items[aIndex].m_item->GetConnectionPoints( points );
+
+        return points.back();
+    }
+
+    void SetText( size_t aIndex, const wxString& aText )
+    {
+        static_cast<SCH_TEXT*>( m_items[aIndex].m_item )->SetText( aText );
+        m_items[aIndex].m_item->SetConnectivityDirty();
+    }
+
+    void Remove( size_t aIndex )
+    {
+        const ITEM& item = m_items[aIndex];
+
+        // Pins are removed with their parent only
+        BOOST_REQUIRE( item.m_owner == item.m_item );
+
+        m_paths[item.m_sheet].LastScreen()->Remove( item.m_item );
+        m_removed.emplace_back( item.m_item );
+    }
+
+    void Recalculate( bool aUnconditional )
+    {
+        g_RootSheet = m_root.get();
+        g_ConnectionGraph = &m_graph;
+
+        m_graph.Recalculate( SCH_SHEET_LIST( m_root.get() ), aUnconditional );
+
+        g_ConnectionGraph = nullptr;
+        g_RootSheet = nullptr;
+    }
+
+    /**
+     * @return the net name of the item at \a aIndex, empty if the item is unconnected or not
+     *         part of the schematic anymore
+     */
+    wxString NetName( size_t aIndex ) const
+    {
+        const ITEM&     item = m_items[aIndex];
+        SCH_CONNECTION* connection = item.m_item->Connection( m_paths[item.m_sheet] );
+
+        if( !isPlaced( item ) || !connection )
+            return wxEmptyString;
+
+        return connection->Name();
+    }
+
+    /**
+     * Describes the connectivity of the item at \a aIndex: its net name, the items of its
+     * subgraph, and the subgraphs this one is linked to through the hierarchy and buses.
+     * The subgraphs are described by their sheet and item numbers, so the descriptions of
+     * two schematics built alike can be compared.
+     */
+    wxString Describe( size_t aIndex ) const
+    {
+        const ITEM& item = m_items[aIndex];
+
+        if( !isPlaced( item ) )
+            return wxEmptyString;
+
+        const CONNECTION_SUBGRAPH* subgraph =
+                m_graph.GetSubgraphForItem( item.m_item, m_paths[item.m_sheet] );
+
+        if( !subgraph )
+            return "unconnected";
+
+        std::set<const CONNECTION_SUBGRAPH*> subgraphs = getSubgraphs();
+        wxString desc = NetName( aIndex ) + " in " + describeSubgraph( subgraph, subgraphs );
+
+        if( subgraph->m_hier_parent )
+            desc += ", parent " + describeSubgraph( subgraph->m_hier_parent, subgraphs );
+
+        desc += describeLinks( "bus neighbors", subgraph->m_bus_neighbors, subgraphs );
+        desc += describeLinks( "bus parents", subgraph->m_bus_parents, subgraphs );
+
+        return desc;
+    }
+
+    size_t GetCount() const { return m_items.size(); }
+
+private:
+    typedef std::unordered_map<std::shared_ptr<SCH_CONNECTION>,
+                               std::unordered_set<CONNECTION_SUBGRAPH*>> SUBGRAPH_LINKS;
+
+    struct ITEM
+    {
+        SCH_ITEM* m_item;
+        SCH_ITEM* m_owner;      ///< The item on the screen: the item, or the parent of a pin
+        SHEET     m_sheet;
+    };
+
+    size_t add( SCH_ITEM* aItem, SHEET aSheet )
+    {
+        m_paths[aSheet].LastScreen()->Append( aItem );
+        return addItem( aItem, aItem, aSheet );
+    }
+
+    size_t addItem( SCH_ITEM* aItem, SCH_ITEM* aOwner, SHEET aSheet )
+    {
+        m_index[aItem] = m_items.size();
+        m_items.push_back( { aItem, aOwner, aSheet } );
+        return m_items.size() - 1;
+    }
+
+    bool isPlaced( const ITEM& aItem ) const
+    {
+        return m_paths[aItem.m_sheet].LastScreen()->CheckIfOnDrawList( aItem.m_owner );
+    }
+
+    /// @return the subgraphs holding the items still in the schematic
+    std::set<const CONNECTION_SUBGRAPH*> getSubgraphs() const
+    {
+        std::set<const CONNECTION_SUBGRAPH*> subgraphs;
+
+        for( const ITEM& item : m_items )
+        {
+            if( isPlaced( item ) )
+                subgraphs.insert( m_graph.GetSubgraphForItem( item.m_item,
+                                                              m_paths[item.m_sheet] ) );
+        }
+
+        subgraphs.erase( nullptr );
+        return subgraphs;
+    }
+
+    /**
+     * @param aSubgraphs are the valid subgraphs: pointers to other ones are reported, and not
+     *                   dereferenced as they may have been deleted
+     */
+    wxString describeSubgraph( const CONNECTION_SUBGRAPH*                  aSubgraph,
+                               const std::set<const CONNECTION_SUBGRAPH*>& aSubgraphs ) const
+    {
+        if( !aSubgraphs.count( aSubgraph ) )
+            return "stale subgraph";
+
+        std::set<size_t> indices;
+
+        for( SCH_ITEM* item : aSubgraph->m_items )
+        {
+            auto it = m_index.find( item );
+            indices.insert( it != m_index.end() ? it->second : m_items.size() );
+        }
+
+        wxString desc = aSubgraph->m_sheet.PathHumanReadable() + " {";
+
+        for( size_t index : indices )
+            desc += wxString::Format( " %lu", (unsigned long) index );
+
+        return desc + " }";
+    }
+
+    wxString describeLinks( const wxString& aName, const SUBGRAPH_LINKS& aLinks,
+                            const std::set<const CONNECTION_SUBGRAPH*>& aSubgraphs ) const
+    {
+        std::set<wxString> links;
+
+        for( const auto& link : aLinks )
+        {
+            for( const CONNECTION_SUBGRAPH* subgraph : link.second )
+                links.insert( link.first->Name() + " -> "
+                              + describeSubgraph( subgraph, aSubgraphs ) );
+        }
+
+        wxString desc;
+
+        for( const wxString& link : links )
+            desc += ", " + aName + " " + link;
+
+        return desc;
+    }
+
+    std::unique_ptr<SCH_SHEET>             m_root;
+    SCH_SHEET*                             m_sub;       ///< Owned by the root screen
+    SCH_SHEET_PATH                         m_paths[2];
+    CONNECTION_GRAPH                       m_graph;
+    std::vector<ITEM>                      m_items;
+    std::map<const SCH_ITEM*, size_t>      m_index;
+
+    // Removed items are kept alive until the end of the test, so their indices remain valid
+    std::vector<std::unique_ptr<SCH_ITEM>> m_removed;
+};
+
+
+class TEST_CONNECTION_GRAPH_FIXTURE
+{
+public:
+    TEST_CONNECTION_GRAPH_FIXTURE() : m_part( "U", nullptr )
+    {
+        LIB_PIN* pin = new LIB_PIN( &m_part );
+        pin->SetNumber( "1" );
+        pin->SetName( "A" );
+        pin->SetType( ELECTRICAL_PINTYPE::PT_PASSIVE );
+        pin->SetPosition( wxPoint( -200, 0 ) );
+        m_part.AddDrawItem( pin );
+
+        pin = new LIB_PIN( &m_part );
+        pin->SetNumber( "2" );
+        pin->SetName( "VCC" );
+        pin->SetType( ELECTRICAL_PINTYPE::PT_POWER_IN );
+        pin->SetVisible( false );
+        pin->SetPosition( wxPoint( 0, 200 ) );
+        m_part.AddDrawItem( pin );
+    }
+
+    /**
+     * Recalculates both schematics and checks they have the same connectivity.
+     */
+    void CheckNets()
+    {
+        m_incremental.Recalculate( false );
+        m_full.Recalculate( true );
+
+        BOOST_REQUIRE_EQUAL( m_incremental.GetCount(), m_full.GetCount() );
+
+        for( size_t i = 0; i < m_full.GetCount(); i++ )
+        {
+            BOOST_TEST_CONTEXT( "Item " << i )
+            {
+                BOOST_CHECK_EQUAL( m_incremental.NetName( i ), m_full.NetName( i ) );
+                BOOST_CHECK_EQUAL( m_incremental.Describe( i ), m_full.Describe( i ) );
+            }
+        }
+    }
+
+    LIB_PART       m_part;     ///< One passive pin and one invisible power pin
+    TEST_SCHEMATIC m_incremental;
+    TEST_SCHEMATIC m_full;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ConnectionGraph, TEST_CONNECTION_GRAPH_FIXTURE )
+
+
+/**
+ * Check that an incremental update after each edit gives the same nets as a full
+ * recalculation of the same schematic
+ */
+BOOST_AUTO_TEST_CASE( IncrementalUpdate )
+{
+    for( TEST_SCHEMATIC* schematic : { &m_incremental, &m_full } )
+    {
+        // Two wires joined by a local label
+        schematic->AddWire( wxPoint( 0, 0 ), wxPoint( 1000, 0 ) );
+        schematic->AddLabel( wxPoint( 0, 0 ), "A" );
+        schematic->AddWire( wxPoint( 0, 1000 ), wxPoint( 1000, 1000 ) );
+        schematic->AddLabel( wxPoint( 1000, 1000 ), "A" );
+
+        schematic->AddWire( wxPoint( 2000, 0 ), wxPoint( 3000, 0 ) );
+        schematic->AddLabel( wxPoint( 3000, 0 ), "B" );
+
+        // Two wires joined by a global label
+        schematic->AddWire( wxPoint( 0, 2000 ), wxPoint( 1000, 2000 ) );
+        schematic->AddGlobalLabel( wxPoint( 0, 2000 ), "G" );
+        schematic->AddWire( wxPoint( 2000, 2000 ), wxPoint( 3000, 2000 ) );
+        schematic->AddGlobalLabel( wxPoint( 3000, 2000 ), "G" );
+
+        // An undriven wire
+        schematic->AddWire( wxPoint( 0, 3000 ), wxPoint( 1000, 3000 ) );
+    }
+
+    m_incremental.Recalculate( true );
+
+    CheckNets();
+    BOOST_CHECK_EQUAL( m_full.NetName( 2 ), m_full.NetName( 0 ) );
+    BOOST_CHECK_EQUAL( m_full.NetName( 6 ), m_full.NetName( 8 ) );
+
+    // Join the nets A and B with a wire
+    for( TEST_SCHEMATIC* schematic : { &m_incremental, &m_full } )
+        schematic->AddWire( wxPoint( 1000, 0 ), wxPoint( 2000, 0 ) );
+
+    CheckNets();
+    BOOST_CHECK_EQUAL( m_full.NetName( 4 ), m_full.NetName( 0 ) );
+
+    // Rename a label of the joined net
+    for( TEST_SCHEMATIC* schematic : { &m_incremental, &m_full } )
+        schematic->SetText( 1, "C" );
+
+    CheckNets();
+
+    // Disconnect a wire from its global net
+    for( TEST_SCHEMATIC* schematic : { &m_incremental, &m_full } )
+        schematic->Remove( 9 );
+
+    CheckNets();
+    BOOST_CHECK( m_full.NetName( 8 ) != m_full.NetName( 6 ) );
+
+    // Connect the undriven wire to a local net
+    for( TEST_SCHEMATIC* schematic : { &m_incremental, &m_full } )
+        schematic->AddLabel( wxPoint( 1000, 3000 ), "A" );
+
+    CheckNets();
+    BOOST_CHECK_EQUAL( m_full.NetName( 10 ), m_full.NetName( 2 ) );
+}
+
+
+/**
+ * Same as IncrementalUpdate, with the links the incremental update must keep or rebuild
+ * between subgraphs: a net and a bus going down to the subsheet, bus members, component
+ * pins and an invisible power pin joined to a global label of the subsheet
+ */
+BOOST_AUTO_TEST_CASE( IncrementalHierarchy )
+{
+    typedef TEST_SCHEMATIC::SHEET SHEET;
+
+    size_t inWire = 0, inPin = 0, busEntry = 0, memberWire = 0, memberLabel = 0;
+    size_t pin1 = 0, pin1Wire = 0, powerPin = 0;
+    size_t subInWire = 0, subInLabel = 0, subMemberLabel = 0, subVccWire = 0, subVccLabel = 0;
+
+    for( TEST_SCHEMATIC* schematic : { &m_incremental, &m_full } )
+    {
+        // A net and a bus going to the subsheet pins
+        inWire = schematic->AddWire( wxPoint( 8000, 500 ), wxPoint( 10000, 500 ) );
+        schematic->AddLabel( wxPoint( 8000, 500 ), "IN" );
+        schematic->AddBus( wxPoint( 7000, 1500 ), wxPoint( 10000, 1500 ) );
+        schematic->AddLabel( wxPoint( 7000, 1500 ), "D[0..3]" );
+        inPin = schematic->AddSheetPin( wxPoint( 10000, 500 ), "IN" );
+        schematic->AddSheetPin( wxPoint( 10000, 1500 ), "D[0..3]" );
+
+        // A bus member taken out of the bus
+        busEntry = schematic->AddBusEntry( wxPoint( 8000, 1500 ) );
+        wxPoint entryEnd = schematic->GetEnd( busEntry );
+        memberWire = schematic->AddWire( entryEnd, entryEnd + wxPoint( 0, 1000 ) );
+        memberLabel = schematic->AddLabel( entryEnd + wxPoint( 0, 1000 ), "D0" );
+
+        // A component with its first pin on a wire and its invisible power pin
+        size_t component = schematic->AddComponent( m_part, wxPoint( 2000, 3000 ), "U1" );
+        pin1 = component + 1;
+        powerPin = component + 2;
+        pin1Wire = schematic->AddWire( schematic->GetPosition( pin1 ), wxPoint( 4000, 3000 ) );
+
+        // The same in the subsheet, with another bus member
+        subInWire = schematic->AddWire( wxPoint( 0, 500 ), wxPoint( 2000, 500 ), SHEET::SUB );
+        subInLabel = schematic->AddHierLabel( wxPoint( 0, 500 ), "IN" );
+        schematic->AddBus( wxPoint( 0, 1500 ), wxPoint( 3000, 1500 ), SHEET::SUB );
+        schematic->AddHierLabel( wxPoint( 0, 1500 ), "D[0..3]" );
+
+        size_t subEntry = schematic->AddBusEntry( wxPoint( 1000, 1500 ), SHEET::SUB );
+        entryEnd = schematic->GetEnd( subEntry );
+        schematic->AddWire( entryEnd, entryEnd + wxPoint( 0, 1000 ), SHEET::SUB );
+        subMemberLabel = schematic->AddLabel( entryEnd + wxPoint( 0, 1000 ), "D1", SHEET::SUB );
+
+        // A global label joining the power pin net
+        subVccWire = schematic->AddWire( wxPoint( 0, 3000 ), wxPoint( 2000, 3000 ), SHEET::SUB );
+        subVccLabel = schematic->AddGlobalLabel( wxPoint( 0, 3000 ), "VCC", SHEET::SUB );
+    }
+
+    m_incremental.Recalculate( true );
+
+    CheckNets();
+    BOOST_CHECK_EQUAL( m_full.NetName( subInWire ), m_full.NetName( inWire ) );
+    BOOST_CHECK( m_full.Describe( subInWire ).Contains( ", parent " ) );
+    BOOST_CHECK( m_full.Describe( memberWire ).Contains( ", bus parents " ) );
+    BOOST_CHECK_EQUAL( m_full.NetName( subVccWire ), m_full.NetName( powerPin ) );
+
+    // Break the link to the sheet pin from the subsheet, then restore it from the root sheet
+    for( TEST_SCHEMATIC* schematic : { &m_incremental, &m_full } )
+        schematic->SetText( subInLabel, "IN2" );
+
+    CheckNets();
+    BOOST_CHECK( m_full.NetName( subInWire ) != m_full.NetName( inWire ) );
+
+    for( TEST_SCHEMATIC* schematic : { &m_incremental, &m_full } )
+        schematic->SetText( inPin, "IN2" );
+
+    CheckNets();
+    BOOST_CHECK_EQUAL( m_full.NetName( subInWire ), m_full.NetName( inWire ) );
+
+    // Change the bus members taken out of the buses, on both sheets
+    for( TEST_SCHEMATIC* schematic : { &m_incremental, &m_full } )
+        schematic->SetText( subMemberLabel, "D2" );
+
+    CheckNets();
+
+    for( TEST_SCHEMATIC* schematic : { &m_incremental, &m_full } )
+        schematic->SetText( memberLabel, "D4" );
+
+    CheckNets();
+
+    for( TEST_SCHEMATIC* schematic : { &m_incremental, &m_full } )
+        schematic->Remove( busEntry );
+
+    CheckNets();
+
+    // Connect the component pin to the net going to the subsheet
+    for( TEST_SCHEMATIC* schematic : { &m_incremental, &m_full } )
+        schematic->AddWire( wxPoint( 4000, 3000 ), wxPoint( 8000, 500 ) );
+
+    CheckNets();
+    BOOST_CHECK_EQUAL( m_full.NetName( pin1 ), m_full.NetName( inWire ) );
+    BOOST_CHECK_EQUAL( m_full.NetName( pin1Wire ), m_full.NetName( subInWire ) );
+
+    // Take the global label of the subsheet off the power net
+    for( TEST_SCHEMATIC* schematic : { &m_incremental, &m_full } )
+        schematic->SetText( subVccLabel, "VDD" );
+
+    CheckNets();
+    BOOST_CHECK( m_full.NetName( subVccWire ) != m_full.NetName( powerPin ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,470 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the similar labels ERC check (NETLIST_OBJECT_LIST::TestforSimilarLabels)
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+// Code under test
+#include <netlist_object.h>
+
+#include <erc.h>
+#include <sch_marker.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_sheet_path.h>
+#include <sch_text.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+
+
+/**
+ * A root sheet and sub-sheets, with a netlist made of hand placed or generated labels.
+ */
+class TEST_ERC_SIMILAR_LABELS_FIXTURE
+{
+public:
+    TEST_ERC_SIMILAR_LABELS_FIXTURE()
+    {
+        for( int i = 0; i < 4; ++i )
+            AddSheet();
+    }
+
+    /**
+     * Add a sheet.  The first sheet is the root sheet, the next ones are its sub-sheets.
+     */
+    void AddSheet()
+    {
+        m_sheets.emplace_back( new SCH_SHEET() );
+        m_sheets.back()->SetScreen( new SCH_SCREEN( nullptr ) );
+
+        SCH_SHEET_PATH path;
+        path.push_back( m_sheets[0].get() );
+
+        if( m_sheets.size() > 1 )
+            path.push_back( m_sheets.back().get() );
+
+        m_paths.push_back( path );
+    }
+
+    /**
+     * Add a label named \a aName of type \a aType to the sheet path \a aSheet.
+     */
+    void AddLabel( NETLIST_ITEM aType, int aSheet, const wxString& aName )
+    {
+        wxPoint pos( (int) m_items.size() * 100, 0 );
+
+        m_items.emplace_back( new SCH_LABEL( pos, aName ) );
+
+        NETLIST_OBJECT* label = new NETLIST_OBJECT();
+        label->m_Type = aType;
+        label->m_Comp = m_items.back().get();
+        label->m_SheetPath = m_paths[aSheet];
+        label->m_Label = aName;
+        label->m_Start = pos;
+
+        m_list.push_back( label );
+    }
+
+    /**
+     * Add \a aCount labels with random names, types and sheets.  The names are "net0" to
+     * "net63", with some of their first letters upper cased, so many of them only differ
+     * by case.
+     */
+    void GenerateLabels( int aCount, unsigned aSeed )
+    {
+        const NETLIST_ITEM types[] = { NETLIST_ITEM::LABEL, NETLIST_ITEM::GLOBLABEL,
+                                       NETLIST_ITEM::HIERLABEL, NETLIST_ITEM::PINLABEL,
+                                       NETLIST_ITEM::SHEETLABEL };
+
+        std::mt19937                       rng( aSeed );
+        std::uniform_int_distribution<int> nameDist( 0, 63 );
+        std::uniform_int_distribution<int> caseDist( 0, 3 );
+        std::uniform_int_distribution<int> typeDist( 0, 4 );
+        std::uniform_int_distribution<int> sheetDist( 0, (int) m_paths.size() - 1 );
+
+        for( int i = 0; i < aCount; ++i )
+        {
+            wxString name = wxString::Format( "net%d", nameDist( rng ) );
+
+            for( size_t c = 0; c < 3; ++c )
+            {
+                if( caseDist( rng ) == 0 )
+                    name.replace( c, 1, name.Mid( c, 1 ).Upper() );
+            }
+
+            NETLIST_ITEM type = types[typeDist( rng )];
+
+            AddLabel( type, sheetDist( rng ), name );
+        }
+    }
+
+    /**
+     * @return the similar label markers of the sheet \a aSheet, in the order they were
+     *         added, as "<main item index> -> <aux item index>"
+     */
+    std::vector<std::string> GetMarkers( int aSheet )
+    {
+        std::vector<std::string> markers;
+
+        for( SCH_ITEM* item : m_sheets[aSheet]->GetScreen()->Items().OfType( SCH_MARKER_T ) )
+        {
+            const RC_ITEM* rcItem = static_cast<SCH_MARKER*>( item )->GetRCItem();
+
+            if( rcItem->GetErrorCode() == ERCE_SIMILAR_LABELS )
+                markers.push_back( markerName( rcItem->GetMainItemID(), rcItem->GetAuxItemID() ) );
+        }
+
+        return markers;
+    }
+
+    /// @return the similar label markers of all the sheets
+    std::multiset<std::string> GetAllMarkers()
+    {
+        std::multiset<std::string> markers;
+
+        for( size_t i = 0; i < m_sheets.size(); ++i )
+        {
+            for( const std::string& marker : GetMarkers( i ) )
+                markers.insert( marker );
+        }
+
+        return markers;
+    }
+
+    /**
+     * The similar labels check as it was written before the labels were indexed: every
+     * pair of labels is compared, and identical labels are counted by scanning the list.
+     *
+     * @return the markers expected for m_list, named as by GetMarkers()
+     */
+    std::multiset<std::string> ReferenceSimilarLabels();
+
+    std::vector<std::unique_ptr<SCH_SHEET>> m_sheets;
+    std::vector<SCH_SHEET_PATH>             m_paths;
+    std::vector<std::unique_ptr<SCH_LABEL>> m_items;
+    NETLIST_OBJECT_LIST                     m_list;
+
+private:
+    int indexOf( const KIID& aId ) const
+    {
+        for( size_t i = 0; i < m_items.size(); ++i )
+        {
+            if( m_items[i]->m_Uuid == aId )
+                return (int) i;
+        }
+
+        return -1;
+    }
+
+    std::string markerName( const KIID& aMainItem, const KIID& aAuxItem ) const
+    {
+        return std::to_string( indexOf( aMainItem ) ) + " -> "
+               + std::to_string( indexOf( aAuxItem ) );
+    }
+};
+
+
+static bool isCheckedLabel( const NETLIST_OBJECT* aItem )
+{
+    switch( aItem->m_Type )
+    {
+    case NETLIST_ITEM::LABEL:
+    case NETLIST_ITEM::BUSLABELMEMBER:
+    case NETLIST_ITEM::PINLABEL:
+    case NETLIST_ITEM::GLOBBUSLABELMEMBER:
+    case NETLIST_ITEM::HIERLABEL:
+    case NETLIST_ITEM::HIERBUSLABELMEMBER:
+    case NETLIST_ITEM::GLOBLABEL:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+std::multiset<std::string> TEST_ERC_SIMILAR_LABELS_FIXTURE::ReferenceSimilarLabels()
+{
+    std::multiset<std::string>   markers;
+    std::vector<NETLIST_OBJECT*> labels;
+    std::vector<NETLIST_OBJECT*> unique;
+
+    auto fullName = []( const NETLIST_OBJECT* aLabel )
+    {
+        return aLabel->m_SheetPath.PathAsString() + aLabel->m_Label;
+    };
+
+    for( NETLIST_OBJECT* item : m_list )
+    {
+        if( !isCheckedLabel( item ) )
+            continue;
+
+        labels.push_back( item );
+
+        // One label per sheet path and name: the first one found
+        if( std::none_of( unique.begin(), unique.end(),
+                          [&]( NETLIST_OBJECT* aOther )
+                          {
+                              return fullName( aOther ) == fullName( item );
+                          } ) )
+        {
+            unique.push_back( item );
+        }
+    }
+
+    auto count = [&]( const NETLIST_OBJECT* aRef )
+    {
+        return std::count_if( labels.begin(), labels.end(),
+                [&]( const NETLIST_OBJECT* aOther )
+                {
+                    if( aRef->IsLabelGlobal() )
+                        return aOther->IsLabelGlobal() && aOther->m_Label == aRef->m_Label;
+
+                    return aOther->m_Label == aRef->m_Label
+                           && aOther->m_SheetPath.Path() == aRef->m_SheetPath.Path();
+                } );
+    };
+
+    // The less used label is the main item
+    auto diagnose = [&]( const NETLIST_OBJECT* aA, const NETLIST_OBJECT* aB )
+    {
+        if( count( aA ) > count( aB ) )
+            std::swap( aA, aB );
+
+        markers.insert( markerName( aA->m_Comp->m_Uuid, aB->m_Comp->m_Uuid ) );
+    };
+
+    // Keep the first of the labels with a given name, in name order
+    auto firstOfName = []( const std::vector<NETLIST_OBJECT*>& aLabels )
+    {
+        std::vector<NETLIST_OBJECT*> result;
+
+        for( NETLIST_OBJECT* label : aLabels )
+        {
+            if( std::none_of( result.begin(), result.end(),
+                              [&]( NETLIST_OBJECT* aOther )
+                              {
+                                  return aOther->m_Label == label->m_Label;
+                              } ) )
+            {
+                result.push_back( label );
+            }
+        }
+
+        std::sort( result.begin(), result.end(),
+                   []( const NETLIST_OBJECT* aA, const NETLIST_OBJECT* aB )
+                   {
+                       return aA->m_Label.Cmp( aB->m_Label ) < 0;
+                   } );
+
+        return result;
+    };
+
+    // The unique labels are visited in sheet path + name order
+    std::sort( unique.begin(), unique.end(),
+               [&]( const NETLIST_OBJECT* aA, const NETLIST_OBJECT* aB )
+               {
+                   return fullName( aA ).Cmp( fullName( aB ) ) < 0;
+               } );
+
+    std::vector<NETLIST_OBJECT*> globals;
+
+    for( NETLIST_OBJECT* label : unique )
+    {
+        if( label->IsLabelGlobal() )
+            globals.push_back( label );
+    }
+
+    globals = firstOfName( globals );
+
+    for( size_t i = 0; i < globals.size(); ++i )
+    {
+        for( size_t j = i + 1; j < globals.size(); ++j )
+        {
+            if( globals[i]->m_Label.CmpNoCase( globals[j]->m_Label ) == 0 )
+                diagnose( globals[i], globals[j] );
+        }
+    }
+
+    std::set<KIID_PATH> paths;
+
+    for( NETLIST_OBJECT* label : unique )
+        paths.insert( label->m_SheetPath.Path() );
+
+    for( const KIID_PATH& path : paths )
+    {
+        std::vector<NETLIST_OBJECT*> sheetLabels;
+
+        for( NETLIST_OBJECT* label : unique )
+        {
+            if( label->m_SheetPath.Path() == path )
+                sheetLabels.push_back( label );
+        }
+
+        sheetLabels = firstOfName( sheetLabels );
+
+        for( size_t i = 0; i < sheetLabels.size(); ++i )
+        {
+            for( size_t j = i + 1; j < sheetLabels.size(); ++j )
+            {
+                // Global labels were compared above
+                if( sheetLabels[i]->IsLabelGlobal() && sheetLabels[j]->IsLabelGlobal() )
+                    continue;
+
+                if( sheetLabels[i]->m_Label.CmpNoCase( sheetLabels[j]->m_Label ) == 0 )
+                    diagnose( sheetLabels[i], sheetLabels[j] );
+            }
+        }
+    }
+
+    return markers;
+}
+
+
+/**
+ * Declare the test suite
+ */
+BOOST_FIXTURE_TEST_SUITE( ErcSimilarLabels, TEST_ERC_SIMILAR_LABELS_FIXTURE )
+
+
+/**
+ * Labels which only differ by case are reported, identical ones are not.  The less used
+ * label is the main item of the marker.
+ */
+BOOST_AUTO_TEST_CASE( Simple )
+{
+    AddLabel( NETLIST_ITEM::LABEL, 1, "CLK" );
+    AddLabel( NETLIST_ITEM::LABEL, 1, "clk" );
+    AddLabel( NETLIST_ITEM::LABEL, 1, "CLK" );
+    AddLabel( NETLIST_ITEM::LABEL, 1, "data" );
+
+    m_list.TestforSimilarLabels();
+
+    const std::vector<std::string> expected = { "1 -> 0" };
+    const std::vector<std::string> markers = GetMarkers( 1 );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( markers.begin(), markers.end(),
+                                   expected.begin(), expected.end() );
+}
+
+
+/**
+ * Several similar pairs in a sheet are reported in name order.  When both labels are used
+ * as often, the first one in name order is the main item.
+ */
+BOOST_AUTO_TEST_CASE( NameOrder )
+{
+    AddLabel( NETLIST_ITEM::LABEL, 1, "b" );
+    AddLabel( NETLIST_ITEM::LABEL, 1, "B" );
+    AddLabel( NETLIST_ITEM::LABEL, 1, "B" );
+    AddLabel( NETLIST_ITEM::LABEL, 1, "a" );
+    AddLabel( NETLIST_ITEM::HIERLABEL, 1, "A" );
+
+    m_list.TestforSimilarLabels();
+
+    const std::vector<std::string> expected = { "4 -> 3", "0 -> 1" };
+    const std::vector<std::string> markers = GetMarkers( 1 );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( markers.begin(), markers.end(),
+                                   expected.begin(), expected.end() );
+}
+
+
+/**
+ * Global labels are compared across sheets, and against the local labels of their own
+ * sheet.  The marker is added to the sheet of its main item.
+ */
+BOOST_AUTO_TEST_CASE( GlobalLabels )
+{
+    AddLabel( NETLIST_ITEM::GLOBLABEL, 1, "VCC" );
+    AddLabel( NETLIST_ITEM::GLOBLABEL, 1, "VCC" );
+    AddLabel( NETLIST_ITEM::GLOBLABEL, 2, "Vcc" );
+    AddLabel( NETLIST_ITEM::GLOBLABEL, 3, "RESET" );
+    AddLabel( NETLIST_ITEM::LABEL, 3, "reset" );
+
+    m_list.TestforSimilarLabels();
+
+    const std::vector<std::string> expected2 = { "2 -> 0" };
+    const std::vector<std::string> markers2 = GetMarkers( 2 );
+
+    BOOST_CHECK( GetMarkers( 1 ).empty() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( markers2.begin(), markers2.end(),
+                                   expected2.begin(), expected2.end() );
+
+    const std::vector<std::string> expected3 = { "3 -> 4" };
+    const std::vector<std::string> markers3 = GetMarkers( 3 );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( markers3.begin(), markers3.end(),
+                                   expected3.begin(), expected3.end() );
+}
+
+
+/**
+ * Local labels of different sheets and sheet pins are not compared
+ */
+BOOST_AUTO_TEST_CASE( DifferentScopes )
+{
+    AddLabel( NETLIST_ITEM::LABEL, 1, "clk" );
+    AddLabel( NETLIST_ITEM::LABEL, 2, "CLK" );
+    AddLabel( NETLIST_ITEM::SHEETLABEL, 1, "Clk" );
+
+    m_list.TestforSimilarLabels();
+
+    for( int i = 0; i < 4; ++i )
+        BOOST_CHECK( GetMarkers( i ).empty() );
+}
+
+
+/**
+ * On a generated schematic with many sheets and labels, the indexed check reports the
+ * same markers as comparing every pair of labels
+ */
+BOOST_AUTO_TEST_CASE( MatchesPairwiseCheck )
+{
+    for( int i = 0; i < 12; ++i )
+        AddSheet();
+
+    GenerateLabels( 2000, 1234 );
+
+    const std::multiset<std::string> expected = ReferenceSimilarLabels();
+
+    m_list.TestforSimilarLabels();
+
+    const std::multiset<std::string> markers = GetAllMarkers();
+
+    // Make sure the generated schematic actually exercises the check
+    BOOST_CHECK_GT( expected.size(), 100u );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( markers.begin(), markers.end(),
+                                   expected.begin(), expected.end() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
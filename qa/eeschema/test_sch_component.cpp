@@ -0,0 +1,186 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the library symbols shared by SCH_COMPONENTs
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+// Code under test
+#include <sch_component.h>
+
+#include <class_libentry.h>
+#include <lib_pin.h>
+#include <sch_pin.h>
+#include <sch_screen.h>
+#include <sch_sheet_path.h>
+#include <symbol_lib_table.h>
+
+
+class TEST_SCH_COMPONENT_FIXTURE
+{
+public:
+    TEST_SCH_COMPONENT_FIXTURE() :
+            m_lib_part( "R", nullptr ),
+            m_lib_id( "Device", "R" )
+    {
+        LIB_PIN* pin = new LIB_PIN( &m_lib_part );
+        pin->SetNumber( "1" );
+        m_lib_part.AddDrawItem( pin );
+    }
+
+    /// @return the library pin the first pin of \a aComponent refers to
+    LIB_PIN* FirstLibPin( const SCH_COMPONENT& aComponent )
+    {
+        SCH_PIN_PTRS pins = aComponent.GetSchPins( &m_path );
+
+        BOOST_REQUIRE_EQUAL( pins.size(), 1u );
+        return pins[0]->GetLibPin();
+    }
+
+    LIB_PART       m_lib_part;
+    LIB_ID         m_lib_id;
+    SCH_SHEET_PATH m_path;
+};
+
+
+/**
+ * Declare the test suite
+ */
+BOOST_FIXTURE_TEST_SUITE( SchComponent, TEST_SCH_COMPONENT_FIXTURE )
+
+
+/**
+ * Copying or assigning a component shares its library symbol
+ */
+BOOST_AUTO_TEST_CASE( CopyAndAssign )
+{
+    SCH_COMPONENT original( m_lib_part, m_lib_id, nullptr, 1, 0, wxPoint( 0, 0 ) );
+    LIB_PART*     part = original.GetPartRef().get();
+
+    BOOST_REQUIRE( part != nullptr );
+    BOOST_CHECK( part != &m_lib_part );
+
+    SCH_COMPONENT copy( original );
+
+    BOOST_CHECK_EQUAL( copy.GetPartRef().get(), part );
+    BOOST_CHECK_EQUAL( FirstLibPin( copy ), part->GetNextPin() );
+
+    // SCH_COMPONENT only has an assignment operator from a SCH_ITEM
+    SCH_COMPONENT assigned;
+    assigned = static_cast<const SCH_ITEM&>( original );
+
+    BOOST_CHECK_EQUAL( assigned.GetPartRef().get(), part );
+    BOOST_CHECK_EQUAL( original.GetPartRef().use_count(), 3 );
+}
+
+
+/**
+ * Swapping the data of two components swaps their library symbols and pins
+ */
+BOOST_AUTO_TEST_CASE( Swap )
+{
+    SCH_COMPONENT a( m_lib_part, m_lib_id, nullptr, 1, 0, wxPoint( 0, 0 ) );
+    SCH_COMPONENT b( m_lib_part, m_lib_id, nullptr, 1, 0, wxPoint( 0, 0 ) );
+    LIB_PART*     partA = a.GetPartRef().get();
+    LIB_PART*     partB = b.GetPartRef().get();
+
+    BOOST_REQUIRE( partA != partB );
+
+    a.SwapData( &b );
+
+    BOOST_CHECK_EQUAL( a.GetPartRef().get(), partB );
+    BOOST_CHECK_EQUAL( b.GetPartRef().get(), partA );
+    BOOST_CHECK_EQUAL( FirstLibPin( a ), partB->GetNextPin() );
+    BOOST_CHECK_EQUAL( FirstLibPin( b ), partA->GetNextPin() );
+}
+
+
+/**
+ * Components placed from the same library symbol share a single flattened copy of it,
+ * across the calls made by SCH_SCREENS::UpdateSymbolLinks() for each screen.  Symbols
+ * which cannot be resolved are not added to the shared map.
+ */
+BOOST_AUTO_TEST_CASE( ResolveShared )
+{
+    SYMBOL_LIB_TABLE libTable;
+    SHARED_LIB_PARTS resolved;
+
+    std::shared_ptr<LIB_PART> shared( m_lib_part.Flatten() );
+    resolved[m_lib_id] = shared;
+
+    LIB_ID        missingId( "Device", "C" );
+    SCH_COMPONENT a( m_lib_part, m_lib_id, nullptr, 1, 0, wxPoint( 0, 0 ) );
+    SCH_COMPONENT b( m_lib_part, m_lib_id, nullptr, 1, 0, wxPoint( 0, 0 ) );
+    SCH_COMPONENT missing( m_lib_part, missingId, nullptr, 1, 0, wxPoint( 0, 0 ) );
+
+    // One screen after the other
+    std::vector<SCH_COMPONENT*> screen1 = { &a, &missing };
+    std::vector<SCH_COMPONENT*> screen2 = { &b };
+
+    SCH_COMPONENT::ResolveAll( screen1, libTable, nullptr, &resolved );
+    SCH_COMPONENT::ResolveAll( screen2, libTable, nullptr, &resolved );
+
+    BOOST_CHECK_EQUAL( a.GetPartRef().get(), shared.get() );
+    BOOST_CHECK_EQUAL( b.GetPartRef().get(), shared.get() );
+    BOOST_CHECK_EQUAL( FirstLibPin( b ), shared->GetNextPin() );
+
+    BOOST_CHECK( !missing.GetPartRef() );
+    BOOST_CHECK_EQUAL( resolved.count( missingId ), 0u );
+}
+
+
+/**
+ * A component gets its own copy of a shared library symbol to modify, and keeps using an
+ * unshared one
+ */
+BOOST_AUTO_TEST_CASE( PartForEdit )
+{
+    SCH_COMPONENT original( m_lib_part, m_lib_id, nullptr, 1, 0, wxPoint( 0, 0 ) );
+    SCH_COMPONENT copy( original );
+    LIB_PART*     shared = original.GetPartRef().get();
+
+    LIB_PART* edited = copy.GetPartForEdit();
+
+    BOOST_REQUIRE( edited != nullptr );
+    BOOST_CHECK( edited != shared );
+    BOOST_CHECK_EQUAL( original.GetPartRef().get(), shared );
+    BOOST_CHECK_EQUAL( FirstLibPin( copy ), edited->GetNextPin() );
+    BOOST_CHECK_EQUAL( FirstLibPin( original ), shared->GetNextPin() );
+
+    edited->SetName( "R_Small" );
+
+    BOOST_CHECK_EQUAL( shared->GetName(), "R" );
+
+    // Now owned by the copy alone, so it is not copied again
+    BOOST_CHECK_EQUAL( copy.GetPartForEdit(), edited );
+    BOOST_CHECK_EQUAL( original.GetPartForEdit(), shared );
+
+    SCH_COMPONENT unresolved;
+
+    BOOST_CHECK( unresolved.GetPartForEdit() == nullptr );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,313 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the annotation of SCH_REFERENCE_LISTs
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+// Code under test
+#include <sch_reference_list.h>
+
+#include <class_libentry.h>
+#include <sch_component.h>
+#include <sch_sheet.h>
+#include <sch_sheet_path.h>
+
+
+class TEST_SCH_REFERENCE_LIST_FIXTURE
+{
+public:
+    TEST_SCH_REFERENCE_LIST_FIXTURE() :
+            m_resistor( "R", nullptr ),
+            m_gate( "74LS00", nullptr )
+    {
+        m_resistor.GetReferenceField().SetText( "R" );
+
+        m_gate.GetReferenceField().SetText( "U" );
+        m_gate.SetUnitCount( 4 );
+
+        // Two sheets, numbered 1 and 2
+        for( int i = 0; i < 2; ++i )
+            m_sheets.emplace_back( wxPoint( i, i ) );
+
+        for( SCH_SHEET& sheet : m_sheets )
+        {
+            m_paths.emplace_back();
+            m_paths.back().push_back( &sheet );
+        }
+    }
+
+    /**
+     * Place a component on \a aSheet at ( \a aX, 0 ).
+     *
+     * @param aRef is the reference of the component, ending with '?' if not annotated
+     * @return the index of the component
+     */
+    size_t AddComponent( LIB_PART& aPart, const wxString& aRef, const wxString& aValue,
+                         int aUnit, int aSheet, int aX )
+    {
+        SCH_SHEET_PATH* path = &m_paths[aSheet];
+        SCH_COMPONENT*  component = new SCH_COMPONENT( aPart, LIB_ID( "Test", aPart.GetName() ),
+                                                       path, aUnit, 0, wxPoint( aX, 0 ) );
+
+        component->SetRef( path, aRef );
+        component->GetField( VALUE )->SetText( aValue );
+
+        m_components.emplace_back( component );
+        m_componentSheets.push_back( aSheet );
+        return m_components.size() - 1;
+    }
+
+    /// @return the reference of a component, as collected by SCH_SHEET_PATH::GetComponents()
+    SCH_REFERENCE MakeReference( size_t aIndex )
+    {
+        SCH_COMPONENT* component = m_components[aIndex].get();
+        int            sheet = m_componentSheets[aIndex];
+        SCH_REFERENCE  reference( component, component->GetPartRef().get(), m_paths[sheet] );
+
+        reference.SetSheetNumber( sheet + 1 );
+        return reference;
+    }
+
+    void SetRef( size_t aIndex, const wxString& aRef )
+    {
+        m_components[aIndex]->SetRef( &m_paths[m_componentSheets[aIndex]], aRef );
+    }
+
+    /// @return the reference of a component, with the unit of multi-unit components
+    wxString FullRef( size_t aIndex )
+    {
+        return m_components[aIndex]->GetRef( &m_paths[m_componentSheets[aIndex]], true );
+    }
+
+    /**
+     * Annotate all the components by X position, as SCH_EDIT_FRAME::AnnotateComponents()
+     * does with an interval of 100 per sheet.
+     */
+    void Annotate( bool aUseSheetNum, int aStartNumber,
+                   const SCH_MULTI_UNIT_REFERENCE_MAP& aLockedUnitMap = {} )
+    {
+        SCH_REFERENCE_LIST references;
+
+        for( size_t i = 0; i < m_components.size(); ++i )
+        {
+            SCH_REFERENCE reference = MakeReference( i );
+            references.AddItem( reference );
+        }
+
+        references.SplitReferences();
+        references.SortByXCoordinate();
+        references.Annotate( aUseSheetNum, 100, aStartNumber, aLockedUnitMap );
+        references.UpdateAnnotation();
+    }
+
+    LIB_PART m_resistor;
+    LIB_PART m_gate;        ///< 4 units per package
+
+    std::vector<SCH_SHEET>      m_sheets;
+    std::vector<SCH_SHEET_PATH> m_paths;
+
+    std::vector<std::unique_ptr<SCH_COMPONENT>> m_components;
+    std::vector<int>                            m_componentSheets;
+};
+
+
+/**
+ * Declare the test suite
+ */
+BOOST_FIXTURE_TEST_SUITE( SchReferenceList, TEST_SCH_REFERENCE_LIST_FIXTURE )
+
+
+/**
+ * New single unit components get the first free numbers of their reference prefix
+ */
+BOOST_AUTO_TEST_CASE( SingleUnit )
+{
+    size_t r1 = AddComponent( m_resistor, "R1", "10k", 1, 0, 0 );
+    size_t r2 = AddComponent( m_resistor, "R?", "10k", 1, 0, 100 );
+    size_t r3 = AddComponent( m_resistor, "R?", "1k", 1, 0, 200 );
+    size_t r4 = AddComponent( m_resistor, "R4", "1k", 1, 0, 300 );
+    size_t r5 = AddComponent( m_resistor, "R?", "10k", 1, 0, 400 );
+    size_t c1 = AddComponent( m_resistor, "C?", "100n", 1, 0, 500 );
+
+    Annotate( false, 0 );
+
+    BOOST_CHECK_EQUAL( FullRef( r1 ), "R1" );
+    BOOST_CHECK_EQUAL( FullRef( r2 ), "R2" );
+    BOOST_CHECK_EQUAL( FullRef( r3 ), "R3" );
+    BOOST_CHECK_EQUAL( FullRef( r4 ), "R4" );
+    BOOST_CHECK_EQUAL( FullRef( r5 ), "R5" );
+    BOOST_CHECK_EQUAL( FullRef( c1 ), "C1" );
+}
+
+
+/**
+ * The units of new multi-unit components with the same value are grouped in packages
+ */
+BOOST_AUTO_TEST_CASE( MultiUnit )
+{
+    size_t a = AddComponent( m_gate, "U?", "74LS00", 1, 0, 0 );
+    size_t b = AddComponent( m_gate, "U?", "74LS00", 1, 0, 100 );
+    size_t c = AddComponent( m_gate, "U?", "74LS04", 1, 0, 200 );
+    size_t d = AddComponent( m_gate, "U?", "74LS00", 1, 0, 300 );
+    size_t e = AddComponent( m_gate, "U?", "74LS00", 1, 0, 400 );
+    size_t f = AddComponent( m_gate, "U?", "74LS00", 1, 0, 500 );
+
+    Annotate( false, 0 );
+
+    BOOST_CHECK_EQUAL( FullRef( a ), "U1A" );
+    BOOST_CHECK_EQUAL( FullRef( b ), "U1B" );
+    BOOST_CHECK_EQUAL( FullRef( c ), "U2A" );
+    BOOST_CHECK_EQUAL( FullRef( d ), "U1C" );
+    BOOST_CHECK_EQUAL( FullRef( e ), "U1D" );
+    BOOST_CHECK_EQUAL( FullRef( f ), "U3A" );
+}
+
+
+/**
+ * The units of the packages of aLockedUnitMap are kept together, with their units, when
+ * the annotation is reset
+ */
+BOOST_AUTO_TEST_CASE( LockedUnits )
+{
+    size_t p = AddComponent( m_gate, "U5", "74LS00", 2, 0, 0 );
+    size_t r = AddComponent( m_gate, "U7", "74LS00", 1, 0, 100 );
+    size_t q = AddComponent( m_gate, "U5", "74LS00", 1, 0, 200 );
+    size_t s = AddComponent( m_gate, "U7", "74LS00", 2, 0, 300 );
+
+    // As SCH_SHEET_LIST::GetMultiUnitComponents() collects them before the reset
+    SCH_MULTI_UNIT_REFERENCE_MAP lockedUnits;
+
+    for( size_t i : { p, r, q, s } )
+    {
+        SCH_REFERENCE reference = MakeReference( i );
+        lockedUnits[reference.GetRef()].AddItem( reference );
+    }
+
+    for( size_t i : { p, r, q, s } )
+        SetRef( i, "U?" );
+
+    // Without the locked units, the units are allocated by position
+    Annotate( false, 0 );
+
+    BOOST_CHECK_EQUAL( FullRef( p ), "U1A" );
+    BOOST_CHECK_EQUAL( FullRef( r ), "U1B" );
+    BOOST_CHECK_EQUAL( FullRef( q ), "U1C" );
+    BOOST_CHECK_EQUAL( FullRef( s ), "U1D" );
+
+    for( size_t i : { p, r, q, s } )
+        SetRef( i, "U?" );
+
+    Annotate( false, 0, lockedUnits );
+
+    BOOST_CHECK_EQUAL( FullRef( p ), "U1B" );
+    BOOST_CHECK_EQUAL( FullRef( r ), "U2A" );
+    BOOST_CHECK_EQUAL( FullRef( q ), "U1A" );
+    BOOST_CHECK_EQUAL( FullRef( s ), "U2B" );
+}
+
+
+/**
+ * Each sheet is numbered from its sheet number times the interval, and the units of a
+ * package are only taken from the same sheet
+ */
+BOOST_AUTO_TEST_CASE( SheetNumbers )
+{
+    size_t r101 = AddComponent( m_resistor, "R?", "10k", 1, 0, 0 );
+    size_t r102 = AddComponent( m_resistor, "R?", "10k", 1, 0, 100 );
+    size_t r202 = AddComponent( m_resistor, "R?", "10k", 1, 1, 0 );
+    size_t r201 = AddComponent( m_resistor, "R201", "10k", 1, 1, 50 );
+    size_t r203 = AddComponent( m_resistor, "R?", "10k", 1, 1, 100 );
+    size_t u101 = AddComponent( m_gate, "U?", "74LS00", 1, 0, 200 );
+    size_t u201 = AddComponent( m_gate, "U?", "74LS00", 1, 1, 200 );
+
+    Annotate( true, 0 );
+
+    BOOST_CHECK_EQUAL( FullRef( r101 ), "R101" );
+    BOOST_CHECK_EQUAL( FullRef( r102 ), "R102" );
+    BOOST_CHECK_EQUAL( FullRef( r201 ), "R201" );
+    BOOST_CHECK_EQUAL( FullRef( r202 ), "R202" );
+    BOOST_CHECK_EQUAL( FullRef( r203 ), "R203" );
+    BOOST_CHECK_EQUAL( FullRef( u101 ), "U101A" );
+    BOOST_CHECK_EQUAL( FullRef( u201 ), "U201A" );
+}
+
+
+/**
+ * A number no longer used after moving a locked unit to its package is not reused by the
+ * same group: the numbers in use are only updated at the start of a group
+ */
+BOOST_AUTO_TEST_CASE( ReleasedInGroup )
+{
+    size_t x = AddComponent( m_gate, "U?", "74LS00", 1, 0, 0 );
+    size_t y = AddComponent( m_gate, "U2", "74LS00", 2, 0, 100 );
+    size_t z = AddComponent( m_gate, "U?", "74LS04", 1, 0, 200 );
+
+    // x and y are locked together, but y was annotated apart
+    SCH_MULTI_UNIT_REFERENCE_MAP lockedUnits;
+
+    for( size_t i : { x, y } )
+    {
+        SCH_REFERENCE reference = MakeReference( i );
+        lockedUnits["U2"].AddItem( reference );
+    }
+
+    Annotate( false, 0, lockedUnits );
+
+    BOOST_CHECK_EQUAL( FullRef( x ), "U1A" );
+    BOOST_CHECK_EQUAL( FullRef( y ), "U1B" );
+    BOOST_CHECK_EQUAL( FullRef( z ), "U3A" );
+}
+
+
+/**
+ * A number no longer used after moving a locked unit to its package is free again in the
+ * next group
+ */
+BOOST_AUTO_TEST_CASE( ReleasedAtNextGroup )
+{
+    size_t x = AddComponent( m_gate, "U?", "74LS00", 1, 0, 0 );
+    size_t z = AddComponent( m_gate, "U?", "74LS04", 1, 0, 200 );
+    size_t y = AddComponent( m_gate, "U201", "74LS00", 2, 1, 0 );
+    size_t w = AddComponent( m_gate, "U?", "74LS04", 1, 1, 100 );
+
+    SCH_MULTI_UNIT_REFERENCE_MAP lockedUnits;
+
+    for( size_t i : { x, y } )
+    {
+        SCH_REFERENCE reference = MakeReference( i );
+        lockedUnits["U201"].AddItem( reference );
+    }
+
+    Annotate( true, 0, lockedUnits );
+
+    BOOST_CHECK_EQUAL( FullRef( x ), "U101A" );
+    BOOST_CHECK_EQUAL( FullRef( y ), "U101B" );
+    BOOST_CHECK_EQUAL( FullRef( z ), "U102A" );
+    BOOST_CHECK_EQUAL( FullRef( w ), "U201A" );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
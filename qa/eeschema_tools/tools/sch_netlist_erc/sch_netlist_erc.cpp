@@ -0,0 +1,406 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <common.h>
+#include <profile.h>
+#include <kiway.h>
+#include <pgm_base.h>
+#include <project.h>
+#include <wildcards_and_files_ext.h>
+
+#include <wx/cmdline.h>
+
+#include <general.h>
+#include <connection_graph.h>
+#include <erc.h>
+#include <erc_settings.h>
+#include <sch_io_mgr.h>
+#include <sch_marker.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_sheet_path.h>
+#include <symbol_lib_table.h>
+#include <netlist_exporter_generic.h>
+#include <netlist_exporter_kicad.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+/**
+ * Loads a schematic and runs the connectivity based checks and exports on it, without a
+ * SCH_EDIT_FRAME.  This stands in for the parts of the editor (the project, the connection
+ * graph and the ERC settings) that the kiface code expects to find through globals.
+ */
+class HEADLESS_SCHEMATIC
+{
+public:
+    HEADLESS_SCHEMATIC() :
+            m_kiway( &Pgm(), KFCTL_STANDALONE ),
+            m_graph( nullptr )
+    {
+        m_ercSettings.LoadDefaults();
+
+        g_ErcSettings = &m_ercSettings;
+    }
+
+    ~HEADLESS_SCHEMATIC()
+    {
+        m_graph.Reset();
+
+        if( g_ConnectionGraph == &m_graph )
+            g_ConnectionGraph = nullptr;
+
+        if( g_CurrentSheet == &m_currentSheet )
+            g_CurrentSheet = nullptr;
+
+        g_ErcSettings = nullptr;
+
+        delete g_RootSheet;
+        g_RootSheet = nullptr;
+    }
+
+    /**
+     * Load \a aFileName (and its sub-sheets) through the SCH_IO_MGR plugin matching its
+     * extension.  The project next to it provides the symbol library table.
+     *
+     * @throw IO_ERROR if the file cannot be loaded.
+     * @return the non fatal errors reported by the plugin, if any.
+     */
+    wxString Load( const wxString& aFileName )
+    {
+        wxFileName pro( aFileName );
+        pro.MakeAbsolute();
+        pro.SetExt( ProjectFileExtension );
+
+        m_kiway.Prj().SetProjectFullName( pro.GetFullPath() );
+
+        SCH_IO_MGR::SCH_FILE_T fileType = SCH_IO_MGR::GuessPluginTypeFromSchPath( aFileName );
+        SCH_PLUGIN::SCH_PLUGIN_RELEASER pi( SCH_IO_MGR::FindPlugin( fileType ) );
+
+        delete g_RootSheet;
+        g_RootSheet = pi->Load( aFileName, &m_kiway );
+
+        m_currentSheet.clear();
+        m_currentSheet.push_back( g_RootSheet );
+        g_CurrentSheet = &m_currentSheet;
+
+        return pi->GetError();
+    }
+
+    /**
+     * Resolve the library symbols and build the connection graph, as the editor does
+     * when preparing a netlist.
+     */
+    void BuildConnectivity()
+    {
+        SCH_SCREENS    screens;
+        SCH_SHEET_LIST sheets( g_RootSheet );
+
+        // Linking the symbols recalculates the global connection graph if there is one;
+        // it is done once below instead.
+        g_ConnectionGraph = nullptr;
+        screens.UpdateSymbolLinks( true );
+        sheets.AnnotatePowerSymbols();
+
+        g_ConnectionGraph = &m_graph;
+        m_graph.Reset();
+        m_graph.Recalculate( sheets, true );
+    }
+
+    /**
+     * Run the ERC checks that work from the connection graph and the schematic hierarchy.
+     * The pin to pin checks of the editor need the legacy netlist and are not run.
+     */
+    void RunERC()
+    {
+        SCH_SHEET_LIST sheets( g_RootSheet );
+        SCH_SCREENS    screens;
+
+        screens.DeleteAllMarkers( MARKER_BASE::MARKER_ERC );
+
+        if( m_ercSettings.IsTestEnabled( ERCE_DUPLICATE_SHEET_NAME ) )
+            TestDuplicateSheetNames( true );
+
+        if( m_ercSettings.IsTestEnabled( ERCE_BUS_ALIAS_CONFLICT ) )
+            TestConflictingBusAliases();
+
+        m_graph.RunERC();
+
+        if( m_ercSettings.IsTestEnabled( ERCE_DIFFERENT_UNIT_FP ) )
+            TestMultiunitFootprints( sheets );
+    }
+
+    /**
+     * Count the ERC markers of the schematic by severity, optionally printing them.
+     * @return the number of markers with error severity.
+     */
+    int ReportERC( std::ostream& aStream, bool aPrintMarkers )
+    {
+        SCH_SHEET_LIST            sheets( g_RootSheet );
+        std::map<KIID, EDA_ITEM*> itemMap;
+        int                       err_count = 0;
+        int                       warn_count = 0;
+        int                       total_count = 0;
+
+        sheets.FillItemMap( itemMap );
+
+        for( unsigned i = 0; i < sheets.size(); i++ )
+        {
+            for( SCH_ITEM* item : sheets[i].LastScreen()->Items().OfType( SCH_MARKER_T ) )
+            {
+                const SCH_MARKER* marker = static_cast<const SCH_MARKER*>( item );
+
+                if( marker->GetMarkerType() != MARKER_BASE::MARKER_ERC )
+                    continue;
+
+                total_count++;
+
+                switch( m_ercSettings.m_Severities[ marker->GetRCItem()->GetErrorCode() ] )
+                {
+                case RPT_SEVERITY_ERROR:   err_count++;  break;
+                case RPT_SEVERITY_WARNING: warn_count++; break;
+                default:                                 break;
+                }
+
+                if( aPrintMarkers )
+                {
+                    aStream << sheets[i].PathHumanReadable() << ": "
+                            << marker->GetRCItem()->ShowReport( EDA_UNITS::MILLIMETRES, itemMap );
+                }
+            }
+        }
+
+        aStream << "ERC messages: " << total_count << "  Errors " << err_count
+                << "  Warnings " << warn_count << std::endl;
+
+        return err_count;
+    }
+
+    /**
+     * Write the Pcbnew netlist, or the generic XML one if \a aGeneric is set, to
+     * \a aFileName.
+     */
+    bool WriteNetlist( const wxString& aFileName, bool aGeneric )
+    {
+        SYMBOL_LIB_TABLE* libTable = m_kiway.Prj().SchSymbolLibTable();
+        std::unique_ptr<NETLIST_EXPORTER> exporter;
+
+        // The graph based exporters do not need the flat NETLIST_OBJECT_LIST
+        if( aGeneric )
+            exporter.reset( new NETLIST_EXPORTER_GENERIC( libTable, nullptr, &m_graph ) );
+        else
+            exporter.reset( new NETLIST_EXPORTER_KICAD( libTable, nullptr, &m_graph ) );
+
+        return exporter->WriteNetlist( aFileName, 0 );
+    }
+
+private:
+    KIWAY            m_kiway;
+    CONNECTION_GRAPH m_graph;
+    ERC_SETTINGS     m_ercSettings;
+    SCH_SHEET_PATH   m_currentSheet;
+};
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "v",
+            "verbose",
+            _( "print progress information" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "t",
+            "timings",
+            _( "print the time taken by each stage" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "e",
+            "erc",
+            _( "run the electrical rules check" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "m",
+            "print-markers",
+            _( "print ERC marker information" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "n",
+            "netlist",
+            _( "write the Pcbnew (s-expression) netlist to the given file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "x",
+            "xml",
+            _( "write the generic (XML) netlist to the given file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "input schematic file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_MANDATORY,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+/**
+ * Tool-specific return codes
+ */
+enum SCH_NETLIST_ERC_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    EXPORT_FAILED,
+    ERC_ERRORS,
+};
+
+
+int sch_netlist_erc_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program loads a schematic without a schematic editor, builds its "
+               "connectivity, and runs the ERC and netlist exporters on it.  This can be "
+               "used for validating schematics in continuous integration, profiling, etc." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    const bool verbose = cl_parser.Found( "verbose" );
+    const bool timings = cl_parser.Found( "timings" );
+    const wxString filename = cl_parser.GetParam( 0 );
+
+    std::vector<std::pair<std::string, double>> stageTimes;
+    HEADLESS_SCHEMATIC schematic;
+    int ret = KI_TEST::RET_CODES::OK;
+
+    auto runStage = [&]( const std::string& aName, const std::function<void()>& aStage )
+    {
+        if( verbose )
+            std::cout << "Running " << aName << std::endl;
+
+        PROF_COUNTER timer;
+        aStage();
+        timer.Stop();
+
+        stageTimes.emplace_back( aName, timer.msecs() );
+    };
+
+    try
+    {
+        runStage( "load", [&]()
+                {
+                    wxString errors = schematic.Load( filename );
+
+                    if( !errors.IsEmpty() )
+                        std::cerr << "Errors loading the schematic:\n" << errors << std::endl;
+                } );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << "Failed to load " << filename << ": " << ioe.What() << std::endl;
+        return LOAD_FAILED;
+    }
+
+    runStage( "connectivity", [&]() { schematic.BuildConnectivity(); } );
+
+    if( cl_parser.Found( "erc" ) )
+    {
+        runStage( "erc", [&]() { schematic.RunERC(); } );
+
+        int errors = schematic.ReportERC( std::cout, cl_parser.Found( "print-markers" ) );
+
+        if( errors > 0 )
+            ret = ERC_ERRORS;
+    }
+
+    wxString netlistFile;
+
+    if( cl_parser.Found( "netlist", &netlistFile ) )
+    {
+        runStage( "netlist", [&]()
+                {
+                    if( !schematic.WriteNetlist( netlistFile, false ) )
+                    {
+                        std::cerr << "Failed to write " << netlistFile << std::endl;
+                        ret = EXPORT_FAILED;
+                    }
+                } );
+    }
+
+    if( cl_parser.Found( "xml", &netlistFile ) )
+    {
+        runStage( "xml netlist", [&]()
+                {
+                    if( !schematic.WriteNetlist( netlistFile, true ) )
+                    {
+                        std::cerr << "Failed to write " << netlistFile << std::endl;
+                        ret = EXPORT_FAILED;
+                    }
+                } );
+    }
+
+    if( timings )
+    {
+        for( const auto& stage : stageTimes )
+            std::cout << stage.first << ": " << stage.second << " ms" << std::endl;
+    }
+
+    return ret;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( { "sch_netlist_erc",
+        "Load a schematic and run the ERC and netlist exporters on it",
+        sch_netlist_erc_main_func } );
@@ -0,0 +1,242 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include <common.h>
+#include <profile.h>
+#include <kiway.h>
+#include <pgm_base.h>
+#include <project.h>
+#include <wildcards_and_files_ext.h>
+
+#include <wx/cmdline.h>
+
+#include <general.h>
+#include <sch_io_mgr.h>
+#include <sch_painter.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_view.h>
+#include <gal/gal_display_options.h>
+#include <settings/color_settings.h>
+
+#include <qa_utils/render_benchmark.h>
+#include <qa_utils/utility_registry.h>
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "W",
+            "width",
+            _( "width of the rendered image in pixels (default 1920)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "H",
+            "height",
+            _( "height of the rendered image in pixels (default 1080)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "r",
+            "repeat",
+            _( "number of times the frame sequence is rendered (default 1)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "s",
+            "serial",
+            _( "rasterize on a single thread instead of using tiles" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "o",
+            "output",
+            _( "save the last rendered frame to a PNG file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "input schematic file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_MANDATORY,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+/**
+ * Tool-specific return codes
+ */
+enum SCH_RENDER_BENCHMARK_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    SAVE_FAILED,
+};
+
+
+int sch_render_benchmark_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program renders the root sheet of a schematic offscreen through the Cairo "
+               "GAL at a scripted sequence of zoom and pan positions, and reports the time "
+               "spent per frame." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long width = 1920;
+    long height = 1080;
+    long repeat = 1;
+    wxString output;
+
+    cl_parser.Found( "width", &width );
+    cl_parser.Found( "height", &height );
+    cl_parser.Found( "repeat", &repeat );
+
+    if( width <= 0 || height <= 0 || repeat <= 0 )
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    const wxString filename = cl_parser.GetParam( 0 );
+
+    // The project next to the schematic provides the symbol library table
+    KIWAY      kiway( &Pgm(), KFCTL_STANDALONE );
+    wxFileName pro( filename );
+    pro.MakeAbsolute();
+    pro.SetExt( ProjectFileExtension );
+    kiway.Prj().SetProjectFullName( pro.GetFullPath() );
+
+    try
+    {
+        SCH_IO_MGR::SCH_FILE_T fileType = SCH_IO_MGR::GuessPluginTypeFromSchPath( filename );
+        SCH_PLUGIN::SCH_PLUGIN_RELEASER pi( SCH_IO_MGR::FindPlugin( fileType ) );
+
+        g_RootSheet = pi->Load( filename, &kiway );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << "Failed to load " << filename << ": " << ioe.What() << std::endl;
+        return LOAD_FAILED;
+    }
+
+    // Resolve the library symbols, so the symbols are drawn from their library graphics
+    SCH_SCREENS screens;
+    screens.UpdateSymbolLinks( true );
+
+    SCH_SCREEN* screen = g_RootSheet->GetScreen();
+
+    KIGFX::GAL_DISPLAY_OPTIONS options;
+    KI_TEST::OFFSCREEN_CAIRO_GAL gal( options, width, height, !cl_parser.Found( "serial" ) );
+    gal.SetWorldUnitLength( SCH_WORLD_UNIT );
+
+    KIGFX::SCH_PAINTER painter( &gal );
+    COLOR_SETTINGS colors;
+    colors.ResetToDefaults();
+    painter.GetSettings()->LoadColors( &colors );
+    gal.SetClearColor( painter.GetSettings()->GetBackgroundColor() );
+
+    // Set up as in SCH_DRAW_PANEL
+    KIGFX::SCH_VIEW view( true, nullptr );
+    view.SetGAL( &gal );
+    view.SetPainter( &painter );
+    view.SetScaleLimits( 1000.0, 0.0001 );
+    view.SetMirror( false, false );
+
+    for( LAYER_NUM i = 0; (unsigned) i < sizeof( SCH_LAYER_ORDER ) / sizeof( LAYER_NUM ); ++i )
+        view.SetLayerOrder( SCH_LAYER_ORDER[i], i );
+
+    view.UpdateAllLayersOrder();
+
+    // Software rendering does not use cached layers.  The overlay layers switch the GAL
+    // target during each frame as they do in the editor.
+    for( int i = 0; i < KIGFX::VIEW::VIEW_MAX_LAYERS; i++ )
+        view.SetLayerTarget( i, KIGFX::TARGET_NONCACHED );
+
+    view.SetLayerTarget( LAYER_GP_OVERLAY, KIGFX::TARGET_OVERLAY );
+    view.SetLayerTarget( LAYER_SELECT_OVERLAY, KIGFX::TARGET_OVERLAY );
+
+    PROF_COUNTER loadTimer;
+    view.DisplaySheet( screen );
+    loadTimer.Stop();
+
+    PROF_COUNTER recacheTimer;
+
+    {
+        KIGFX::GAL_UPDATE_CONTEXT ctx( &gal );
+        view.RecacheAllItems();
+        view.UpdateItems();
+    }
+
+    recacheTimer.Stop();
+
+    printf( "Schematic: %s\n", (const char*) filename.mb_str() );
+    printf( "Image: %ldx%ld, %s rasterization\n", width, height,
+            cl_parser.Found( "serial" ) ? "serial" : "tiled" );
+    printf( "View load: %.1f ms, recache: %.1f ms\n", loadTimer.msecs(), recacheTimer.msecs() );
+
+    BOX2I pageBox( VECTOR2I( 0, 0 ), VECTOR2I( screen->GetPageSettings().GetWidthIU(),
+                                               screen->GetPageSettings().GetHeightIU() ) );
+
+    KI_TEST::RunRenderBenchmark( view, painter, gal, pageBox, repeat );
+
+    int ret = KI_TEST::RET_CODES::OK;
+
+    if( cl_parser.Found( "output", &output ) && !gal.SavePng( output.ToStdString() ) )
+        ret = SAVE_FAILED;
+
+    view.Clear();
+
+    delete g_RootSheet;
+    g_RootSheet = nullptr;
+
+    return ret;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( { "sch_render_benchmark",
+        "Measure offscreen rendering performance of a schematic",
+        sch_render_benchmark_main_func } );
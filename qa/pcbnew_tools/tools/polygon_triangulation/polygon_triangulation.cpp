@@ -226,11 +226,13 @@ int polygon_triangulation_main( int argc, char *argv[] )
 
     std::atomic<size_t> zonesToTriangulate( 0 );
     std::atomic<size_t> threadsFinished( 0 );
+    std::atomic<size_t> trianglesCount( 0 );
 
     size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
     for( size_t ii = 0; ii < parallelThreadCount; ++ii )
     {
-        std::thread t = std::thread( [&brd, &zonesToTriangulate, &threadsFinished]() {
+        std::thread t = std::thread( [&brd, &zonesToTriangulate, &threadsFinished,
+                                      &trianglesCount]() {
             for( size_t areaId = zonesToTriangulate.fetch_add( 1 );
                         areaId < static_cast<size_t>( brd->GetAreaCount() );
                         areaId = zonesToTriangulate.fetch_add( 1 ) )
@@ -240,8 +242,15 @@ int polygon_triangulation_main( int argc, char *argv[] )
 
                 poly.CacheTriangulation();
 
-                (void) poly;
-                printf("zone %zu/%d\n", ( areaId + 1 ), brd->GetAreaCount() );
+                size_t triangles = 0;
+
+                for( unsigned int jj = 0; jj < poly.TriangulatedPolyCount(); ++jj )
+                    triangles += poly.TriangulatedPolygon( jj )->GetTriangleCount();
+
+                trianglesCount += triangles;
+
+                printf( "zone %zu/%d: %zu triangles\n", ( areaId + 1 ), brd->GetAreaCount(),
+                        triangles );
 #if 0
                 PROF_COUNTER unfrac("unfrac");
                 poly.Unfracture( SHAPE_POLY_SET::PM_FAST );
@@ -266,8 +275,15 @@ int polygon_triangulation_main( int argc, char *argv[] )
     while( threadsFinished < parallelThreadCount )
         std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
 
+    cnt.Stop();
     cnt.Show();
 
+    // Throughput figure, to compare triangulator versions on the same board
+    const double seconds = cnt.msecs() / 1000.0;
+
+    printf( "%zu triangles, %.0f triangles/s\n", trianglesCount.load(),
+            seconds > 0.0 ? trianglesCount.load() / seconds : 0.0 );
+
     return KI_TEST::RET_CODES::OK;
 }
 
@@ -0,0 +1,219 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstdio>
+#include <string>
+
+#include <common.h>
+#include <profile.h>
+
+#include <wx/cmdline.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_zone.h>
+#include <pcb_painter.h>
+#include <pcb_view.h>
+#include <gal/gal_display_options.h>
+#include <settings/color_settings.h>
+
+#include <pcbnew_utils/board_file_utils.h>
+
+#include <qa_utils/render_benchmark.h>
+#include <qa_utils/utility_registry.h>
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "W",
+            "width",
+            _( "width of the rendered image in pixels (default 1920)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "H",
+            "height",
+            _( "height of the rendered image in pixels (default 1080)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "r",
+            "repeat",
+            _( "number of times the frame sequence is rendered (default 1)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "s",
+            "serial",
+            _( "rasterize on a single thread instead of using tiles" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "o",
+            "output",
+            _( "save the last rendered frame to a PNG file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "input file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+/**
+ * Tool=specific return codes
+ */
+enum RENDER_BENCHMARK_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    SAVE_FAILED,
+};
+
+
+int render_benchmark_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program renders a PCB file offscreen through the Cairo GAL at a scripted "
+               "sequence of zoom and pan positions, and reports the time spent per frame." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long width = 1920;
+    long height = 1080;
+    long repeat = 1;
+    wxString output;
+
+    cl_parser.Found( "width", &width );
+    cl_parser.Found( "height", &height );
+    cl_parser.Found( "repeat", &repeat );
+
+    if( width <= 0 || height <= 0 || repeat <= 0 )
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    std::string filename;
+
+    if( cl_parser.GetParamCount() )
+        filename = cl_parser.GetParam( 0 ).ToStdString();
+
+    std::unique_ptr<BOARD> board = KI_TEST::ReadBoardFromFileOrStream( filename );
+
+    if( !board )
+        return RENDER_BENCHMARK_RET_CODES::LOAD_FAILED;
+
+    KIGFX::GAL_DISPLAY_OPTIONS options;
+    KI_TEST::OFFSCREEN_CAIRO_GAL gal( options, width, height, !cl_parser.Found( "serial" ) );
+    gal.SetWorldUnitLength( 1e-9 /* 1 nm */ / 0.0254 /* 1 inch in meters */ );
+
+    KIGFX::PCB_PAINTER painter( &gal );
+    COLOR_SETTINGS colors;
+    colors.ResetToDefaults();
+    painter.GetSettings()->LoadColors( &colors );
+    gal.SetClearColor( painter.GetSettings()->GetBackgroundColor() );
+
+    KIGFX::PCB_VIEW view;
+    view.SetGAL( &gal );
+    view.SetPainter( &painter );
+
+    // Software rendering does not use cached layers, as in PCB_DRAW_PANEL_GAL.  The overlay
+    // layers switch the GAL target during each frame as they do in the editor.
+    for( int i = 0; i < KIGFX::VIEW::VIEW_MAX_LAYERS; i++ )
+        view.SetLayerTarget( i, KIGFX::TARGET_NONCACHED );
+
+    view.SetLayerTarget( LAYER_SELECT_OVERLAY, KIGFX::TARGET_OVERLAY );
+    view.SetLayerTarget( LAYER_GP_OVERLAY, KIGFX::TARGET_OVERLAY );
+    view.SetLayerTarget( LAYER_RATSNEST, KIGFX::TARGET_OVERLAY );
+
+    for( LAYER_NUM i = 0; i < PCB_LAYER_ID_COUNT; ++i )
+        view.SetLayerVisible( i, board->IsLayerVisible( PCB_LAYER_ID( i ) ) );
+
+    PROF_COUNTER loadTimer;
+
+    view.BeginBulkAdd();
+
+    for( BOARD_ITEM* drawing : board->Drawings() )
+        view.Add( drawing );
+
+    for( TRACK* track : board->Tracks() )
+        view.Add( track );
+
+    for( MODULE* module : board->Modules() )
+        view.Add( module );
+
+    for( ZONE_CONTAINER* zone : board->Zones() )
+        view.Add( zone );
+
+    view.EndBulkAdd();
+    loadTimer.Stop();
+
+    PROF_COUNTER recacheTimer;
+
+    {
+        KIGFX::GAL_UPDATE_CONTEXT ctx( &gal );
+        view.RecacheAllItems();
+        view.UpdateItems();
+    }
+
+    recacheTimer.Stop();
+
+    printf( "Board: %s\n", filename.empty() ? "<stdin>" : filename.c_str() );
+    printf( "Image: %ldx%ld, %s rasterization\n", width, height,
+            cl_parser.Found( "serial" ) ? "serial" : "tiled" );
+    printf( "View load: %.1f ms, recache: %.1f ms\n", loadTimer.msecs(), recacheTimer.msecs() );
+
+    KI_TEST::RunRenderBenchmark( view, painter, gal, board->GetBoundingBox(), repeat );
+
+    if( cl_parser.Found( "output", &output ) && !gal.SavePng( output.ToStdString() ) )
+        return RENDER_BENCHMARK_RET_CODES::SAVE_FAILED;
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( { "render_benchmark",
+        "Measure offscreen rendering performance of a PCB", render_benchmark_main_func } );
@@ -0,0 +1,93 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Offscreen rendering of a VIEW at a scripted sequence of view positions, shared by the
+ * render benchmark utilities of the editors.
+ */
+
+#ifndef QA_UTILS_RENDER_BENCHMARK_H
+#define QA_UTILS_RENDER_BENCHMARK_H
+
+#include <string>
+
+#include <gal/cairo/cairo_gal.h>
+#include <math/box2.h>
+
+namespace KIGFX
+{
+class PAINTER;
+class VIEW;
+}
+
+namespace KI_TEST
+{
+
+/**
+ * Cairo GAL drawing to an image surface in memory, so a VIEW can be rendered without
+ * a window or a display connection.
+ */
+class OFFSCREEN_CAIRO_GAL : public KIGFX::CAIRO_GAL_BASE
+{
+public:
+    OFFSCREEN_CAIRO_GAL( KIGFX::GAL_DISPLAY_OPTIONS& aDisplayOptions, int aWidth, int aHeight,
+                         bool aTiled );
+
+    void SetTarget( KIGFX::RENDER_TARGET aTarget ) override;
+
+    KIGFX::RENDER_TARGET GetTarget() const override
+    {
+        return m_target;
+    }
+
+    bool SavePng( const std::string& aFilename );
+
+protected:
+    void beginDrawing() override;
+
+    void endDrawing() override;
+
+private:
+    ///> Use the tiled multithreaded rasterizer
+    bool m_tiled;
+
+    ///> All targets are drawn to the same image, the target is kept for the painters
+    KIGFX::RENDER_TARGET m_target;
+};
+
+
+/**
+ * Render \a aView at a scripted sequence of view positions covering \a aBox: the whole
+ * box, zooming in on its center and panning across it at a high zoom factor.  The item
+ * count, the painter time and the rasterization time of each frame are printed to stdout,
+ * followed by their averages.
+ *
+ * @param aRepeat is the number of times the sequence is rendered
+ */
+void RunRenderBenchmark( KIGFX::VIEW& aView, KIGFX::PAINTER& aPainter,
+                         OFFSCREEN_CAIRO_GAL& aGal, const BOX2I& aBox, long aRepeat );
+
+} // namespace KI_TEST
+
+#endif // QA_UTILS_RENDER_BENCHMARK_H
@@ -0,0 +1,200 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/render_benchmark.h>
+
+#include <cstdio>
+#include <vector>
+
+#include <painter.h>
+#include <profile.h>
+#include <view/view.h>
+
+
+namespace KI_TEST
+{
+
+OFFSCREEN_CAIRO_GAL::OFFSCREEN_CAIRO_GAL( KIGFX::GAL_DISPLAY_OPTIONS& aDisplayOptions,
+                                          int aWidth, int aHeight, bool aTiled ) :
+        CAIRO_GAL_BASE( aDisplayOptions ),
+        m_tiled( aTiled ),
+        m_target( KIGFX::TARGET_NONCACHED )
+{
+    ResizeScreen( aWidth, aHeight );
+
+    surface = cairo_image_surface_create( GAL_FORMAT, aWidth, aHeight );
+    context = cairo_create( surface );
+    currentContext = context;
+}
+
+
+void OFFSCREEN_CAIRO_GAL::SetTarget( KIGFX::RENDER_TARGET aTarget )
+{
+    // All the targets share the image, but the draw list is flushed as in CAIRO_GAL
+    updateRecording( aTarget, m_tiled );
+    m_target = aTarget;
+}
+
+
+bool OFFSCREEN_CAIRO_GAL::SavePng( const std::string& aFilename )
+{
+    return cairo_surface_write_to_png( surface, aFilename.c_str() ) == CAIRO_STATUS_SUCCESS;
+}
+
+
+void OFFSCREEN_CAIRO_GAL::beginDrawing()
+{
+    CAIRO_GAL_BASE::beginDrawing();
+    isRecording = m_tiled;
+}
+
+
+void OFFSCREEN_CAIRO_GAL::endDrawing()
+{
+    CAIRO_GAL_BASE::endDrawing();
+
+    if( isRecording )
+    {
+        replayDrawList( currentContext );
+        isRecording = false;
+    }
+
+    cairo_surface_flush( surface );
+}
+
+
+/**
+ * A view position of the scripted benchmark sequence
+ */
+struct BENCHMARK_FRAME
+{
+    VECTOR2D m_center;
+    double   m_zoom;        ///< Zoom factor relative to the whole box view
+};
+
+
+/**
+ * Timings and statistics of a single rendered frame
+ */
+struct FRAME_RESULT
+{
+    int    m_items;         ///< Item/layer pairs in the viewport
+    KIGFX::PAINTER::CULLING_STATS m_culling;    ///< Primitives culled and emitted by the painter
+    double m_painterTime;   ///< VIEW::Redraw() time, in ms
+    double m_frameTime;     ///< Complete frame time, including the final rasterization
+};
+
+
+/**
+ * Build the scripted sequence of view positions: the whole box, zooming in on its center
+ * and panning across it at a high zoom factor.
+ */
+static std::vector<BENCHMARK_FRAME> buildFrameSequence( const BOX2I& aBox )
+{
+    std::vector<BENCHMARK_FRAME> frames;
+    VECTOR2D center = aBox.Centre();
+
+    for( double zoom : { 1.0, 2.0, 4.0, 8.0, 16.0 } )
+        frames.push_back( { center, zoom } );
+
+    for( int row = 0; row < 3; ++row )
+    {
+        for( int col = 0; col < 3; ++col )
+        {
+            VECTOR2D pos( aBox.GetX() + aBox.GetWidth() * ( col + 0.5 ) / 3.0,
+                          aBox.GetY() + aBox.GetHeight() * ( row + 0.5 ) / 3.0 );
+            frames.push_back( { pos, 8.0 } );
+        }
+    }
+
+    return frames;
+}
+
+
+void RunRenderBenchmark( KIGFX::VIEW& aView, KIGFX::PAINTER& aPainter,
+                         OFFSCREEN_CAIRO_GAL& aGal, const BOX2I& aBox, long aRepeat )
+{
+    printf( "%5s %8s %8s %8s %8s %10s %12s %10s\n", "frame", "zoom", "items", "culled", "emitted",
+            "painter", "rasterize", "total" );
+
+    std::vector<BENCHMARK_FRAME> frames = buildFrameSequence( aBox );
+    std::vector<FRAME_RESULT>    results;
+
+    for( long pass = 0; pass < aRepeat; ++pass )
+    {
+        for( const BENCHMARK_FRAME& frame : frames )
+        {
+            BOX2D viewport( VECTOR2D( aBox.GetPosition() ), VECTOR2D( aBox.GetSize() ) );
+            aView.SetViewport( viewport );
+            aView.SetScale( aView.GetScale() * frame.m_zoom );
+            aView.SetCenter( frame.m_center );
+
+            std::vector<KIGFX::VIEW::LAYER_ITEM_PAIR> visible;
+            BOX2D viewBox = aView.GetViewport();
+            aView.Query( BOX2I( VECTOR2I( viewBox.GetPosition() ), VECTOR2I( viewBox.GetSize() ) ),
+                         visible );
+
+            FRAME_RESULT result;
+            result.m_items = (int) visible.size();
+
+            aPainter.ResetCullingStats();
+
+            PROF_COUNTER frameTimer;
+
+            {
+                KIGFX::GAL_DRAWING_CONTEXT ctx( &aGal );
+
+                PROF_COUNTER painterTimer;
+                aView.Redraw();
+                painterTimer.Stop();
+
+                result.m_painterTime = painterTimer.msecs();
+            }
+
+            frameTimer.Stop();
+            result.m_frameTime = frameTimer.msecs();
+            result.m_culling = aPainter.GetCullingStats();
+            results.push_back( result );
+
+            printf( "%5d %8.1f %8d %8u %8u %7.1f ms %9.1f ms %7.1f ms\n", (int) results.size(),
+                    frame.m_zoom, result.m_items, result.m_culling.m_culled,
+                    result.m_culling.m_emitted, result.m_painterTime,
+                    result.m_frameTime - result.m_painterTime, result.m_frameTime );
+        }
+    }
+
+    double painterTotal = 0.0;
+    double frameTotal = 0.0;
+
+    for( const FRAME_RESULT& result : results )
+    {
+        painterTotal += result.m_painterTime;
+        frameTotal += result.m_frameTime;
+    }
+
+    printf( "Average: painter %.1f ms, rasterize %.1f ms, total %.1f ms (%.1f fps)\n",
+            painterTotal / results.size(), ( frameTotal - painterTotal ) / results.size(),
+            frameTotal / results.size(), 1000.0 * results.size() / frameTotal );
+}
+
+} // namespace KI_TEST
@@ -35,6 +35,8 @@
 #include <array>
 #include <functional>
 #include <iterator>
+#include <utility>
+#include <vector>
 
 #ifdef DEBUG
 #define ASSERT assert    // RTree uses ASSERT( condition )
@@ -186,6 +188,13 @@ public:
     /// Remove all entries from tree
     void    RemoveAll();
 
+    /// Insert many entries at once.  The tree (old and new entries) is rebuilt bottom-up with
+    /// the Sort-Tile-Recursive algorithm (Leutenegger, Edgington & Lopez, 1997), which is much
+    /// faster than inserting the entries one by one and gives fuller nodes with less overlap.
+    /// The tree can be modified with Insert()/Remove() afterwards as usual.
+    /// \param a_entries Bounds and data of the entries to insert
+    void    BulkInsert( const std::vector<std::pair<Rect, DATATYPE>>& a_entries );
+
     /// Count the data elements in this container.  This is slow as no internal counter is maintained.
     int     Count();
 
@@ -527,6 +536,9 @@ protected:
                                    const DATATYPE&  a_id,
                                    Node*            a_node,
                                    ListNode**       a_listNode );
+    void            CollectLeafBranches( Node* a_node, std::vector<Branch>& a_branches );
+    void            BulkLoadRec( Branch* a_begin, Branch* a_end, int a_axis, int a_level,
+                                 std::vector<Branch>& a_parents );
     ListNode*       AllocListNode();
     void            FreeListNode( ListNode* a_listNode );
     static bool     Overlap( Rect* a_rectA, Rect* a_rectB );
@@ -1090,6 +1102,112 @@ void RTREE_QUAL::RemoveAll()
 }
 
 
+RTREE_TEMPLATE
+void RTREE_QUAL::BulkInsert( const std::vector<std::pair<Rect, DATATYPE>>& a_entries )
+{
+    if( a_entries.empty() )
+        return;
+
+    std::vector<Branch> branches;
+    std::vector<Branch> parents;
+
+    branches.reserve( a_entries.size() );
+    CollectLeafBranches( m_root, branches );
+    RemoveAll();
+
+    for( const std::pair<Rect, DATATYPE>& entry : a_entries )
+    {
+        Branch branch;
+        branch.m_rect = entry.first;
+        branch.m_data = entry.second;
+        branches.push_back( branch );
+    }
+
+    // Pack one level at a time until it fits in a single node
+    for( int level = 0; ; ++level )
+    {
+        parents.clear();
+        BulkLoadRec( branches.data(), branches.data() + branches.size(), 0, level, parents );
+
+        if( parents.size() == 1 )
+            break;
+
+        branches.swap( parents );
+    }
+
+    FreeNode( m_root );
+    m_root = parents[0].m_child;
+}
+
+
+RTREE_TEMPLATE
+void RTREE_QUAL::CollectLeafBranches( Node* a_node, std::vector<Branch>& a_branches )
+{
+    for( int index = 0; index < a_node->m_count; ++index )
+    {
+        if( a_node->IsInternalNode() )
+            CollectLeafBranches( a_node->m_branch[index].m_child, a_branches );
+        else
+            a_branches.push_back( a_node->m_branch[index] );
+    }
+}
+
+
+// Sort-Tile-Recursive packing of the branches [a_begin, a_end) into nodes of level a_level.
+// The branches are sorted along a_axis and cut into slabs, each of them tiled recursively
+// along the next axis; on the last axis runs of consecutive branches become the nodes.
+RTREE_TEMPLATE
+void RTREE_QUAL::BulkLoadRec( Branch* a_begin, Branch* a_end, int a_axis, int a_level,
+                              std::vector<Branch>& a_parents )
+{
+    const size_t count = a_end - a_begin;
+    const size_t nodeCount = ( count + MAXNODES - 1 ) / MAXNODES;
+
+    std::sort( a_begin, a_end,
+            [a_axis]( const Branch& a_a, const Branch& a_b )
+            {
+                return (ELEMTYPEREAL) a_a.m_rect.m_min[a_axis] + a_a.m_rect.m_max[a_axis]
+                     < (ELEMTYPEREAL) a_b.m_rect.m_min[a_axis] + a_b.m_rect.m_max[a_axis];
+            } );
+
+    if( a_axis < NUMDIMS - 1 && nodeCount > 1 )
+    {
+        // nodeCount^(1/d) slabs for the d axes left
+        const size_t slabCount = (size_t) std::ceil(
+                std::pow( (double) nodeCount, 1.0 / ( NUMDIMS - a_axis ) ) );
+        const size_t slabSize = MAXNODES * ( ( nodeCount + slabCount - 1 ) / slabCount );
+
+        for( Branch* slab = a_begin; slab < a_end; )
+        {
+            Branch* slabEnd = slab + std::min<size_t>( slabSize, a_end - slab );
+
+            BulkLoadRec( slab, slabEnd, a_axis + 1, a_level, a_parents );
+            slab = slabEnd;
+        }
+
+        return;
+    }
+
+    // Spread the branches evenly so that no node ends up nearly empty
+    for( size_t index = 0; index < nodeCount; ++index )
+    {
+        Branch* first = a_begin + count * index / nodeCount;
+        Branch* last = a_begin + count * ( index + 1 ) / nodeCount;
+        Node*   node = AllocNode();
+
+        node->m_level = a_level;
+
+        for( Branch* branch = first; branch < last; ++branch )
+            node->m_branch[node->m_count++] = *branch;
+
+        Branch parent;
+        parent.m_rect = NodeCover( node );
+        parent.m_child = node;
+        a_parents.push_back( parent );
+    }
+}
+
+
 RTREE_TEMPLATE
 void RTREE_QUAL::Reset()
 {